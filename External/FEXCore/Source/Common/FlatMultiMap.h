@@ -0,0 +1,147 @@
+#pragma once
+
+#include <tsl/robin_map.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace FEXCore {
+
+// FlatMultiMap maps a 64-bit key to an unordered list of values
+//
+// The keys live in an open addressing hash table that only stores the head of each key's list.
+// List nodes are pooled in a single vector and chained by index, removed nodes get recycled.
+// Once the pool has grown to the working set size, inserting and removing doesn't allocate.
+//
+// Callbacks passed to the Take functions must not modify the map they are called from
+template<typename T>
+class FlatMultiMap final {
+public:
+  void Insert(uint64_t Key, T Value) {
+    uint32_t Node = AllocateNode();
+    auto Head = Heads.try_emplace(Key, INVALID_NODE).first;
+    Nodes[Node] = {std::move(Value), Head->second};
+    Head.value() = Node;
+  }
+
+  // Removes all values of Key, calling Callback on each
+  template<typename Fn>
+  void Take(uint64_t Key, Fn &&Callback) {
+    auto Head = Heads.find(Key);
+    if (Head == Heads.end()) {
+      return;
+    }
+
+    uint32_t Node = Head->second;
+    Heads.erase(Head);
+    TakeList(Node, Callback);
+  }
+
+  // Removes all values of the keys in [First, Last], calling Callback on each
+  template<typename Fn>
+  void TakeRange(uint64_t First, uint64_t Last, Fn &&Callback) {
+    if ((Last - First) >= Heads.size()) {
+      // Walking the table is cheaper than probing every key of a large range
+      TakeIf([First, Last](uint64_t Key) {
+        return Key >= First && Key <= Last;
+      }, Callback);
+      return;
+    }
+
+    for (uint64_t Key = First;; ++Key) {
+      Take(Key, Callback);
+      if (Key == Last) {
+        break;
+      }
+    }
+  }
+
+  // Removes all values of the keys that Pred returns true for, calling Callback on each
+  template<typename PredFn, typename Fn>
+  void TakeIf(PredFn &&Pred, Fn &&Callback) {
+    for (auto Head = Heads.begin(); Head != Heads.end();) {
+      if (Pred(Head->first)) {
+        uint32_t Node = Head->second;
+        Head = Heads.erase(Head);
+        TakeList(Node, Callback);
+      }
+      else {
+        ++Head;
+      }
+    }
+  }
+
+  // Removes the values that Pred returns true for, nothing gets called on them
+  template<typename PredFn>
+  void EraseIf(PredFn &&Pred) {
+    for (auto Head = Heads.begin(); Head != Heads.end();) {
+      uint32_t *Link = &Head.value();
+      while (*Link != INVALID_NODE) {
+        uint32_t Node = *Link;
+        auto &Entry = Nodes[Node];
+        if (Pred(Entry.Value)) {
+          *Link = Entry.Next;
+          Entry.Next = FreeNode;
+          FreeNode = Node;
+        }
+        else {
+          Link = &Entry.Next;
+        }
+      }
+
+      if (Head->second == INVALID_NODE) {
+        Head = Heads.erase(Head);
+      }
+      else {
+        ++Head;
+      }
+    }
+  }
+
+  // Keeps the allocations around for reuse
+  void Clear() {
+    Heads.clear();
+    Nodes.clear();
+    FreeNode = INVALID_NODE;
+  }
+
+private:
+  constexpr static uint32_t INVALID_NODE = ~0U;
+
+  struct Node {
+    T Value;
+    uint32_t Next;
+  };
+
+  uint32_t AllocateNode() {
+    if (FreeNode != INVALID_NODE) {
+      uint32_t Node = FreeNode;
+      FreeNode = Nodes[Node].Next;
+      return Node;
+    }
+
+    Nodes.emplace_back();
+    return Nodes.size() - 1;
+  }
+
+  template<typename Fn>
+  void TakeList(uint32_t Node, Fn &Callback) {
+    while (Node != INVALID_NODE) {
+      auto &Entry = Nodes[Node];
+      uint32_t Next = Entry.Next;
+      T Value = std::move(Entry.Value);
+
+      Entry.Next = FreeNode;
+      FreeNode = Node;
+
+      Callback(Value);
+      Node = Next;
+    }
+  }
+
+  tsl::robin_map<uint64_t, uint32_t> Heads;
+  std::vector<Node> Nodes;
+  uint32_t FreeNode {INVALID_NODE};
+};
+}
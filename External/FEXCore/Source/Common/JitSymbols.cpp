@@ -1,11 +1,480 @@
 #include "Common/JitSymbols.h"
 
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+#include <FEXCore/Utils/MathUtils.h>
+#include <FEXCore/Utils/Threads.h>
+#include <FEXHeaderUtils/Syscalls.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
 #include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <time.h>
 #include <unistd.h>
+#include <vector>
 
 #include <fmt/format.h>
 
 namespace FEXCore {
+  namespace JITDumpFormat {
+    // Layout from perf's tools/perf/Documentation/jitdump-specification.txt
+    constexpr uint32_t MAGIC = 0x4A695444;
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t JIT_CODE_LOAD = 0;
+    constexpr uint32_t JIT_CODE_CLOSE = 3;
+
+    struct FileHeader {
+      uint32_t Magic;
+      uint32_t Version;
+      uint32_t TotalSize;
+      uint32_t ELFMach;
+      uint32_t Pad1;
+      uint32_t PID;
+      uint64_t Timestamp;
+      uint64_t Flags;
+    };
+    static_assert(sizeof(FileHeader) == 40);
+
+    struct RecordHeader {
+      uint32_t ID;
+      uint32_t TotalSize;
+      uint64_t Timestamp;
+    };
+
+    // Followed by the null terminated name and then the code bytes
+    struct CodeLoad {
+      RecordHeader Header;
+      uint32_t PID;
+      uint32_t TID;
+      uint64_t VMA;
+      uint64_t CodeAddr;
+      uint64_t CodeSize;
+      uint64_t CodeIndex;
+    };
+    static_assert(sizeof(CodeLoad) == 56);
+
+    // perf needs to record with `-k mono` to line these up with its samples
+    static uint64_t GetTimestamp() {
+      timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec * 1'000'000'000ULL + ts.tv_nsec;
+    }
+  }
+
+  // Single producer, single consumer byte ring
+  // Each thread that registers code owns one, the writer thread is the only consumer
+  struct JITDumpRing {
+    static constexpr uint64_t SIZE = 1 << 20;
+    // Records never straddle the end of the ring, a padding record fills the gap instead
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    // Followed by the name and the code bytes
+    struct Record {
+      uint32_t Size;
+      uint32_t NameSize;
+      uint32_t CodeSize;
+      uint32_t TID;
+      uint64_t Timestamp;
+      // Zero for padding records
+      uint64_t HostAddr;
+      // Names the block when NameSize is zero
+      uint64_t GuestAddr;
+    };
+    static_assert(sizeof(Record) <= ALIGNMENT);
+
+    alignas(64) std::atomic<uint64_t> Head{};
+    alignas(64) std::atomic<uint64_t> Tail{};
+    std::atomic<bool> InUse{};
+    std::unique_ptr<uint8_t[]> Data{new uint8_t[SIZE]};
+  };
+
+  namespace {
+    std::atomic<uint64_t> NextWriterID{1};
+
+    struct ThreadRing {
+      uint64_t WriterID{};
+      uint32_t TID{};
+      std::shared_ptr<JITDumpRing> Ring;
+
+      ~ThreadRing() {
+        Release();
+      }
+
+      void Release() {
+        if (Ring) {
+          // Anything left in the ring still gets drained, the next thread just appends after it
+          Ring->InUse.store(false, std::memory_order_release);
+          Ring.reset();
+        }
+        WriterID = 0;
+      }
+    };
+
+    thread_local ThreadRing CurrentRing;
+  }
+
+  class JITDumpWriter final {
+  public:
+    explicit JITDumpWriter(JITSymbols::GuestNamerType _GuestNamer)
+      : GuestNamer {std::move(_GuestNamer)} {
+    }
+
+    ~JITDumpWriter() {
+      Stop();
+      Close();
+    }
+
+    bool Open();
+    void Append(const void *HostAddr, uint64_t GuestAddr, uint32_t CodeSize, std::string_view Name);
+    void CleanupAfterFork();
+
+  private:
+    // Blocks sit in the rings for at most this long before they hit the file
+    constexpr static auto DRAIN_INTERVAL = std::chrono::milliseconds(100);
+
+    static void *WriterHandler(void *Arg);
+    void WriterThread();
+    void Stop();
+    void Close();
+    void Wake();
+    void Drain();
+    void AppendCodeLoad(JITDumpRing::Record const *Record);
+    void WriteBuffer();
+    JITDumpRing *GetThreadRing();
+
+    JITSymbols::GuestNamerType GuestNamer;
+    const uint64_t ID {NextWriterID.fetch_add(1)};
+
+    int FD {-1};
+    void *Marker {};
+    size_t MarkerSize {};
+    uint32_t PID {};
+
+    // Only touched by the writer thread
+    uint64_t CodeIndex {};
+    std::vector<uint8_t> Buffer;
+
+    std::mutex RingsMutex;
+    std::vector<std::shared_ptr<JITDumpRing>> Rings;
+
+    std::mutex WriterMutex;
+    std::condition_variable WriterWake;
+    bool ShuttingDown {};
+    std::atomic<bool> WakeRequested {};
+    std::unique_ptr<FEXCore::Threads::Thread> Thread;
+  };
+
+  bool JITDumpWriter::Open() {
+    PID = ::getpid();
+    const auto Path = fmt::format("/tmp/jit-{}.dump", PID);
+
+    FD = ::open(Path.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0666);
+    if (FD == -1) {
+      LogMan::Msg::EFmt("Couldn't open jitdump file '{}'", Path);
+      return false;
+    }
+
+    JITDumpFormat::FileHeader Header {
+      .Magic = JITDumpFormat::MAGIC,
+      .Version = JITDumpFormat::VERSION,
+      .TotalSize = sizeof(JITDumpFormat::FileHeader),
+#ifdef _M_X86_64
+      .ELFMach = EM_X86_64,
+#else
+      .ELFMach = EM_AARCH64,
+#endif
+      .Pad1 = 0,
+      .PID = PID,
+      .Timestamp = JITDumpFormat::GetTimestamp(),
+      .Flags = 0,
+    };
+
+    auto HeaderPtr = reinterpret_cast<const uint8_t*>(&Header);
+    Buffer.insert(Buffer.end(), HeaderPtr, HeaderPtr + sizeof(Header));
+    WriteBuffer();
+
+    // perf only finds the jitdump through an executable mapping of it
+    MarkerSize = sysconf(_SC_PAGESIZE);
+    Marker = FEXCore::Allocator::mmap(nullptr, MarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, FD, 0);
+    if (Marker == MAP_FAILED) {
+      LogMan::Msg::EFmt("Couldn't map jitdump file '{}'", Path);
+      Marker = nullptr;
+      Close();
+      return false;
+    }
+
+    uint64_t OldMask = FEXCore::Threads::SetSignalMask(~0ULL);
+    Thread = FEXCore::Threads::Thread::Create(WriterHandler, this);
+    FEXCore::Threads::SetSignalMask(OldMask);
+    return true;
+  }
+
+  void JITDumpWriter::Stop() {
+    {
+      std::scoped_lock lk(WriterMutex);
+      ShuttingDown = true;
+    }
+    WriterWake.notify_one();
+
+    if (Thread) {
+      // The writer does one last drain on the way out
+      Thread->join(nullptr);
+      Thread.reset();
+    }
+  }
+
+  void JITDumpWriter::Close() {
+    if (FD == -1) {
+      return;
+    }
+
+    if (Marker) {
+      JITDumpFormat::RecordHeader CodeClose {
+        .ID = JITDumpFormat::JIT_CODE_CLOSE,
+        .TotalSize = sizeof(JITDumpFormat::RecordHeader),
+        .Timestamp = JITDumpFormat::GetTimestamp(),
+      };
+      auto ClosePtr = reinterpret_cast<const uint8_t*>(&CodeClose);
+      Buffer.insert(Buffer.end(), ClosePtr, ClosePtr + sizeof(CodeClose));
+      WriteBuffer();
+
+      FEXCore::Allocator::munmap(Marker, MarkerSize);
+      Marker = nullptr;
+    }
+
+    ::close(FD);
+    FD = -1;
+  }
+
+  void *JITDumpWriter::WriterHandler(void *Arg) {
+    reinterpret_cast<JITDumpWriter*>(Arg)->WriterThread();
+    return nullptr;
+  }
+
+  void JITDumpWriter::WriterThread() {
+    while (true) {
+      bool Exit{};
+      {
+        std::unique_lock lk(WriterMutex);
+        WriterWake.wait_for(lk, DRAIN_INTERVAL, [this] { return ShuttingDown || WakeRequested.load(std::memory_order_relaxed); });
+        Exit = ShuttingDown;
+      }
+
+      WakeRequested.store(false, std::memory_order_relaxed);
+      Drain();
+
+      if (Exit) {
+        return;
+      }
+    }
+  }
+
+  void JITDumpWriter::Wake() {
+    // Producers don't take the lock, a missed wakeup only costs one drain interval
+    if (!WakeRequested.exchange(true, std::memory_order_relaxed)) {
+      WriterWake.notify_one();
+    }
+  }
+
+  JITDumpRing *JITDumpWriter::GetThreadRing() {
+    if (CurrentRing.WriterID == ID) {
+      return CurrentRing.Ring.get();
+    }
+
+    // First block from this thread, or the ring belongs to a writer that is gone
+    CurrentRing.Release();
+
+    std::shared_ptr<JITDumpRing> Ring;
+    {
+      std::scoped_lock lk(RingsMutex);
+      for (auto &It : Rings) {
+        bool Expected = false;
+        if (It->InUse.compare_exchange_strong(Expected, true, std::memory_order_acquire)) {
+          Ring = It;
+          break;
+        }
+      }
+
+      if (!Ring) {
+        Ring = Rings.emplace_back(std::make_shared<JITDumpRing>());
+        Ring->InUse.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    CurrentRing.WriterID = ID;
+    CurrentRing.TID = FHU::Syscalls::gettid();
+    CurrentRing.Ring = std::move(Ring);
+    return CurrentRing.Ring.get();
+  }
+
+  void JITDumpWriter::Append(const void *HostAddr, uint64_t GuestAddr, uint32_t CodeSize, std::string_view Name) {
+    if (!Thread) {
+      // Nothing would ever drain the ring
+      return;
+    }
+
+    const uint64_t Size = AlignUp(sizeof(JITDumpRing::Record) + Name.size() + CodeSize, JITDumpRing::ALIGNMENT);
+    if (Size > JITDumpRing::SIZE / 2) {
+      LogMan::Msg::DFmt("jitdump: Dropping {} byte block at {}", CodeSize, HostAddr);
+      return;
+    }
+
+    auto Ring = GetThreadRing();
+    uint64_t Head = Ring->Head.load(std::memory_order_relaxed);
+
+    const uint64_t Offset = Head % JITDumpRing::SIZE;
+    const uint64_t Padding = (JITDumpRing::SIZE - Offset) < Size ? JITDumpRing::SIZE - Offset : 0;
+
+    // Only happens if the writer falls behind by a whole ring
+    while ((Head + Padding + Size - Ring->Tail.load(std::memory_order_acquire)) > JITDumpRing::SIZE) {
+      Wake();
+      std::this_thread::yield();
+    }
+
+    if (Padding) {
+      auto PadRecord = reinterpret_cast<JITDumpRing::Record*>(&Ring->Data[Offset]);
+      *PadRecord = {
+        .Size = static_cast<uint32_t>(Padding),
+      };
+      Head += Padding;
+    }
+
+    auto Data = &Ring->Data[Head % JITDumpRing::SIZE];
+    auto Record = reinterpret_cast<JITDumpRing::Record*>(Data);
+    *Record = {
+      .Size = static_cast<uint32_t>(Size),
+      .NameSize = static_cast<uint32_t>(Name.size()),
+      .CodeSize = CodeSize,
+      .TID = CurrentRing.TID,
+      .Timestamp = JITDumpFormat::GetTimestamp(),
+      .HostAddr = reinterpret_cast<uint64_t>(HostAddr),
+      .GuestAddr = GuestAddr,
+    };
+
+    // The code is copied now, the buffer can be rewritten long before the writer gets to it
+    memcpy(Data + sizeof(JITDumpRing::Record), Name.data(), Name.size());
+    memcpy(Data + sizeof(JITDumpRing::Record) + Name.size(), HostAddr, CodeSize);
+
+    Head += Size;
+    Ring->Head.store(Head, std::memory_order_release);
+
+    if ((Head - Ring->Tail.load(std::memory_order_relaxed)) > JITDumpRing::SIZE / 2) {
+      Wake();
+    }
+  }
+
+  void JITDumpWriter::Drain() {
+    std::vector<std::shared_ptr<JITDumpRing>> LiveRings;
+    {
+      std::scoped_lock lk(RingsMutex);
+      LiveRings = Rings;
+    }
+
+    for (auto &Ring : LiveRings) {
+      const uint64_t Head = Ring->Head.load(std::memory_order_acquire);
+      uint64_t Tail = Ring->Tail.load(std::memory_order_relaxed);
+
+      while (Tail != Head) {
+        auto Record = reinterpret_cast<JITDumpRing::Record const*>(&Ring->Data[Tail % JITDumpRing::SIZE]);
+        if (Record->HostAddr) {
+          AppendCodeLoad(Record);
+        }
+        Tail += Record->Size;
+      }
+
+      // Everything is in the buffer, the producer can reuse the space
+      Ring->Tail.store(Tail, std::memory_order_release);
+    }
+
+    // One write per drain instead of one per block
+    WriteBuffer();
+  }
+
+  void JITDumpWriter::AppendCodeLoad(JITDumpRing::Record const *Record) {
+    auto Data = reinterpret_cast<const uint8_t*>(Record) + sizeof(JITDumpRing::Record);
+
+    // Named here instead of at registration, looking up guest symbols is far too slow for the compile path
+    std::string Name = Record->NameSize ? std::string(reinterpret_cast<const char*>(Data), Record->NameSize)
+                                        : GuestNamer(Record->GuestAddr);
+
+    JITDumpFormat::CodeLoad Load {
+      .Header = {
+        .ID = JITDumpFormat::JIT_CODE_LOAD,
+        .TotalSize = static_cast<uint32_t>(sizeof(JITDumpFormat::CodeLoad) + Name.size() + 1 + Record->CodeSize),
+        .Timestamp = Record->Timestamp,
+      },
+      .PID = PID,
+      .TID = Record->TID,
+      .VMA = Record->HostAddr,
+      .CodeAddr = Record->HostAddr,
+      .CodeSize = Record->CodeSize,
+      .CodeIndex = CodeIndex++,
+    };
+
+    auto LoadPtr = reinterpret_cast<const uint8_t*>(&Load);
+    Buffer.insert(Buffer.end(), LoadPtr, LoadPtr + sizeof(Load));
+    Buffer.insert(Buffer.end(), Name.c_str(), Name.c_str() + Name.size() + 1);
+
+    auto Code = Data + Record->NameSize;
+    Buffer.insert(Buffer.end(), Code, Code + Record->CodeSize);
+  }
+
+  void JITDumpWriter::WriteBuffer() {
+    size_t Written = 0;
+    while (Written < Buffer.size()) {
+      auto Result = ::write(FD, Buffer.data() + Written, Buffer.size() - Written);
+      if (Result == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LogMan::Msg::EFmt("jitdump: Failed to write {} bytes", Buffer.size() - Written);
+        break;
+      }
+      Written += Result;
+    }
+    Buffer.clear();
+  }
+
+  void JITDumpWriter::CleanupAfterFork() {
+    // The writer thread didn't survive the fork, it could have been holding any of the locks
+    new (&RingsMutex) std::mutex{};
+    new (&WriterMutex) std::mutex{};
+    new (&WriterWake) std::condition_variable{};
+    [[maybe_unused]] auto DeadThread = Thread.release();
+    ShuttingDown = false;
+    WakeRequested.store(false, std::memory_order_relaxed);
+
+    // Only the forking thread is left, the other rings can be handed out again
+    // Their pending blocks describe code the child shares with the parent, so they still get written
+    for (auto &Ring : Rings) {
+      if (CurrentRing.WriterID != ID || Ring != CurrentRing.Ring) {
+        Ring->InUse.store(false, std::memory_order_relaxed);
+      }
+    }
+
+    // A drain that was interrupted hasn't moved any tails yet, the child drains it again
+    Buffer.clear();
+
+    // The file belongs to the parent, perf expects one per pid
+    if (Marker) {
+      FEXCore::Allocator::munmap(Marker, MarkerSize);
+      Marker = nullptr;
+    }
+    ::close(FD);
+    FD = -1;
+
+    Open();
+  }
+
   JITSymbols::JITSymbols() : fp{nullptr, std::fclose} {
     const auto PerfMap = fmt::format("/tmp/perf-{}.map", getpid());
 
@@ -18,7 +487,34 @@ namespace FEXCore {
 
   JITSymbols::~JITSymbols() = default;
 
+  void JITSymbols::EnableJITDump(GuestNamerType GuestNamer) {
+    auto Writer = std::make_unique<JITDumpWriter>(std::move(GuestNamer));
+    if (!Writer->Open()) {
+      // Stay on the perf map
+      return;
+    }
+
+    JITDump = std::move(Writer);
+
+    if (fp) {
+      // Nothing goes to the perf map anymore
+      fp.reset();
+      unlink(fmt::format("/tmp/perf-{}.map", getpid()).c_str());
+    }
+  }
+
+  void JITSymbols::CleanupAfterFork() {
+    if (JITDump) {
+      JITDump->CleanupAfterFork();
+    }
+  }
+
   void JITSymbols::Register(const void *HostAddr, uint64_t GuestAddr, uint32_t CodeSize) {
+    if (JITDump) {
+      JITDump->Append(HostAddr, GuestAddr, CodeSize, {});
+      return;
+    }
+
     if (!fp) return;
 
     // Linux perf format is very straightforward
@@ -27,6 +523,11 @@ namespace FEXCore {
   }
 
   void JITSymbols::Register(const void *HostAddr, uint32_t CodeSize, std::string_view Name) {
+    if (JITDump) {
+      JITDump->Append(HostAddr, 0, CodeSize, Name);
+      return;
+    }
+
     if (!fp) return;
 
     // Linux perf format is very straightforward
@@ -35,6 +536,11 @@ namespace FEXCore {
   }
 
   void JITSymbols::RegisterNamedRegion(const void *HostAddr, uint32_t CodeSize, std::string_view Name) {
+    if (JITDump) {
+      JITDump->Append(HostAddr, 0, CodeSize, Name);
+      return;
+    }
+
     if (!fp) return;
 
     // Linux perf format is very straightforward
@@ -43,6 +549,9 @@ namespace FEXCore {
   }
 
   void JITSymbols::RegisterJITSpace(const void *HostAddr, uint32_t CodeSize) {
+    // A jitdump entry covering the whole code buffer would shadow every block in it
+    if (JITDump) return;
+
     if (!fp) return;
 
     // Linux perf format is very straightforward
@@ -2,15 +2,32 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
 
 namespace FEXCore {
+class JITDumpWriter;
+
 class JITSymbols final {
 public:
+  // Gives a name to a guest RIP, only ever called from the jitdump writer thread
+  using GuestNamerType = std::function<std::string(uint64_t GuestAddr)>;
+
   JITSymbols();
   ~JITSymbols();
 
+  /**
+   * @brief Switches from the perf map to a binary jitdump file
+   *
+   * The jitdump carries a copy of each block's code so `perf inject --jit` still works after the code buffer is reused.
+   * Registering only copies in to a per-thread ring buffer, a background thread names the blocks and writes them out.
+   */
+  void EnableJITDump(GuestNamerType GuestNamer);
+
+  void CleanupAfterFork();
+
   void Register(const void *HostAddr, uint64_t GuestAddr, uint32_t CodeSize);
   void Register(const void *HostAddr, uint32_t CodeSize, std::string_view Name);
   void RegisterNamedRegion(const void *HostAddr, uint32_t CodeSize, std::string_view Name);
@@ -20,5 +37,6 @@ private:
   using FILEPtr = std::unique_ptr<FILE, decltype(&std::fclose)>;
 
   FILEPtr fp;
+  std::unique_ptr<JITDumpWriter> JITDump;
 };
 }
@@ -178,6 +178,14 @@ namespace FEXCore::Context {
     CTX->SetAOTIRRenamer(CacheRenamer);
   }
 
+  void SetGuestSymbolResolver(FEXCore::Context::Context *CTX, GuestSymbolResolverType Resolver) {
+    CTX->GuestSymbolResolver = std::move(Resolver);
+  }
+
+  void SetGuestFunctionBoundsResolver(FEXCore::Context::Context *CTX, GuestFunctionBoundsResolverType Resolver) {
+    CTX->GuestFunctionBoundsResolver = std::move(Resolver);
+  }
+
   void FinalizeAOTIRCache(FEXCore::Context::Context *CTX) {
     CTX->FinalizeAOTIRCache();
   }
@@ -205,6 +213,10 @@ namespace Debug {
     return CTX->GetRuntimeStatsForThread(Thread);
   }
 
+  FEXCore::Core::CompileStats GetCompileStats(FEXCore::Context::Context *CTX) {
+    return CTX->GetCompileStats();
+  }
+
   bool GetDebugDataForRIP(FEXCore::Context::Context *CTX, uint64_t RIP, FEXCore::Core::DebugData *Data) {
     return CTX->GetDebugDataForRIP(RIP, Data);
   }
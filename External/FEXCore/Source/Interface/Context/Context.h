@@ -2,6 +2,7 @@
 
 #include "Common/JitSymbols.h"
 #include "Interface/Core/CPUID.h"
+#include "Interface/Core/DecodedInstructionCache.h"
 #include "Interface/Core/HostFeatures.h"
 #include "Interface/Core/X86HelperGen.h"
 #include "Interface/IR/AOTIR.h"
@@ -30,9 +31,13 @@
 #include <vector>
 
 namespace FEXCore {
+class CodeInvalidationService;
 class CodeLoader;
 class ThunkHandler;
 class GdbServer;
+class SharedCodeCache;
+class SMCPageTracker;
+class TierUpService;
 
 namespace CPU {
   class Arm64JITCore;
@@ -68,6 +73,10 @@ namespace FEXCore::Context {
   #endif
 
     friend class FEXCore::IR::Validation::IRValidation;
+    friend class FEXCore::CodeInvalidationService;
+    friend class FEXCore::SharedCodeCache;
+    friend class FEXCore::SMCPageTracker;
+    friend class FEXCore::TierUpService;
 
     struct {
       CoreRunningMode RunningMode {CoreRunningMode::MODE_RUN};
@@ -77,6 +86,10 @@ namespace FEXCore::Context {
       bool ValidateIRarser { false };
 
       FEX_CONFIG_OPT(Multiblock, MULTIBLOCK);
+      FEX_CONFIG_OPT(SharedCodeCache, SHAREDCODECACHE);
+      FEX_CONFIG_OPT(TieredCompilation, TIEREDCOMPILATION);
+      FEX_CONFIG_OPT(TierUpThreshold, TIERUPTHRESHOLD);
+      FEX_CONFIG_OPT(TierUpThreads, TIERUPTHREADS);
       FEX_CONFIG_OPT(SingleStepConfig, SINGLESTEP);
       FEX_CONFIG_OPT(GdbServer, GDBSERVER);
       FEX_CONFIG_OPT(Is64BitMode, IS64BIT_MODE);
@@ -86,6 +99,8 @@ namespace FEXCore::Context {
       FEX_CONFIG_OPT(AOTIRCapture, AOTIRCAPTURE);
       FEX_CONFIG_OPT(AOTIRGenerate, AOTIRGENERATE);
       FEX_CONFIG_OPT(AOTIRLoad, AOTIRLOAD);
+      FEX_CONFIG_OPT(AOTCodeCapture, AOTCODECAPTURE);
+      FEX_CONFIG_OPT(AOTCodeLoad, AOTCODELOAD);
       FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
       FEX_CONFIG_OPT(Core, CORE);
       FEX_CONFIG_OPT(MaxInstPerBlock, MAXINST);
@@ -97,7 +112,11 @@ namespace FEXCore::Context {
       FEX_CONFIG_OPT(GlobalJITNaming, GLOBALJITNAMING);
       FEX_CONFIG_OPT(LibraryJITNaming, LIBRARYJITNAMING);
       FEX_CONFIG_OPT(BlockJITNaming, BLOCKJITNAMING);
+      FEX_CONFIG_OPT(CompileStats, COMPILESTATS);
+      FEX_CONFIG_OPT(JITDump, JITDUMP);
       FEX_CONFIG_OPT(ParanoidTSO, PARANOIDTSO);
+      FEX_CONFIG_OPT(X87ReducedPrecision, X87REDUCEDPRECISION);
+      FEX_CONFIG_OPT(StackTSOElision, STACKTSOELISION);
     } Config;
 
     using IntCallbackReturn =  FEX_NAKED void(*)(FEXCore::Core::InternalThreadState *Thread, volatile void *Host_RSP);
@@ -122,6 +141,20 @@ namespace FEXCore::Context {
     FEXCore::HLE::SyscallHandler *SyscallHandler{};
     std::unique_ptr<FEXCore::ThunkHandler> ThunkHandler;
 
+    // Only exists when the process wide code cache is enabled
+    std::unique_ptr<FEXCore::SharedCodeCache> SharedCode;
+
+    // Only exists when tiered compilation is enabled
+    std::unique_ptr<FEXCore::TierUpService> TierUp;
+
+    // Only exists with the mtrack SMC checks
+    std::unique_ptr<FEXCore::SMCPageTracker> SMCTracker;
+
+    std::unique_ptr<FEXCore::CodeInvalidationService> CodeInvalidation;
+
+    // Shared between every decoder
+    FEXCore::Frontend::DecodedInstructionCache DecodedInstructions;
+
     CustomCPUFactoryType CustomCPUFactory;
     FEXCore::Context::ExitHandler CustomExitHandler;
 
@@ -157,6 +190,14 @@ namespace FEXCore::Context {
 
     static void RemoveCodeEntry(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP);
 
+    /**
+     * @brief Drops the thread's blocks that were compiled from the guest range, along with the given shared blocks
+     *
+     * Only touches the thread's own caches, other threads get told through the CodeInvalidationService
+     */
+    void InvalidateThreadCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length, std::vector<uint64_t> const &SharedBlocks);
+    static void ClearReturnStack(FEXCore::Core::InternalThreadState *Thread);
+
     // Wrapper which takes CpuStateFrame instead of InternalThreadState
     static void RemoveCodeEntryFromJit(FEXCore::Core::CpuStateFrame *Frame, uint64_t GuestRIP) {
       RemoveCodeEntry(Frame->Thread, GuestRIP);
@@ -166,6 +207,7 @@ namespace FEXCore::Context {
     void CompileRIP(FEXCore::Core::InternalThreadState *Thread, uint64_t RIP);
     uint64_t GetThreadCount() const;
     FEXCore::Core::RuntimeStats *GetRuntimeStatsForThread(uint64_t Thread);
+    FEXCore::Core::CompileStats GetCompileStats();
     bool GetDebugDataForRIP(uint64_t RIP, FEXCore::Core::DebugData *Data);
     bool FindHostCodeForRIP(uint64_t RIP, uint8_t **Code);
 
@@ -178,7 +220,7 @@ namespace FEXCore::Context {
       uint64_t StartAddr;
       uint64_t Length;
     };
-    [[nodiscard]] GenerateIRResult GenerateIR(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP);
+    [[nodiscard]] GenerateIRResult GenerateIR(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP, FEXCore::Core::CompileStats *Stats = nullptr);
 
     struct CompileCodeResult {
       void* CompiledCode;
@@ -273,6 +315,15 @@ namespace FEXCore::Context {
     void RemoveNamedRegion(uintptr_t Base, uintptr_t Size);
 
     FEXCore::JITSymbols Symbols;
+    GuestSymbolResolverType GuestSymbolResolver;
+    GuestFunctionBoundsResolverType GuestFunctionBoundsResolver;
+
+    /**
+     * @brief Finds the guest function that contains the address
+     *
+     * @return false if the address isn't file backed or the file doesn't describe the function
+     */
+    bool FindGuestFunctionBounds(uint64_t GuestRIP, uint64_t *Start, uint64_t *End);
 
     // Public for threading
     void ExecutionThread(FEXCore::Core::InternalThreadState *Thread);
@@ -315,6 +366,8 @@ namespace FEXCore::Context {
     void NotifyPause();
 
     void AddBlockMapping(FEXCore::Core::InternalThreadState *Thread, uint64_t Address, void *Ptr, uint64_t Start, uint64_t Length);
+    void RegisterBlockJITNaming(uint64_t GuestRIP, void *CodePtr, FEXCore::Core::DebugData *DebugData);
+    std::string GetGuestSymbolName(uint64_t GuestRIP);
     FEXCore::CodeLoader *LocalLoader{};
 
     // Entry Cache
@@ -324,6 +377,10 @@ namespace FEXCore::Context {
 
     IR::AOTIRCaptureCache IRCaptureCache;
 
+    // Only collected with the CompileStats option
+    std::mutex CompileStatsMutex;
+    FEXCore::Core::CompileStats TotalCompileStats{};
+
     bool StartPaused = false;
     FEX_CONFIG_OPT(AppFilename, APP_FILENAME);
   };
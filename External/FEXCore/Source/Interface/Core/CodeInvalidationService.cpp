@@ -0,0 +1,138 @@
+/*
+$info$
+tags: glue|block-database
+desc: Broadcasts guest code invalidations to all threads and defers reuse of retired code until they are quiescent
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/CodeInvalidationService.h"
+#include "Interface/Core/LookupCache.h"
+#include "Interface/Core/SMCPageTracker.h"
+#include "Interface/Core/TierUpService.h"
+
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace FEXCore {
+  CodeInvalidationService::CodeInvalidationService(FEXCore::Context::Context *ctx)
+    : CTX {ctx} {
+  }
+
+  void CodeInvalidationService::RegisterThread(FEXCore::Core::InternalThreadState *Thread) {
+    Thread->CodeInvalidationData = std::make_shared<CodeInvalidationThreadData>();
+    Thread->CodeInvalidationData->Frame = Thread->CurrentFrame;
+
+    std::scoped_lock lk(ThreadsMutex);
+    // A new thread hasn't seen any of the retired code
+    Thread->CodeInvalidationData->QuiescentEpoch = GlobalEpoch.load();
+    ThreadData.emplace_back(Thread->CodeInvalidationData);
+  }
+
+  void CodeInvalidationService::UnregisterThread(FEXCore::Core::InternalThreadState *Thread) {
+    if (!Thread->CodeInvalidationData) {
+      return;
+    }
+
+    {
+      std::scoped_lock lk(ThreadsMutex);
+      std::erase(ThreadData, Thread->CodeInvalidationData);
+    }
+    Thread->CodeInvalidationData.reset();
+  }
+
+  void CodeInvalidationService::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // The dead threads could have been holding any of the locks
+    new (&ThreadsMutex) std::mutex{};
+    ThreadData.clear();
+
+    if (auto Data = LiveThread->CodeInvalidationData) {
+      new (&Data->Mutex) std::mutex{};
+      ThreadData.emplace_back(Data);
+    }
+  }
+
+  void CodeInvalidationService::BroadcastCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length, std::vector<uint64_t> const &SharedBlocks) {
+    std::scoped_lock lk(ThreadsMutex);
+    for (auto &Data : ThreadData) {
+      if (Data == Thread->CodeInvalidationData) {
+        continue;
+      }
+
+      std::scoped_lock DataLock(Data->Mutex);
+      Data->PendingRanges.emplace_back(CodeInvalidationThreadData::PendingRange{Start, Length, SharedBlocks});
+      std::atomic_ref<uint64_t>(Data->Frame->PendingCodeInvalidation).store(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t CodeInvalidationService::RetireSharedCode() {
+    std::scoped_lock lk(ThreadsMutex);
+    for (auto &Data : ThreadData) {
+      std::scoped_lock DataLock(Data->Mutex);
+      Data->PendingSharedClear = true;
+      std::atomic_ref<uint64_t>(Data->Frame->PendingCodeInvalidation).store(1, std::memory_order_relaxed);
+    }
+
+    // Only after the work is queued, a thread that sees the new epoch is guaranteed to see the work as well
+    return GlobalEpoch.fetch_add(1) + 1;
+  }
+
+  bool CodeInvalidationService::IsEpochQuiescent(uint64_t Epoch) {
+    std::scoped_lock lk(ThreadsMutex);
+    return std::all_of(ThreadData.begin(), ThreadData.end(), [Epoch](auto const &Data) {
+      return Data->QuiescentEpoch.load(std::memory_order_acquire) >= Epoch;
+    });
+  }
+
+  void CodeInvalidationService::SafePointSlow(FEXCore::Core::InternalThreadState *Thread) {
+    auto Data = Thread->CodeInvalidationData.get();
+
+    // Read before taking the work, everything that was retired up to this epoch has queued its work by now
+    const uint64_t Epoch = GlobalEpoch.load();
+
+    // The interrupted code could be retired code, that part has to wait until the signal handler returned
+    const bool InSignalHandler = Thread->CPUBackend->IsInSignalHandler();
+
+    std::vector<CodeInvalidationThreadData::PendingRange> Ranges;
+    bool SharedClear{};
+    {
+      std::scoped_lock lk(Data->Mutex);
+      Ranges.swap(Data->PendingRanges);
+      if (!InSignalHandler) {
+        SharedClear = std::exchange(Data->PendingSharedClear, false);
+      }
+      std::atomic_ref<uint64_t>(Data->Frame->PendingCodeInvalidation).store(InSignalHandler, std::memory_order_relaxed);
+    }
+
+    for (auto &Range : Ranges) {
+      CTX->InvalidateThreadCodeRange(Thread, Range.Start, Range.Length, Range.SharedBlocks);
+    }
+
+    if (CTX->SMCTracker) {
+      CTX->SMCTracker->InvalidateFaultedPages(Thread);
+    }
+
+    if (InSignalHandler) {
+      return;
+    }
+
+    if (SharedClear) {
+      if (CTX->TierUp) {
+        // A TierUp worker retired its code, the blocks that were optimized in to it go back to their baseline code
+        CTX->TierUp->RevertRetiredBlocks(Thread);
+      }
+      Thread->LookupCache->ClearSharedMappings();
+      FEXCore::Context::Context::ClearReturnStack(Thread);
+    }
+
+    Data->QuiescentEpoch.store(Epoch, std::memory_order_release);
+  }
+}
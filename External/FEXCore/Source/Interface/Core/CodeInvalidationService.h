@@ -0,0 +1,136 @@
+#pragma once
+
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+
+/**
+ * @brief Invalidation bookkeeping of a single guest thread
+ *
+ * Owned by the guest thread, other threads only queue work in to it.
+ */
+struct CodeInvalidationThreadData {
+  struct PendingRange {
+    uint64_t Start;
+    uint64_t Length;
+    // Blocks that the invalidating thread took out of the SharedCodeCache for this range
+    std::vector<uint64_t> SharedBlocks;
+  };
+
+  // Protects everything below
+  std::mutex Mutex{};
+
+  std::vector<PendingRange> PendingRanges{};
+  // The SharedCodeCache was cleared, every shared block in the LookupCache is stale
+  bool PendingSharedClear{};
+
+  // The owning thread's frame, its PendingCodeInvalidation gets set along with the work
+  FEXCore::Core::CpuStateFrame *Frame{};
+
+  // Guest pages that the thread's writes faulted on with SMCChecks=mtrack
+  // Filled by the thread's own SIGSEGV handler so it can't be a locked vector, only the owning thread touches these
+  constexpr static size_t MAX_FAULTED_PAGES = 32;
+  std::array<uint64_t, MAX_FAULTED_PAGES> FaultedPages{};
+  size_t FaultedPageCount{};
+  // More pages faulted than fit, every tracked page that lost its protection needs to be invalidated
+  bool FaultedPagesOverflow{};
+
+  // Last epoch that the thread was at a safe point in
+  std::atomic<uint64_t> QuiescentEpoch{};
+};
+
+/**
+ * @brief Invalidates guest code in every thread and tracks when retired code stops being executed
+ *
+ * Guest threads only ever touch their own LookupCache. When a thread invalidates guest code it drops its own
+ * blocks and queues the range for all the others. Queueing sets the frame's PendingCodeInvalidation, which sends
+ * the dispatcher in to the compiler at its next loop top where the thread drops its blocks as well.
+ * Block links are followed without going through the dispatcher, a thread stuck in a linked loop keeps running
+ * the old code until it leaves the loop.
+ *
+ * The dispatcher's trip in to the compiler is also the thread's safe point, no JIT code is on the stack there
+ * unless the thread is in a guest signal handler. Retiring code starts a new epoch, the code's memory can be
+ * reused once every thread passed a safe point in that epoch. Threads that block in a syscall hold back
+ * reclamation until they return to the dispatcher.
+ */
+class CodeInvalidationService final {
+  public:
+    CodeInvalidationService(FEXCore::Context::Context *ctx);
+
+    void RegisterThread(FEXCore::Core::InternalThreadState *Thread);
+    void UnregisterThread(FEXCore::Core::InternalThreadState *Thread);
+
+    /**
+     * @brief Drops threads that died with the fork, their epochs would hold back reclamation forever
+     */
+    void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+    /**
+     * @brief Queues a guest range for invalidation in every thread but the calling one
+     *
+     * @param SharedBlocks Blocks that were taken out of the SharedCodeCache for this range
+     */
+    void BroadcastCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length, std::vector<uint64_t> const &SharedBlocks);
+
+    /**
+     * @brief Code of the SharedCodeCache or of a TierUp worker is about to be retired
+     *
+     * The SharedCodeCache must have been cleared and the TierUp redirects reverted before this so no thread can
+     * pick up the old blocks again. Every thread is told to drop the shared blocks from its LookupCache.
+     *
+     * @return The epoch to pass to IsEpochQuiescent before the code's memory gets reused
+     */
+    uint64_t RetireSharedCode();
+
+    /**
+     * @brief Starts a new epoch without retiring any code
+     *
+     * For memory that threads read without a lock, it can be freed once the returned epoch is quiescent
+     */
+    uint64_t AdvanceEpoch() {
+      return GlobalEpoch.fetch_add(1) + 1;
+    }
+
+    /**
+     * @brief Has every thread passed a safe point since the code of this epoch was retired
+     */
+    bool IsEpochQuiescent(uint64_t Epoch);
+
+    /**
+     * @brief Processes the queued work of the thread and marks it as quiescent
+     *
+     * Only to be called from the dispatcher's trip in to the compiler
+     */
+    void SafePoint(FEXCore::Core::InternalThreadState *Thread) {
+      auto Data = Thread->CodeInvalidationData.get();
+      if (Data &&
+          (std::atomic_ref<uint64_t>(Data->Frame->PendingCodeInvalidation).load(std::memory_order_relaxed) ||
+           Data->QuiescentEpoch.load(std::memory_order_relaxed) != GlobalEpoch.load(std::memory_order_relaxed))) {
+        SafePointSlow(Thread);
+      }
+    }
+
+  private:
+    void SafePointSlow(FEXCore::Core::InternalThreadState *Thread);
+
+    FEXCore::Context::Context *CTX;
+
+    std::atomic<uint64_t> GlobalEpoch{};
+
+    // Protects the thread list
+    std::mutex ThreadsMutex{};
+    std::vector<std::shared_ptr<CodeInvalidationThreadData>> ThreadData{};
+};
+}
@@ -9,15 +9,20 @@ $end_info$
 
 #include "Interface/Context/Context.h"
 #include "Interface/Core/LookupCache.h"
+#include "Interface/Core/CodeInvalidationService.h"
 #include "Interface/Core/CompileService.h"
 #include "Interface/Core/Core.h"
 #include "Interface/Core/CPUID.h"
 #include "Interface/Core/Frontend.h"
 #include "Interface/Core/GdbServer.h"
 #include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/SharedCodeCache.h"
+#include "Interface/Core/SMCPageTracker.h"
+#include "Interface/Core/TierUpService.h"
 #include "Interface/Core/Interpreter/InterpreterCore.h"
 #include "Interface/Core/JIT/JITCore.h"
 #include "Interface/HLE/Thunks/Thunks.h"
+#include "Interface/IR/CompactIR.h"
 #include "Interface/IR/Passes/RegisterAllocationPass.h"
 #include "Interface/IR/Passes.h"
 #include "Interface/IR/PassManager.h"
@@ -49,6 +54,7 @@ $end_info$
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <errno.h>
 #include <filesystem>
 #include <functional>
 #include <fstream>
@@ -157,6 +163,11 @@ namespace FEXCore::Context {
         }
       }
 
+      if (TierUp) {
+        // Workers patch code owned by the threads, they need to be gone first
+        TierUp->Shutdown();
+      }
+
       for (auto &Thread : Threads) {
 
         if (Thread->CompileService) {
@@ -223,17 +234,53 @@ namespace FEXCore::Context {
       StopGdbServer();
     }
 
+    if (Config.SMCChecks == FEXCore::Config::CONFIG_SMC_MTRACK) {
+      if (Config.Core == FEXCore::Config::CONFIG_IRJIT) {
+        SMCTracker = std::make_unique<FEXCore::SMCPageTracker>(this);
+      }
+      else {
+        // The interpreter has no safe point to defer the invalidation to, its IR could be freed while it executes it
+        LogMan::Msg::IFmt("SMCChecks=mtrack needs the JIT, falling back to mman");
+      }
+    }
+
     ThunkHandler.reset(FEXCore::ThunkHandler::Create());
 
+    if (Config.JITDump()) {
+      // Before the first thread is created so its dispatcher ends up in the jitdump
+      Symbols.EnableJITDump([this](uint64_t GuestRIP) { return GetGuestSymbolName(GuestRIP); });
+    }
+
     LocalLoader = Loader;
     using namespace FEXCore::Core;
 
+    // Threads register with it when they are created
+    CodeInvalidation = std::make_unique<FEXCore::CodeInvalidationService>(this);
+
+    // The interpreter needs its retained IR copy per thread, only the JIT can share code
+    if (Config.SharedCodeCache() && Config.Core == FEXCore::Config::CONFIG_IRJIT) {
+      // Needs to exist before the first thread is created so its LookupCache can reference it
+      SharedCode = std::make_unique<FEXCore::SharedCodeCache>(this);
+    }
+    else if (Config.TieredCompilation() && Config.Core == FEXCore::Config::CONFIG_IRJIT) {
+      // Needs to exist before the first thread is created so it compiles with the baseline tier
+      TierUp = std::make_unique<FEXCore::TierUpService>(this);
+    }
+
     FEXCore::Core::CPUState NewThreadState = CreateDefaultCPUState();
     FEXCore::Core::InternalThreadState *Thread = CreateThread(&NewThreadState, 0);
 
     // We are the parent thread
     ParentThread = Thread;
 
+    if (SharedCode) {
+      SharedCode->Initialize(ParentThread);
+    }
+
+    if (TierUp) {
+      TierUp->Initialize(ParentThread);
+    }
+
     Thread->CurrentFrame->State.gregs[X86State::REG_RSP] = Loader->GetStackPointer();
 
     Thread->CurrentFrame->State.rip = StartingRIP = Loader->DefaultRIP();
@@ -452,6 +499,14 @@ namespace FEXCore::Context {
           : nullptr),
         decltype(Entry.DebugData)(new Core::DebugData())
       };
+
+      if (!Thread->CPUBackend->NeedsRetainedIRCopy()) {
+        // This IR can't be regenerated from guest code, but the JIT only needs it again after a cache clear
+        IR::PackIR(Entry.IR.get(), Entry.RAData.get(), &Entry.PackedIR);
+        Entry.IR.reset();
+        Entry.RAData.reset();
+      }
+
       Thread->LocalIRCache.insert({Addr, std::move(Entry)});
     };
 
@@ -495,10 +550,17 @@ namespace FEXCore::Context {
   }
 
   void Context::InitializeCompiler(FEXCore::Core::InternalThreadState* State, bool CompileThread) {
+    // Guest threads compile with the baseline tier, the TierUpService's workers recompile hot blocks with everything enabled
+    const bool BaselineTier = TierUp && !CompileThread;
+
     State->OpDispatcher = std::make_unique<FEXCore::IR::OpDispatchBuilder>(this);
-    State->OpDispatcher->SetMultiblock(Config.Multiblock);
-    State->LookupCache = std::make_unique<FEXCore::LookupCache>(this);
+    State->OpDispatcher->SetMultiblock(Config.Multiblock && !BaselineTier);
+    // Only the optimized multiblock code makes use of the profile
+    State->OpDispatcher->SetProfileIndirectBranches(Config.Multiblock && BaselineTier);
+    // Compile threads never execute code, so they don't need to see the shared cache
+    State->LookupCache = std::make_unique<FEXCore::LookupCache>(this, CompileThread ? nullptr : SharedCode.get());
     State->FrontendDecoder = std::make_unique<FEXCore::Frontend::Decoder>(this);
+    State->FrontendDecoder->SetMultiblock(Config.Multiblock && !BaselineTier);
     State->PassManager = std::make_unique<FEXCore::IR::PassManager>();
     State->PassManager->RegisterExitHandler([this]() {
         Stop(false /* Ignore current thread */);
@@ -512,7 +574,7 @@ namespace FEXCore::Context {
     bool DoSRA = false;
     #endif
 
-    State->PassManager->AddDefaultPasses(Config.Core == FEXCore::Config::CONFIG_IRJIT, DoSRA);
+    State->PassManager->AddDefaultPasses(Config.Core == FEXCore::Config::CONFIG_IRJIT, DoSRA, BaselineTier);
     State->PassManager->AddDefaultValidationPasses();
 
     State->PassManager->RegisterSyscallHandler(SyscallHandler);
@@ -543,6 +605,14 @@ namespace FEXCore::Context {
       ERROR_AND_DIE_FMT("Unknown core configuration");
       break;
     }
+
+    if (BaselineTier) {
+      TierUp->RegisterThread(State);
+    }
+
+    if (!CompileThread) {
+      CodeInvalidation->RegisterThread(State);
+    }
   }
 
   FEXCore::Core::InternalThreadState* Context::CreateThread(FEXCore::Core::CPUState *NewThreadState, uint64_t ParentTID) {
@@ -579,6 +649,12 @@ namespace FEXCore::Context {
       Threads.erase(It);
     }
 
+    if (TierUp) {
+      TierUp->UnregisterThread(Thread);
+    }
+
+    CodeInvalidation->UnregisterThread(Thread);
+
     if (Thread->ExecutionThread &&
         Thread->ExecutionThread->IsSelf()) {
       // To be able to delete a thread from itself, we need to detached the std::thread object
@@ -630,13 +706,94 @@ namespace FEXCore::Context {
       // Erase the shared_ptr
       LiveThread->CompileService.reset();
     }
+
+    if (TierUp) {
+      // Same for the tier-up threads
+      TierUp->CleanupAfterFork(LiveThread);
+    }
+
+    if (SMCTracker) {
+      SMCTracker->CleanupAfterFork();
+    }
+
+    CodeInvalidation->CleanupAfterFork(LiveThread);
+    DecodedInstructions.CleanupAfterFork();
+
+    Symbols.CleanupAfterFork();
   }
 
   void Context::AddBlockMapping(FEXCore::Core::InternalThreadState *Thread, uint64_t Address, void *Ptr, uint64_t Start, uint64_t Length) {
     Thread->LookupCache->AddBlockMapping(Address, Ptr, Start, Length);
+
+    if (SMCTracker) {
+      SMCTracker->ProtectCodeRange(Start, Length);
+    }
+  }
+
+  void Context::RegisterBlockJITNaming(uint64_t GuestRIP, void *CodePtr, FEXCore::Core::DebugData *DebugData) {
+    if (Config.BlockJITNaming() || Config.JITDump()) {
+      if (DebugData) {
+        if (DebugData->Subblocks.size()) {
+          for (auto& Subblock: DebugData->Subblocks) {
+            Symbols.Register((void*)Subblock.HostCodeStart, GuestRIP, Subblock.HostCodeSize);
+          }
+        } else {
+          Symbols.Register(CodePtr, GuestRIP, DebugData->HostCodeSize);
+        }
+      }
+    }
+  }
+
+  std::string Context::GetGuestSymbolName(uint64_t GuestRIP) {
+    std::string Filename;
+    uint64_t FileOffset;
+    if (!IRCaptureCache.FindNamedRegion(GuestRIP, &Filename, &FileOffset)) {
+      // Anonymous memory, generated code or the region has been unmapped since
+      return fmt::format("JIT_0x{:x}", GuestRIP);
+    }
+
+    std::string Symbol;
+    uint64_t SymbolOffset;
+    if (GuestSymbolResolver && GuestSymbolResolver(Filename, FileOffset, &Symbol, &SymbolOffset)) {
+      return fmt::format("{}+0x{:x}", Symbol, SymbolOffset);
+    }
+
+    return fmt::format("{}+0x{:x}", std::filesystem::path(Filename).filename().string(), FileOffset);
+  }
+
+  bool Context::FindGuestFunctionBounds(uint64_t GuestRIP, uint64_t *Start, uint64_t *End) {
+    if (!GuestFunctionBoundsResolver) {
+      return false;
+    }
+
+    std::string Filename;
+    uint64_t FileOffset;
+    if (!IRCaptureCache.FindNamedRegion(GuestRIP, &Filename, &FileOffset)) {
+      return false;
+    }
+
+    uint64_t FunctionOffset, FunctionLength;
+    if (!GuestFunctionBoundsResolver(Filename, FileOffset, &FunctionOffset, &FunctionLength)) {
+      return false;
+    }
+
+    *Start = GuestRIP - (FileOffset - FunctionOffset);
+    *End = *Start + FunctionLength;
+    return true;
   }
 
   void Context::ClearCodeCache(FEXCore::Core::InternalThreadState *Thread, bool AlsoClearIRCache) {
+    if (TierUp) {
+      // Must happen before the code buffers are cleared, workers patch the baseline code
+      TierUp->ClearCodeCache(Thread);
+    }
+
+    if (SharedCode && (AlsoClearIRCache || SharedCode->IsCompileThread(Thread))) {
+      // Before the backend retires the shared code, no thread may pick up the old blocks after that
+      SharedCode->ClearCache();
+    }
+
+    ClearReturnStack(Thread);
     Thread->LookupCache->ClearCache();
     Thread->CPUBackend->ClearCache();
     if (Thread->CompileService) {
@@ -700,7 +857,7 @@ namespace FEXCore::Context {
     }
   }
 
-  Context::GenerateIRResult Context::GenerateIR(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP) {
+  Context::GenerateIRResult Context::GenerateIR(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP, FEXCore::Core::CompileStats *Stats) {
     uint8_t const *GuestCode{};
     GuestCode = reinterpret_cast<uint8_t const*>(GuestRIP);
 
@@ -709,8 +866,24 @@ namespace FEXCore::Context {
     uint64_t TotalInstructions {0};
     uint64_t TotalInstructionsLength {0};
 
+    std::chrono::steady_clock::time_point StageStart{};
+    auto StageTime = [&StageStart]() -> uint64_t {
+      auto Now = std::chrono::steady_clock::now();
+      auto Time = std::chrono::duration_cast<std::chrono::nanoseconds>(Now - StageStart);
+      StageStart = Now;
+      return Time.count();
+    };
+
+    if (Stats) {
+      StageStart = std::chrono::steady_clock::now();
+    }
+
     Thread->FrontendDecoder->DecodeInstructionsAtEntry(GuestCode, GuestRIP);
 
+    if (Stats) {
+      Stats->DecodeTime += StageTime();
+    }
+
     auto CodeBlocks = Thread->FrontendDecoder->GetDecodedBlocks();
 
     Thread->OpDispatcher->BeginFunction(GuestRIP, CodeBlocks);
@@ -806,6 +979,10 @@ namespace FEXCore::Context {
 
     Thread->OpDispatcher->Finalize();
 
+    if (Stats) {
+      Stats->DispatchTime += StageTime();
+    }
+
     // Debug
     {
       if (Thread->CTX->Config.DumpIR() != "no") {
@@ -818,7 +995,7 @@ namespace FEXCore::Context {
     }
 
     // Run the passmanager over the IR from the dispatcher
-    Thread->PassManager->Run(Thread->OpDispatcher.get());
+    Thread->PassManager->Run(Thread->OpDispatcher.get(), Stats);
 
     // Debug
     {
@@ -857,6 +1034,9 @@ namespace FEXCore::Context {
     uint64_t StartAddr {};
     uint64_t Length {};
 
+    // Only lives for this compile, the entry keeps the packed copy
+    IR::UnpackedIR Unpacked{};
+
     // Do we already have this in the IR cache?
     auto LocalEntry = Thread->LocalIRCache.find(GuestRIP);
 
@@ -869,9 +1049,31 @@ namespace FEXCore::Context {
       StartAddr = LocalEntry->second.StartAddr;
       Length = LocalEntry->second.Length;
 
+      if (!IRList && !LocalEntry->second.PackedIR.empty()) {
+        Unpacked = IR::UnpackIR(LocalEntry->second.PackedIR);
+        IRList = Unpacked.IRList.get();
+        RAData = Unpacked.RAData.get();
+      }
+
       GeneratedIR = false;
     }
 
+    // AOT code cache, relocated host code skips the frontend and the backend entirely
+    if (IRList == nullptr) {
+      auto [CodePtr, CodeDebugData, _StartAddr, _Length] = IRCaptureCache.PreGenerateCodeFetch(Thread, GuestRIP);
+      if (CodePtr) {
+        return {
+          .CompiledCode = CodePtr,
+          .IRData = nullptr,
+          .DebugData = CodeDebugData,
+          .RAData = nullptr,
+          .GeneratedIR = true,
+          .StartAddr = _StartAddr,
+          .Length = _Length,
+        };
+      }
+    }
+
     // AOT IR bookkeeping and cache
     {
       auto [IRCopy, RACopy, DebugDataCopy, _StartAddr, _Length, _GeneratedIR] = IRCaptureCache.PreGenerateIRFetch(GuestRIP, IRList);
@@ -886,9 +1088,22 @@ namespace FEXCore::Context {
       }
     }
 
+    // Only blocks that go through the whole pipeline are counted
+    std::unique_ptr<FEXCore::Core::CompileStats> Stats;
+
     if (IRList == nullptr) {
+      if (Config.CompileStats()) {
+        Stats = std::make_unique<FEXCore::Core::CompileStats>();
+      }
+
       // Generate IR + Meta Info
-      auto [IRCopy, RACopy, TotalInstructions, TotalInstructionsLength, _StartAddr, _Length] = GenerateIR(Thread, GuestRIP);
+      auto [IRCopy, RACopy, TotalInstructions, TotalInstructionsLength, _StartAddr, _Length] = GenerateIR(Thread, GuestRIP, Stats.get());
+
+      if (Stats) {
+        Stats->BlocksCompiled = 1;
+        Stats->GuestInstructions = TotalInstructions;
+        Stats->GuestCodeBytes = TotalInstructionsLength;
+      }
 
       // Setup pointers to internal structures
       IRList = IRCopy;
@@ -907,9 +1122,42 @@ namespace FEXCore::Context {
     if (IRList == nullptr) {
       return {};
     }
+    FEXCore::TierUpThreadData::Block *TierUpBlock{};
+    if (Thread->TierUpData) {
+      // Baseline tier, instrument the block so the TierUpService finds it once it gets hot
+      TierUpBlock = TierUp->AllocateBlock(Thread, GuestRIP);
+      Thread->CPUBackend->SetTierUpInstrumentation(&TierUpBlock->Instrumentation);
+    }
+
+    std::chrono::steady_clock::time_point BackendStart{};
+    if (Stats) {
+      BackendStart = std::chrono::steady_clock::now();
+    }
+
     // Attempt to get the CPU backend to compile this code
+    auto CompiledCode = Thread->CPUBackend->CompileCode(GuestRIP, IRList, DebugData, RAData);
+
+    if (Stats) {
+      Stats->BackendTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BackendStart).count();
+      Stats->HostCodeBytes = DebugData->HostCodeSize;
+
+      std::scoped_lock lk(CompileStatsMutex);
+      TotalCompileStats.Accumulate(*Stats);
+    }
+
+    if (TierUpBlock) {
+      Thread->CPUBackend->SetTierUpInstrumentation(nullptr);
+      TierUp->BlockCompiled(Thread, TierUpBlock, CompiledCode);
+    }
+
+    if (Unpacked.IRList) {
+      // Nothing past this point looks at IR that wasn't generated
+      IRList = nullptr;
+      RAData = nullptr;
+    }
+
     return {
-      .CompiledCode = Thread->CPUBackend->CompileCode(GuestRIP, IRList, DebugData, RAData),
+      .CompiledCode = CompiledCode,
       .IRData = IRList,
       .DebugData = DebugData,
       .RAData = RAData,
@@ -920,8 +1168,25 @@ namespace FEXCore::Context {
   }
 
   void Context::CompileBlockJit(FEXCore::Core::CpuStateFrame *Frame, uint64_t GuestRIP) {
+    // Only the dispatcher comes through here, no block is executing on this thread
+    CodeInvalidation->SafePoint(Frame->Thread);
+
+    // Measured where the guest thread blocks rather than summed from the compiles, background tiers overlap with execution
+    // Compiles nested in a signal handler are already covered by the outer one
+    const bool MeasureWait = Config.CompileStats() && Frame->Thread->CompileBlockReentrantRefCount == 0;
+    std::chrono::steady_clock::time_point WaitStart{};
+    if (MeasureWait) {
+      WaitStart = std::chrono::steady_clock::now();
+    }
+
     auto NewBlock = CompileBlock(Frame, GuestRIP);
 
+    if (MeasureWait) {
+      const uint64_t WaitTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - WaitStart).count();
+      std::scoped_lock lk(CompileStatsMutex);
+      TotalCompileStats.CompileWaitTime += WaitTime;
+    }
+
     if (NewBlock == 0) {
       LogMan::Msg::EFmt("CompileBlockJit: Failed to compile code {:X} - aborting process", GuestRIP);
       // Return similar behaviour of SIGILL abort
@@ -948,6 +1213,15 @@ namespace FEXCore::Context {
     bool GeneratedIR {};
     uint64_t StartAddr {}, Length {};
 
+    if (SharedCode && Thread->CompileBlockReentrantRefCount == 0) {
+      // Compile in to the process wide cache, our LookupCache picks it up from there on the next lookup
+      // Reentrant compiles from signal handlers still go through the CompileService and stay thread local
+      ++Thread->CompileBlockReentrantRefCount;
+      auto HostCode = SharedCode->CompileBlock(GuestRIP);
+      --Thread->CompileBlockReentrantRefCount;
+      return HostCode;
+    }
+
     if (Thread->CompileBlockReentrantRefCount != 0) {
       if (!Thread->CompileService) {
         Thread->CompileService = std::make_shared<FEXCore::CompileService>(this, Thread);
@@ -972,6 +1246,16 @@ namespace FEXCore::Context {
     } else {
       ++Thread->CompileBlockReentrantRefCount;
       DecrementRefCount = true;
+
+      if (TierUp) {
+        // Pick up blocks that were optimized in the background
+        // Only done while the ref count is held so a signal arriving here goes through the CompileService
+        TierUp->InstallCompletedBlocks(Thread);
+        if (auto HostCode = Thread->LookupCache->FindBlock(GuestRIP)) {
+          --Thread->CompileBlockReentrantRefCount;
+          return HostCode;
+        }
+      }
       auto [Code, IR, Data, RA, Generated, _StartAddr, _Length] = CompileCode(Thread, GuestRIP);
       CodePtr = Code;
       IRList = IR;
@@ -989,17 +1273,7 @@ namespace FEXCore::Context {
     }
 
     // The core managed to compile the code.
-    if (Config.BlockJITNaming()) {
-      if (DebugData) {
-        if (DebugData->Subblocks.size()) {
-          for (auto& Subblock: DebugData->Subblocks) {
-            Symbols.Register((void*)Subblock.HostCodeStart, GuestRIP, Subblock.HostCodeSize);
-          }
-        } else {
-          Symbols.Register(CodePtr, GuestRIP, DebugData->HostCodeSize);
-        }
-      }
-    }
+    RegisterBlockJITNaming(GuestRIP, CodePtr, DebugData);
 
     if (IRCaptureCache.PostCompileCode(
         Thread,
@@ -1069,6 +1343,9 @@ namespace FEXCore::Context {
 
     SignalDelegation->UninstallTLSState(Thread);
 
+    // The thread object can outlive the thread, it must not hold back code reclamation
+    CodeInvalidation->UnregisterThread(Thread);
+
     // If the parent thread is waiting to join, then we can't destroy our thread object
     if (!Thread->DestroyedByParent && Thread != Thread->CTX->ParentThread) {
       Thread->CTX->DestroyThread(Thread);
@@ -1076,22 +1353,65 @@ namespace FEXCore::Context {
   }
 
   void FlushCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length) {
+    // Decoded instructions check their bytes on use, this only drops the ones that are gone
+    Thread->CTX->DecodedInstructions.InvalidateRange(Start, Length);
+
+    if (Thread->CTX->Config.SMCChecks == FEXCore::Config::CONFIG_SMC_MMAN ||
+        Thread->CTX->Config.SMCChecks == FEXCore::Config::CONFIG_SMC_MTRACK) {
+      if (Thread->CTX->SMCTracker) {
+        // The guest's new mapping decides the protection now
+        Thread->CTX->SMCTracker->UntrackRange(Start, Length);
+      }
 
-    if (Thread->CTX->Config.SMCChecks == FEXCore::Config::CONFIG_SMC_MMAN) {
-      auto lower = Thread->LookupCache->CodePages.lower_bound(Start >> 12);
-      auto upper = Thread->LookupCache->CodePages.upper_bound((Start + Length) >> 12);
-
-      for (auto it = lower; it != upper; it++) {
-        for (auto Address: it->second)
-          Context::RemoveCodeEntry(Thread, Address);
-        it->second.clear();
+      std::vector<uint64_t> SharedBlocks;
+      if (Thread->CTX->SharedCode) {
+        // Blocks compiled in to the shared cache aren't tracked in our CodePages
+        SharedBlocks = Thread->CTX->SharedCode->TakeBlocksInRange(Start, Length);
       }
+
+      Thread->CTX->InvalidateThreadCodeRange(Thread, Start, Length, SharedBlocks);
+
+      // Other threads could have compiled the same code
+      Thread->CTX->CodeInvalidation->BroadcastCodeRange(Thread, Start, Length, SharedBlocks);
+    }
+  }
+
+  void UnprotectCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length) {
+    if (Thread->CTX->SMCTracker) {
+      Thread->CTX->SMCTracker->UnprotectRange(Thread, Start, Length);
     }
   }
 
   void Context::RemoveCodeEntry(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP) {
     Thread->LocalIRCache.erase(GuestRIP);
     Thread->LookupCache->Erase(GuestRIP);
+    ClearReturnStack(Thread);
+  }
+
+  void Context::InvalidateThreadCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length, std::vector<uint64_t> const &SharedBlocks) {
+    if (TierUp) {
+      // Optimized blocks can cover more guest code than the baseline blocks, their pages need to be known first
+      ++Thread->CompileBlockReentrantRefCount;
+      TierUp->InstallCompletedBlocks(Thread);
+      TierUp->FlushCodeRange(Thread, Start, Length);
+      --Thread->CompileBlockReentrantRefCount;
+    }
+
+    Thread->LookupCache->CodePages.TakeRange(Start >> 12, (Start + Length) >> 12, [Thread](uint64_t Address) {
+      Context::RemoveCodeEntry(Thread, Address);
+    });
+
+    for (auto Address : SharedBlocks) {
+      Context::RemoveCodeEntry(Thread, Address);
+    }
+  }
+
+  void Context::ClearReturnStack(FEXCore::Core::InternalThreadState *Thread) {
+    // Any of the host code pointers could be stale now, a miss only costs a regular lookup
+    for (auto &Entry : Thread->CurrentFrame->ReturnStack) {
+      Entry.GuestRIP = 0;
+      Entry.HostCode = 0;
+    }
   }
 
   // Debug interface
@@ -1116,6 +1436,11 @@ namespace FEXCore::Context {
     return &Threads[Thread]->Stats;
   }
 
+  FEXCore::Core::CompileStats Context::GetCompileStats() {
+    std::scoped_lock lk(CompileStatsMutex);
+    return TotalCompileStats;
+  }
+
   bool Context::GetDebugDataForRIP(uint64_t RIP, FEXCore::Core::DebugData *Data) {
     auto it = ParentThread->LocalIRCache.find(RIP);
     if (it == ParentThread->LocalIRCache.end()) {
@@ -1139,6 +1464,14 @@ namespace FEXCore::Context {
   uint64_t HandleSyscall(FEXCore::HLE::SyscallHandler *Handler, FEXCore::Core::CpuStateFrame *Frame, FEXCore::HLE::SyscallArguments *Args) {
     uint64_t Result{};
     Result = Handler->HandleSyscall(Frame, Args);
+
+    // The kernel doesn't fault on writes to our write-protected code pages, it fails the syscall with EFAULT
+    // Syscalls that write guest buffers unprotect them before they are issued, nothing can be retried here
+    if (Frame->Thread->CTX->SMCTracker) {
+      // The syscall's own writes to guest memory can have hit code pages, the block continues after this
+      FEXCore::SMCPageTracker::InvalidateHostWrites(Frame->Thread);
+    }
+
     return Result;
   }
 
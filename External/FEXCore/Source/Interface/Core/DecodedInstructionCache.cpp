@@ -0,0 +1,69 @@
+/*
+$info$
+tags: frontend|x86-meta-blocks
+desc: Caches decoded guest instructions between decoder runs
+$end_info$
+*/
+
+#include "Interface/Core/DecodedInstructionCache.h"
+
+#include <mutex>
+#include <new>
+
+namespace FEXCore::Frontend {
+  void DecodedInstructionCache::FetchRun(uint64_t PC, std::vector<Entry> *Run) {
+    std::shared_lock lk(Mutex);
+
+    while (Run->size() < MAX_RUN_LENGTH) {
+      auto it = Instructions.find(PC);
+      if (it == Instructions.end()) {
+        break;
+      }
+
+      auto &Inst = Run->emplace_back(it->second).Inst;
+      if (Inst.TableInfo->Flags &
+          (FEXCore::X86Tables::InstFlags::FLAGS_BLOCK_END | FEXCore::X86Tables::InstFlags::FLAGS_SETS_RIP)) {
+        break;
+      }
+
+      PC += Inst.InstSize;
+    }
+  }
+
+  void DecodedInstructionCache::Insert(std::vector<Entry> const &Entries) {
+    std::unique_lock lk(Mutex);
+
+    if (Instructions.size() + Entries.size() > MAX_ENTRIES) {
+      Instructions.clear();
+      Pages.Clear();
+    }
+
+    for (auto &Entry : Entries) {
+      const uint64_t PC = Entry.Inst.PC;
+      if (!Instructions.try_emplace(PC, Entry).second) {
+        // Decoded twice in the same run
+        continue;
+      }
+
+      const uint64_t FirstPage = PC >> 12;
+      const uint64_t LastPage = (PC + Entry.Inst.InstSize - 1) >> 12;
+      Pages.Insert(FirstPage, PC);
+      if (LastPage != FirstPage) {
+        Pages.Insert(LastPage, PC);
+      }
+    }
+  }
+
+  void DecodedInstructionCache::InvalidateRange(uint64_t Start, uint64_t Length) {
+    std::unique_lock lk(Mutex);
+
+    Pages.TakeRange(Start >> 12, (Start + Length) >> 12, [this](uint64_t PC) {
+      Instructions.erase(PC);
+    });
+  }
+
+  void DecodedInstructionCache::CleanupAfterFork() {
+    // A thread that died with the fork could have been holding it
+    new (&Mutex) std::shared_mutex{};
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Common/FlatMultiMap.h"
+
+#include <FEXCore/Debug/X86Tables.h>
+
+#include <tsl/robin_map.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+namespace FEXCore::Frontend {
+
+/**
+ * @brief Process wide cache of decoded guest instructions
+ *
+ * Overlapping multiblock entries, other threads and recompiles after a code cache clear
+ * all decode the same instructions again. The decoder pulls straight line runs of
+ * instructions from here before falling back to decoding the bytes.
+ *
+ * Every entry keeps the bytes it was decoded from and the decoder compares them on use,
+ * so code that changed without going through an invalidation is still decoded again.
+ * Invalidation only keeps stale entries from piling up.
+ */
+class DecodedInstructionCache final {
+  public:
+    static constexpr size_t MAX_INST_SIZE = 15;
+
+    struct Entry {
+      FEXCore::X86Tables::DecodedInst Inst;
+      std::array<uint8_t, MAX_INST_SIZE> Bytes;
+    };
+
+    /**
+     * @brief Copies the cached instructions that follow each other from PC on
+     *
+     * The run stops at the first missing instruction or at an instruction that ends a block.
+     */
+    void FetchRun(uint64_t PC, std::vector<Entry> *Run);
+
+    void Insert(std::vector<Entry> const &Entries);
+
+    void InvalidateRange(uint64_t Start, uint64_t Length);
+
+    void CleanupAfterFork();
+
+  private:
+    // Upper bound for the copy that FetchRun does
+    static constexpr size_t MAX_RUN_LENGTH = 256;
+    // Around 32MB of entries, the whole cache gets dropped past this
+    static constexpr size_t MAX_ENTRIES = 256 * 1024;
+
+    std::shared_mutex Mutex{};
+
+    tsl::robin_map<uint64_t, Entry> Instructions;
+    // Guest page to the instructions that have bytes in it
+    FEXCore::FlatMultiMap<uint64_t> Pages;
+};
+}
@@ -82,6 +82,7 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
   // We want to ensure that we are 16 byte aligned at the top of this loop
   Align16B();
   aarch64::Label FullLookup{};
+  aarch64::Label NoBlock{};
   aarch64::Label CallBlock{};
   aarch64::Label LoopTop{};
   aarch64::Label ExitSpillSRA{};
@@ -95,6 +96,10 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
   ldr(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, State.rip)));
   auto RipReg = x2;
 
+  // Another thread invalidated code, the compiler picks up the work
+  ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, PendingCodeInvalidation)));
+  cbnz(x0, &NoBlock);
+
   // L1 Cache
   ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, Pointers.AArch64.L1Pointer)));
 
@@ -127,12 +132,18 @@ Arm64Dispatcher::Arm64Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::
     and_(x3, RipReg, x3);
   }
 
-  aarch64::Label NoBlock;
   {
-    // Offset the address and add to our page pointer
-    lsr(x1, x3, 12);
+    // Offset the address and add to our page pointer directory
+    lsr(x1, x3, 12 + LookupCache::L2_TABLE_BITS);
+
+    // Load the L2 table from the offset
+    ldr(x0, MemOperand(x0, x1, Shift::LSL, 3));
+
+    // If the table is zero then we have no block
+    cbz(x0, &NoBlock);
 
-    // Load the pointer from the offset
+    // Load the page pointer from the table
+    ubfx(x1, x3, 12, LookupCache::L2_TABLE_BITS);
     ldr(x0, MemOperand(x0, x1, Shift::LSL, 3));
 
     // If page pointer is zero then we have no block
@@ -3,6 +3,8 @@
 #include "Interface/Core/Dispatcher/Dispatcher.h"
 #include "Interface/Core/X86HelperGen.h"
 #include "Interface/Core/CompileService.h"
+#include "Interface/Core/SharedCodeCache.h"
+#include "Interface/Core/TierUpService.h"
 
 #include <FEXCore/Config/Config.h>
 #include <FEXCore/Core/CoreState.h>
@@ -773,6 +775,14 @@ bool Dispatcher::IsAddressInJITCode(uint64_t Address, bool IncludeDispatcher, bo
   if (IncludeCompileService &&  ThreadState->CompileService && ThreadState->CompileService->IsAddressInJITCode(Address)) {
     return true;
   }
+
+  if (IncludeCompileService && CTX->SharedCode && CTX->SharedCode->IsAddressInJITCode(Address)) {
+    return true;
+  }
+
+  if (IncludeCompileService && CTX->TierUp && CTX->TierUp->IsAddressInJITCode(Address)) {
+    return true;
+  }
   return false;
 }
 
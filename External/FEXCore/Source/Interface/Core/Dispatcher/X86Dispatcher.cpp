@@ -94,6 +94,10 @@ X86Dispatcher::X86Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::Inte
     // Load our RIP
     mov(rdx, qword [STATE + offsetof(FEXCore::Core::CPUState, rip)]);
 
+    // Another thread invalidated code, the compiler picks up the work
+    cmp(qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, PendingCodeInvalidation)], 0);
+    jne(NoBlock, T_NEAR);
+
     // L1 Cache
     mov(r13, qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, Pointers.X86.L1Pointer)]);
     mov(rax, rdx);
@@ -120,8 +124,17 @@ X86Dispatcher::X86Dispatcher(FEXCore::Context::Context *ctx, FEXCore::Core::Inte
     and_(rax, rbx);
     shr(rax, 12);
 
+    // Load the L2 table
+    mov(rcx, rax);
+    shr(rcx, LookupCache::L2_TABLE_BITS);
+    mov(rdi, qword [r13 + rcx * 8]);
+
+    cmp(rdi, 0);
+    je(NoBlock);
+
     // Load page pointer
-    mov(rdi, qword [r13 + rax * 8]);
+    and_(rax, LookupCache::L2_TABLE_MASK);
+    mov(rdi, qword [rdi + rax * 8]);
 
     cmp(rdi, 0);
     je(NoBlock);
@@ -7,6 +7,7 @@ $end_info$
 
 #include "Interface/Context/Context.h"
 #include "Interface/Core/Frontend.h"
+#include "Interface/Core/TierUpService.h"
 
 #include <array>
 #include <assert.h>
@@ -21,6 +22,7 @@ $end_info$
 #include <FEXCore/Utils/Telemetry.h>
 #include <set>
 #include <sys/mman.h>
+#include <utility>
 
 namespace FEXCore::Frontend {
 #include "Interface/Core/VSyscall/VSyscall.inc"
@@ -1053,7 +1055,7 @@ bool Decoder::DecodeInstruction(uint64_t PC) {
 }
 
 void Decoder::BranchTargetInMultiblockRange() {
-  if (!CTX->Config.Multiblock)
+  if (!Multiblock)
     return;
 
   // If the RIP setting is conditional AND within our symbol range then it can be considered for multiblock
@@ -1078,16 +1080,40 @@ void Decoder::BranchTargetInMultiblockRange() {
       TargetRIP = DecodeInst->PC + DecodeInst->InstSize + DecodeInst->Src[0].Data.Literal.Value;
       Conditional = false;
     break;
-    case 0xE8: // Call - Immediate target, We don't want to inline calls
+    case 0xE8: { // Call - Immediate target
+      const uint64_t ReturnRIP = DecodeInst->PC + DecodeInst->InstSize;
       if (ExternalBranches) {
-        ExternalBranches->insert(DecodeInst->PC + DecodeInst->InstSize);
+        ExternalBranches->insert(ReturnRIP);
       }
-      [[fallthrough]];
+
+      LOGMAN_THROW_A_FMT(DecodeInst->Src[0].IsLiteral(), "Had wrong operand type");
+      TargetRIP = ReturnRIP + DecodeInst->Src[0].Data.Literal.Value;
+      if (GPRSize == 4) {
+        TargetRIP &= 0xFFFFFFFFU;
+      }
+
+      // Small leaf functions become part of the region, the dispatcher only ever sees the caller
+      if (IsInlineableCall(TargetRIP)) {
+        InlinedCallReturns.insert(ReturnRIP);
+        AddBlockToDecode(TargetRIP);
+        AddBlockToDecode(ReturnRIP);
+      }
+      return;
+    }
     case 0xC2: // RET imm
     case 0xC3: // RET
+      return;
     default:
+      // Indirect branches continue in to the targets that the baseline tier saw
+      // Only the optimized tier decodes with multiblock, the baseline tier is what records the profile
+      if (Multiblock && CTX->TierUp) {
+        for (auto Target : CTX->TierUp->GetIndirectBranchTargets(DecodeInst->PC)) {
+          if (Target >= SymbolMinAddress && Target < SymbolMaxAddress) {
+            AddBlockToDecode(Target);
+          }
+        }
+      }
       return;
-    break;
   }
 
   if (GPRSize == 4) {
@@ -1103,17 +1129,10 @@ void Decoder::BranchTargetInMultiblockRange() {
       MaxCondBranchBackwards = std::min(MaxCondBranchBackwards, TargetRIP);
 
       // If we are conditional then a target can be the instruction past the conditional instruction
-      uint64_t FallthroughRIP = DecodeInst->PC + DecodeInst->InstSize;
-      if (HasBlocks.find(FallthroughRIP) == HasBlocks.end() &&
-          BlocksToDecode.find(FallthroughRIP) == BlocksToDecode.end()) {
-        BlocksToDecode.emplace(FallthroughRIP);
-      }
+      AddBlockToDecode(DecodeInst->PC + DecodeInst->InstSize);
     }
 
-    if (HasBlocks.find(TargetRIP) == HasBlocks.end() &&
-        BlocksToDecode.find(TargetRIP) == BlocksToDecode.end()) {
-      BlocksToDecode.emplace(TargetRIP);
-    }
+    AddBlockToDecode(TargetRIP);
   } else {
     if (ExternalBranches) {
       ExternalBranches->insert(TargetRIP);
@@ -1121,6 +1140,86 @@ void Decoder::BranchTargetInMultiblockRange() {
   }
 }
 
+bool Decoder::IsInlineableCall(uint64_t TargetRIP) {
+  if (!Multiblock ||
+      InlinedCallReturns.size() >= MaxInlinedCalls ||
+      DecodedSize >= DefaultDecodedBufferSize) {
+    return false;
+  }
+
+  // Keep the region's code range small, it is what gets tracked for invalidation
+  if (TargetRIP < EntryPoint - std::min(EntryPoint, MaxFunctionRegionSize) ||
+      TargetRIP >= EntryPoint + MaxFunctionRegionSize) {
+    return false;
+  }
+
+  // Only decode bytes that we know are code
+  uint64_t CalleeEnd{};
+  if (TargetRIP >= SymbolMinAddress && TargetRIP < SymbolMaxAddress) {
+    CalleeEnd = SymbolMaxAddress;
+  }
+  else {
+    uint64_t FunctionStart{}, FunctionEnd{};
+    if (!CTX->FindGuestFunctionBounds(TargetRIP, &FunctionStart, &FunctionEnd) ||
+        FunctionStart != TargetRIP) {
+      return false;
+    }
+    CalleeEnd = std::min(FunctionEnd, SectionMaxAddress);
+  }
+
+  // Decode the callee in to the next free slot, nothing in here is kept
+  auto CallerInstStream = InstStream;
+  auto CallerDecodeInst = DecodeInst;
+  bool Inlineable = false;
+  uint64_t PC = TargetRIP;
+
+  for (size_t i = 0; i < MaxInlinedCallInstructions && PC < CalleeEnd; ++i) {
+    InstStream = AdjustAddrForSpecialRegion(InstStreamBase, EntryPoint, PC);
+    if (!DecodeInstruction(PC) ||
+        PC + DecodeInst->InstSize > CalleeEnd) {
+      break;
+    }
+
+    if (DecodeInst->TableInfo->Flags &
+        (FEXCore::X86Tables::InstFlags::FLAGS_BLOCK_END | FEXCore::X86Tables::InstFlags::FLAGS_SETS_RIP)) {
+      // Anything but falling through to a plain RET could call further or never come back
+      Inlineable = DecodeInst->TableInfo == &FEXCore::X86Tables::BaseOps[0xC3];
+      break;
+    }
+
+    PC += DecodeInst->InstSize;
+  }
+
+  InstStream = CallerInstStream;
+  DecodeInst = CallerDecodeInst;
+  return Inlineable;
+}
+
+void Decoder::AddBlockToDecode(uint64_t RIP) {
+  if (SeenBlocks.insert(RIP).second) {
+    BlocksToDecode.emplace_back(RIP);
+  }
+}
+
+bool Decoder::FetchCachedInstruction(uint64_t PC) {
+  if (CachedRunIndex >= CachedRun.size()) {
+    return false;
+  }
+
+  auto &Cached = CachedRun[CachedRunIndex];
+  if (Cached.Inst.PC != PC ||
+      memcmp(InstStream, Cached.Bytes.data(), Cached.Inst.InstSize) != 0) {
+    // The code changed without an invalidation, nothing past this point can be trusted either
+    CachedRunIndex = CachedRun.size();
+    return false;
+  }
+
+  ++CachedRunIndex;
+  DecodeInst = &DecodedBuffer[DecodedSize];
+  *DecodeInst = Cached.Inst;
+  return true;
+}
+
 const uint8_t *Decoder::AdjustAddrForSpecialRegion(uint8_t const* _InstStream, uint64_t EntryPoint, uint64_t RIP) {
   constexpr uint64_t VSyscall_Base = 0xFFFF'FFFF'FF60'0000ULL;
   constexpr uint64_t VSyscall_End = VSyscall_Base + 0x1000;
@@ -1143,21 +1242,31 @@ const uint8_t *Decoder::AdjustAddrForSpecialRegion(uint8_t const* _InstStream, u
 void Decoder::DecodeInstructionsAtEntry(uint8_t const* _InstStream, uint64_t PC) {
   Blocks.clear();
   BlocksToDecode.clear();
-  HasBlocks.clear();
+  SeenBlocks.clear();
+  InlinedCallReturns.clear();
+  NewInstructions.clear();
   // Reset internal state management
   DecodedSize = 0;
   MaxCondBranchForward = 0;
   MaxCondBranchBackwards = ~0ULL;
 
-  // XXX: Load symbol data
-  SymbolAvailable = false;
   EntryPoint = PC;
   InstStream = _InstStream;
+  InstStreamBase = _InstStream;
 
   uint64_t TotalInstructions{};
 
-  // If we don't have symbols available then we become a bit optimistic about multiblock ranges
-  if (!SymbolAvailable) {
+  uint64_t FunctionStart{}, FunctionEnd{};
+  SymbolAvailable = Multiblock &&
+                    CTX->FindGuestFunctionBounds(EntryPoint, &FunctionStart, &FunctionEnd);
+
+  if (SymbolAvailable) {
+    // Branches back to the start of the function are fine as well, this lets a loop around the entry become one region
+    SymbolMinAddress = std::max(FunctionStart, EntryPoint - std::min(EntryPoint, MaxFunctionRegionSize));
+    SymbolMaxAddress = std::min({FunctionEnd, SectionMaxAddress, EntryPoint + MaxFunctionRegionSize});
+  }
+  else {
+    // If we don't have symbols available then we become a bit optimistic about multiblock ranges
     // If we don't have a symbol available then assume all branches are valid for multiblock
     SymbolMaxAddress = SectionMaxAddress;
     SymbolMinAddress = EntryPoint;
@@ -1167,11 +1276,11 @@ void Decoder::DecodeInstructionsAtEntry(uint8_t const* _InstStream, uint64_t PC)
   DecodedMaxAddress = EntryPoint;
 
   // Entry is a jump target
-  BlocksToDecode.emplace(PC);
+  AddBlockToDecode(PC);
 
   while (!BlocksToDecode.empty()) {
-    auto BlockDecodeIt = BlocksToDecode.begin();
-    uint64_t RIPToDecode = *BlockDecodeIt;
+    uint64_t RIPToDecode = BlocksToDecode.back();
+    BlocksToDecode.pop_back();
     Blocks.emplace_back();
     DecodedBlocks &CurrentBlockDecoding = Blocks.back();
 
@@ -1184,8 +1293,20 @@ void Decoder::DecodeInstructionsAtEntry(uint8_t const* _InstStream, uint64_t PC)
     // Do a bit of pointer math to figure out where we are in code
     InstStream = AdjustAddrForSpecialRegion(_InstStream, EntryPoint, RIPToDecode);
 
+    CachedRun.clear();
+    CachedRunIndex = 0;
+    CTX->DecodedInstructions.FetchRun(RIPToDecode, &CachedRun);
+
     while (1) {
-      bool ErrorDuringDecoding = !DecodeInstruction(RIPToDecode + PCOffset);
+      bool ErrorDuringDecoding = false;
+      if (!FetchCachedInstruction(RIPToDecode + PCOffset)) {
+        ErrorDuringDecoding = !DecodeInstruction(RIPToDecode + PCOffset);
+
+        if (!ErrorDuringDecoding) {
+          auto &Entry = NewInstructions.emplace_back(DecodedInstructionCache::Entry{*DecodeInst, {}});
+          memcpy(Entry.Bytes.data(), InstStream, DecodeInst->InstSize);
+        }
+      }
 
       if (ErrorDuringDecoding) {
         LogMan::Msg::DFmt("Couldn't Decode something at 0x{:x}, Started at 0x{:x}", PC + PCOffset, PC);
@@ -1238,19 +1359,20 @@ void Decoder::DecodeInstructionsAtEntry(uint8_t const* _InstStream, uint64_t PC)
       InstStream += DecodeInst->InstSize;
     }
 
-    BlocksToDecode.erase(BlockDecodeIt);
-    HasBlocks.emplace(RIPToDecode);
-
     // Copy over only the number of instructions we decoded
     CurrentBlockDecoding.NumInstructions = BlockNumberOfInstructions;
     CurrentBlockDecoding.DecodedInstructions = &DecodedBuffer[BlockStartOffset];
+    CurrentBlockDecoding.IsInlinedCallReturn = InlinedCallReturns.contains(RIPToDecode);
   }
 
 
   // sort for better branching
-  std::sort(Blocks.begin(), Blocks.end(), [](const FEXCore::Frontend::Decoder::DecodedBlocks& a, const FEXCore::Frontend::Decoder::DecodedBlocks& b) {
-    return a.Entry < b.Entry;
+  // The entry needs to be the first block even if the function has code before it
+  std::sort(Blocks.begin(), Blocks.end(), [this](const FEXCore::Frontend::Decoder::DecodedBlocks& a, const FEXCore::Frontend::Decoder::DecodedBlocks& b) {
+    return std::make_pair(a.Entry != EntryPoint, a.Entry) < std::make_pair(b.Entry != EntryPoint, b.Entry);
   });
+
+  CTX->DecodedInstructions.Insert(NewInstructions);
 }
 
 }
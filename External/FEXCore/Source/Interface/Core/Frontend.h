@@ -1,9 +1,13 @@
 #pragma once
 
+#include "Interface/Core/DecodedInstructionCache.h"
+
 #include <FEXCore/Debug/X86Tables.h>
 #include <FEXCore/HLE/SyscallHandler.h>
 #include <FEXCore/Utils/Telemetry.h>
 
+#include <tsl/robin_set.h>
+
 #include <array>
 #include <cstdint>
 #include <set>
@@ -23,6 +27,8 @@ public:
     uint64_t NumInstructions{};
     FEXCore::X86Tables::DecodedInst *DecodedInstructions;
     bool HasInvalidInstruction{};
+    // Return address of a call whose callee got pulled in to the region
+    bool IsInlinedCallReturn{};
   };
 
   Decoder(FEXCore::Context::Context *ctx);
@@ -38,6 +44,8 @@ public:
 
   void SetSectionMaxAddress(uint64_t v) { SectionMaxAddress = v; }
   void SetExternalBranches(std::set<uint64_t> *v) { ExternalBranches = v; }
+  // The baseline tier decodes single blocks even with multiblock enabled
+  void SetMultiblock(bool v) { Multiblock = v; }
 private:
   // To pass any information from instruction prefixes
   // down into the actual instruction handling machinery.
@@ -50,8 +58,11 @@ private:
   const FEXCore::HLE::SyscallOSABI OSABI{};
 
   bool DecodeInstruction(uint64_t PC);
+  bool FetchCachedInstruction(uint64_t PC);
 
   void BranchTargetInMultiblockRange();
+  bool IsInlineableCall(uint64_t TargetRIP);
+  void AddBlockToDecode(uint64_t RIP);
 
   uint8_t ReadByte();
   uint8_t PeekByte(uint8_t Offset) const;
@@ -66,6 +77,8 @@ private:
   size_t DecodedSize {};
 
   uint8_t const *InstStream;
+  // Guest memory at the region's entry
+  uint8_t const *InstStreamBase;
 
   static constexpr size_t MAX_INST_SIZE = 15;
   uint8_t InstructionSize;
@@ -73,6 +86,9 @@ private:
   FEXCore::X86Tables::DecodedInst *DecodeInst;
 
   // This is for multiblock data tracking
+  // Whole function regions stay within this distance of the entry
+  static constexpr uint64_t MaxFunctionRegionSize = 0x4000;
+  bool Multiblock {false};
   bool SymbolAvailable {false};
   uint64_t EntryPoint {};
   uint64_t MaxCondBranchForward {};
@@ -81,11 +97,24 @@ private:
   uint64_t SymbolMinAddress {~0ULL};
   uint64_t SectionMaxAddress {~0ULL};
 
+  // Straight line leaf functions up to this size get decoded as part of the caller's region
+  static constexpr size_t MaxInlinedCallInstructions = 32;
+  // Every inlined call adds a compare to each RET in the region
+  static constexpr size_t MaxInlinedCalls = 8;
+  tsl::robin_set<uint64_t> InlinedCallReturns;
+
   std::vector<DecodedBlocks> Blocks;
-  std::set<uint64_t> BlocksToDecode;
-  std::set<uint64_t> HasBlocks;
+  std::vector<uint64_t> BlocksToDecode;
+  // Blocks that were decoded or are queued
+  tsl::robin_set<uint64_t> SeenBlocks;
   std::set<uint64_t> *ExternalBranches {nullptr};
 
+  // Cached instructions for the block being decoded
+  std::vector<DecodedInstructionCache::Entry> CachedRun;
+  size_t CachedRunIndex {};
+  // Decoded this time around, added to the cache once we are done
+  std::vector<DecodedInstructionCache::Entry> NewInstructions;
+
   // ModRM rm decoding
   using DecodeModRMPtr = void (FEXCore::Frontend::Decoder::*)(X86Tables::DecodedOperand *Operand, X86Tables::ModRMDecoded ModRM);
   void DecodeModRM_16(X86Tables::DecodedOperand *Operand, X86Tables::ModRMDecoded ModRM);
@@ -2,6 +2,7 @@
 
 #include "Interface/Core/InternalThreadState.h"
 #include "Interface/Core/Dispatcher/Dispatcher.h"
+#include "Interface/Core/Interpreter/InterpreterOps.h"
 
 #include <FEXCore/Core/CPUBackend.h>
 #include <FEXCore/IR/IR.h>
@@ -41,6 +42,8 @@ public:
 
   bool NeedsRetainedIRCopy() const override { return true; }
 
+  InterpreterSSAStack SSAStack{};
+
 private:
   FEXCore::Context::Context *CTX;
   FEXCore::Core::InternalThreadState *State;
@@ -31,7 +31,13 @@ static void InterpreterExecution(FEXCore::Core::CpuStateFrame *Frame) {
 
   auto LocalEntry = Thread->LocalIRCache.find(Thread->CurrentFrame->State.rip);
 
-  InterpreterOps::InterpretIR(Thread, Thread->CurrentFrame->State.rip, LocalEntry->second.IR.get(), LocalEntry->second.DebugData.get());
+  auto &Interpreted = LocalEntry->second.Interpreted;
+  if (!Interpreted) {
+    Interpreted.reset(InterpreterOps::TranslateIR(LocalEntry->second.IR.get()));
+  }
+
+  auto Core = static_cast<InterpreterCore*>(Thread->CPUBackend.get());
+  InterpreterOps::InterpretIR(Thread, Thread->CurrentFrame->State.rip, LocalEntry->second.IR.get(), Interpreted.get(), &Core->SSAStack);
 }
 
 InterpreterCore::InterpreterCore(FEXCore::Context::Context *ctx, FEXCore::Core::InternalThreadState *Thread, bool CompileThread)
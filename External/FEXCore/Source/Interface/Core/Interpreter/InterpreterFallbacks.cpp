@@ -1,6 +1,7 @@
 #include "FEXCore/Core/CoreState.h"
 #include "Interface/Core/Interpreter/InterpreterOps.h"
 #include "Interface/Core/Interpreter/F80Ops.h"
+#include "Interface/Core/Interpreter/StringOps.h"
 
 #include <cstddef>
 #include <cstdint>
@@ -77,6 +78,11 @@ FallbackInfo GetFallbackInfo(X80SoftFloat(*fn)(X80SoftFloat, X80SoftFloat), FEXC
   return {FABI_F80_F80_F80, (void*)fn, HandlerIndex};
 }
 
+template<>
+FallbackInfo GetFallbackInfo(void(*fn)(FEXCore::Core::CpuStateFrame*, uint64_t, uint64_t, uint64_t, uint64_t), FEXCore::Core::FallbackHandlerIndex HandlerIndex) {
+  return {FABI_VOID_FRAME_U64_U64_U64_U64, (void*)fn, HandlerIndex};
+}
+
 void InterpreterOps::FillFallbackIndexPointers(uint64_t *Info) {
   Info[Core::OPINDEX_F80LOADFCW] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_F80LOADFCW>::handle, Core::OPINDEX_F80LOADFCW).fn);
   Info[Core::OPINDEX_F80CVTTO_4] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_F80CVTTO>::handle4, Core::OPINDEX_F80CVTTO_4).fn);
@@ -122,6 +128,16 @@ void InterpreterOps::FillFallbackIndexPointers(uint64_t *Info) {
   Info[Core::OPINDEX_F80FPREM1] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_F80FPREM1>::handle, Core::OPINDEX_F80FPREM1).fn);
   Info[Core::OPINDEX_F80FPREM] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_F80FPREM>::handle, Core::OPINDEX_F80FPREM).fn);
   Info[Core::OPINDEX_F80SCALE] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_F80SCALE>::handle, Core::OPINDEX_F80SCALE).fn);
+
+  // String ops
+  Info[Core::OPINDEX_MEMSET_1] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint8_t>, Core::OPINDEX_MEMSET_1).fn);
+  Info[Core::OPINDEX_MEMSET_2] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint16_t>, Core::OPINDEX_MEMSET_2).fn);
+  Info[Core::OPINDEX_MEMSET_4] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint32_t>, Core::OPINDEX_MEMSET_4).fn);
+  Info[Core::OPINDEX_MEMSET_8] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint64_t>, Core::OPINDEX_MEMSET_8).fn);
+  Info[Core::OPINDEX_MEMCPY_1] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint8_t>, Core::OPINDEX_MEMCPY_1).fn);
+  Info[Core::OPINDEX_MEMCPY_2] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint16_t>, Core::OPINDEX_MEMCPY_2).fn);
+  Info[Core::OPINDEX_MEMCPY_4] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint32_t>, Core::OPINDEX_MEMCPY_4).fn);
+  Info[Core::OPINDEX_MEMCPY_8] = reinterpret_cast<uint64_t>(GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint64_t>, Core::OPINDEX_MEMCPY_8).fn);
 }
 
 bool InterpreterOps::GetFallbackHandler(IR::IROp_Header *IROp, FallbackInfo *Info) {
@@ -261,6 +277,32 @@ bool InterpreterOps::GetFallbackHandler(IR::IROp_Header *IROp, FallbackInfo *Inf
     COMMON_X87_OP(FPREM)
     COMMON_X87_OP(SCALE)
 
+    case IR::OP_MEMSET: {
+      auto Op = IROp->C<IR::IROp_MemSet>();
+
+      switch (Op->ElementSize) {
+        case 1: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint8_t>, Core::OPINDEX_MEMSET_1); return true;
+        case 2: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint16_t>, Core::OPINDEX_MEMSET_2); return true;
+        case 4: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint32_t>, Core::OPINDEX_MEMSET_4); return true;
+        case 8: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMSET>::handle<uint64_t>, Core::OPINDEX_MEMSET_8); return true;
+        default: LogMan::Msg::DFmt("Unhandled size: {}", Op->ElementSize);
+      }
+      break;
+    }
+
+    case IR::OP_MEMCPY: {
+      auto Op = IROp->C<IR::IROp_MemCpy>();
+
+      switch (Op->ElementSize) {
+        case 1: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint8_t>, Core::OPINDEX_MEMCPY_1); return true;
+        case 2: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint16_t>, Core::OPINDEX_MEMCPY_2); return true;
+        case 4: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint32_t>, Core::OPINDEX_MEMCPY_4); return true;
+        case 8: *Info = GetFallbackInfo(&FEXCore::CPU::OpHandlers<IR::OP_MEMCPY>::handle<uint64_t>, Core::OPINDEX_MEMCPY_8); return true;
+        default: LogMan::Msg::DFmt("Unhandled size: {}", Op->ElementSize);
+      }
+      break;
+    }
+
     default:
       break;
   }
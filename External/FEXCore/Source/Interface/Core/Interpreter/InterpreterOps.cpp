@@ -35,7 +35,6 @@
 
 namespace FEXCore::CPU {
 
-using OpHandler = void (*)(IR::IROp_Header *IROp, InterpreterOps::IROpData *Data, IR::NodeID Node);
 using OpHandlerArray = std::array<OpHandler, IR::IROps::OP_LAST + 1>;
 
 constexpr OpHandlerArray InterpreterOpHandlers = [] {
@@ -112,8 +111,7 @@ constexpr OpHandlerArray InterpreterOpHandlers = [] {
   REGISTER_OP(ATOMICFETCHNEG,         AtomicFetchNeg);
 
   // Branch ops
-  REGISTER_OP(GUESTCALLDIRECT,        GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT,      GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,              GuestCall);
   REGISTER_OP(SIGNALRETURN,           SignalReturn);
   REGISTER_OP(CALLBACKRETURN,         CallbackReturn);
   REGISTER_OP(EXITFUNCTION,           ExitFunction);
@@ -159,6 +157,8 @@ constexpr OpHandlerArray InterpreterOpHandlers = [] {
   REGISTER_OP(VSTOREMEMELEMENT,       VStoreMemElement);
   REGISTER_OP(CACHELINECLEAR,         CacheLineClear);
   REGISTER_OP(CACHELINEZERO,          CacheLineZero);
+  REGISTER_OP(MEMSET,                 MemSet);
+  REGISTER_OP(MEMCPY,                 MemCpy);
 
   // Misc ops
   REGISTER_OP(DUMMY,                  NoOp);
@@ -321,67 +321,105 @@ void InterpreterOps::Op_Unhandled(FEXCore::IR::IROp_Header *IROp, IROpData *Data
 void InterpreterOps::Op_NoOp(FEXCore::IR::IROp_Header *IROp, IROpData *Data, IR::NodeID Node) {
 }
 
-void InterpreterOps::InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, FEXCore::Core::DebugData *DebugData) {
+void InterpretedBlockDeleter::operator()(InterpretedBlock *Block) {
+  delete Block;
+}
+
+InterpretedBlock *InterpreterOps::TranslateIR(FEXCore::IR::IRListView *CurrentIR) {
+  auto Block = new InterpretedBlock{};
+  Block->SSACount = CurrentIR->GetSSACount();
+
+  // Code block to the index of its first instruction
+  std::vector<uint32_t> BlockStarts(Block->SSACount);
+
+  for (auto [BlockNode, BlockHeader] : CurrentIR->GetBlocks()) {
+    BlockStarts[CurrentIR->GetID(BlockNode).Value] = Block->Instructions.size();
+
+    for (auto [CodeNode, IROp] : CurrentIR->GetCode(BlockNode)) {
+      OpHandler Handler = InterpreterOpHandlers[IROp->Op];
+      if (Handler == &InterpreterOps::Op_NoOp) {
+        continue;
+      }
+
+      Block->Instructions.emplace_back(InterpretedBlock::Instruction{Handler, IROp, CurrentIR->GetID(CodeNode), {}});
+    }
+  }
+
+  // Falling out of the last code block leaves
+  Block->Instructions.emplace_back(InterpretedBlock::Instruction{nullptr, nullptr, {}, {}});
+
+  // Every code block is placed now, resolve the branches so a taken branch doesn't have to look its target up
+  for (auto &Inst : Block->Instructions) {
+    if (!Inst.IROp) {
+      continue;
+    }
+
+    if (Inst.IROp->Op == IR::OP_JUMP) {
+      Inst.Targets[0] = BlockStarts[Inst.IROp->Args[0].ID().Value];
+    }
+    else if (Inst.IROp->Op == IR::OP_CONDJUMP) {
+      auto Op = Inst.IROp->C<IR::IROp_CondJump>();
+      Inst.Targets[0] = BlockStarts[Op->TrueBlock.ID().Value];
+      Inst.Targets[1] = BlockStarts[Op->FalseBlock.ID().Value];
+    }
+  }
+
+  return Block;
+}
+
+void InterpreterOps::InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, InterpretedBlock *Block, InterpreterSSAStack *SSAStack) {
   volatile void *StackEntry = alloca(0);
 
-  uintptr_t ListSize = CurrentIR->GetSSACount();
+  uintptr_t ListSize = Block->SSACount;
 
   static_assert(sizeof(FEXCore::IR::IROp_Header) == 4);
   static_assert(sizeof(FEXCore::IR::OrderedNode) == 16);
 
-  auto BlockEnd = CurrentIR->GetBlocks().end();
-
   InterpreterOps::IROpData OpData{};
   OpData.State = Thread;
-  OpData.SSAData = alloca(ListSize * 16);
   OpData.CurrentEntry = Entry;
   OpData.CurrentIR = CurrentIR;
   OpData.StackEntry = StackEntry;
-  OpData.BlockIterator = CurrentIR->GetBlocks().begin();
+
+  // A block that returns through InterpreterCallbackReturn never gives its storage back, the block it nested in does
+  const size_t SSAOffset = SSAStack->Offset;
+  if (SSAOffset + ListSize * 16 <= InterpreterSSAStack::SIZE) {
+    OpData.SSAData = SSAStack->Data.get() + SSAOffset;
+    SSAStack->Offset = SSAOffset + ListSize * 16;
+  }
+  else {
+    // Nested too deep or a huge multiblock
+    OpData.SSAData = alloca(ListSize * 16);
+  }
 
   // Clear them all to zero. Required for Zero-extend semantics
   memset(OpData.SSAData, 0, ListSize * 16);
 
-  while (1) {
-    using namespace FEXCore::IR;
-    auto [BlockNode, BlockHeader] = OpData.BlockIterator();
-    auto BlockIROp = BlockHeader->CW<IROp_CodeBlock>();
-    LOGMAN_THROW_A_FMT(BlockIROp->Header.Op == IR::OP_CODEBLOCK, "IR type failed to be a code block");
-
-    // Reset the block results per block
-    memset(&OpData.BlockResults, 0, sizeof(OpData.BlockResults));
-
-    auto CodeBegin = CurrentIR->at(BlockIROp->Begin);
-    auto CodeLast = CurrentIR->at(BlockIROp->Last);
-
-    for (auto [CodeNode, IROp] : CurrentIR->GetCode(BlockNode)) {
-      const auto ID = CurrentIR->GetID(CodeNode);
-      const uint32_t Op = IROp->Op;
-
-      // Execute handler
-      OpHandler Handler = InterpreterOpHandlers[Op];
+  const InterpretedBlock::Instruction *Instructions = Block->Instructions.data();
+  const InterpretedBlock::Instruction *Inst = Instructions;
 
-      Handler(IROp, &OpData, ID);
+  while (Inst->Handler) {
+    Inst->Handler(Inst->IROp, &OpData, Inst->ID);
 
-      if (OpData.BlockResults.Quit ||
-          OpData.BlockResults.Redo ||
-          CodeBegin == CodeLast) {
-        break;
-      }
-
-      ++CodeBegin;
+    if (OpData.BlockResults.Quit) {
+      break;
     }
 
-    // Iterator will have been set, go again
     if (OpData.BlockResults.Redo) {
-      continue;
+      OpData.BlockResults.Redo = false;
+      Inst = Instructions + Inst->Targets[OpData.BranchTarget];
     }
-
-    // If we have set to early exit or at the end block then leave
-    if (OpData.BlockResults.Quit || ++OpData.BlockIterator == BlockEnd) {
-      break;
+    else {
+      ++Inst;
     }
   }
+
+  SSAStack->Offset = SSAOffset;
+
+  if (OpData.RemoveCodeEntry) {
+    // Frees the IR and the translated block, nothing can touch them past this point
+    FEXCore::Context::Context::RemoveCodeEntry(Thread, Entry);
+  }
 }
 
 }
@@ -5,6 +5,10 @@
 #include <FEXCore/IR/IR.h>
 #include <FEXCore/IR/IntrusiveIRList.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace FEXCore::Core {
   struct InternalThreadState;
 }
@@ -19,6 +23,20 @@ namespace FEXCore::Core{
 }
 
 namespace FEXCore::CPU {
+  struct InterpretedBlock;
+
+  /**
+   * @brief Per-thread storage for the SSA values of the interpreted blocks
+   *
+   * Guest callbacks and guest signal handlers can run in the middle of a block, the blocks they execute
+   * take the storage above the interrupted block.
+   */
+  struct InterpreterSSAStack {
+    constexpr static size_t SIZE = 512 * 1024;
+    std::unique_ptr<uint8_t[]> Data{new uint8_t[SIZE]};
+    size_t Offset{};
+  };
+
   enum FallbackABI {
     FABI_UNKNOWN,
     FABI_VOID_U16,
@@ -34,6 +52,7 @@ namespace FEXCore::CPU {
     FABI_I64_F80_F80,
     FABI_F80_F80,
     FABI_F80_F80_F80,
+    FABI_VOID_FRAME_U64_U64_U64_U64,
   };
 
   struct FallbackInfo {
@@ -45,7 +64,8 @@ namespace FEXCore::CPU {
   class InterpreterOps {
 
     public:
-      static void InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, FEXCore::Core::DebugData *DebugData);
+      static InterpretedBlock *TranslateIR(FEXCore::IR::IRListView *CurrentIR);
+      static void InterpretIR(FEXCore::Core::InternalThreadState *Thread, uint64_t Entry, FEXCore::IR::IRListView *CurrentIR, InterpretedBlock *Block, InterpreterSSAStack *SSAStack);
       static void FillFallbackIndexPointers(uint64_t *Info);
       static bool GetFallbackHandler(IR::IROp_Header *IROp, FallbackInfo *Info);
 
@@ -60,7 +80,11 @@ namespace FEXCore::CPU {
           bool Redo;
         } BlockResults{};
 
-        IR::NodeIterator BlockIterator{0, 0};
+        // Which of the branch's targets to continue at when Redo is set, the true block is the first
+        uint32_t BranchTarget{};
+
+        // The entry can't be removed while its code is still running, done once the block exits
+        bool RemoveCodeEntry{};
       };
 
 #define DEF_OP(x) static void Op_##x(IR::IROp_Header *IROp, IROpData *Data, IR::NodeID Node)
@@ -140,8 +164,7 @@ namespace FEXCore::CPU {
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
   DEF_OP(ExitFunction);
@@ -185,6 +208,8 @@ namespace FEXCore::CPU {
   DEF_OP(VStoreMemElement);
   DEF_OP(CacheLineClear);
   DEF_OP(CacheLineZero);
+  DEF_OP(MemSet);
+  DEF_OP(MemCpy);
 
   ///< Misc ops
   DEF_OP(EndBlock);
@@ -400,4 +425,26 @@ namespace FEXCore::CPU {
   }
 
   };
+
+  using OpHandler = void (*)(IR::IROp_Header *IROp, InterpreterOps::IROpData *Data, IR::NodeID Node);
+
+  /**
+   * @brief A block's IR flattened in to an array of handlers for direct-threaded execution
+   *
+   * The code blocks are laid out back to back, falling out of one continues in the next.
+   * Ops without an implementation in the interpreter are left out.
+   */
+  struct InterpretedBlock {
+    struct Instruction {
+      OpHandler Handler;
+      IR::IROp_Header *IROp;
+      IR::NodeID ID;
+      // Branches only, the instruction indices of the code blocks they continue at
+      uint32_t Targets[2];
+    };
+
+    // Ends with a null handler
+    std::vector<Instruction> Instructions;
+    uint32_t SSACount;
+  };
 } // namespace FEXCore::CPU
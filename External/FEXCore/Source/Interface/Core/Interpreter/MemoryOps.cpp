@@ -7,6 +7,7 @@ $end_info$
 #include "Interface/Core/Interpreter/InterpreterClass.h"
 #include "Interface/Core/Interpreter/InterpreterOps.h"
 #include "Interface/Core/Interpreter/InterpreterDefines.h"
+#include "Interface/Core/Interpreter/StringOps.h"
 
 #include <cstdint>
 
@@ -281,5 +282,41 @@ DEF_OP(CacheLineZero) {
   }
 }
 
+DEF_OP(MemSet) {
+  auto Op = IROp->C<IR::IROp_MemSet>();
+
+  uint64_t Addr = *GetSrc<uint64_t*>(Data->SSAData, Op->Addr);
+  uint64_t Value = *GetSrc<uint64_t*>(Data->SSAData, Op->Value);
+  uint64_t Length = *GetSrc<uint64_t*>(Data->SSAData, Op->Length);
+  uint64_t Flags = *GetSrc<uint64_t*>(Data->SSAData, Op->Flags);
+  auto Frame = Data->State->CurrentFrame;
+
+  switch (Op->ElementSize) {
+    case 1: OpHandlers<IR::OP_MEMSET>::handle<uint8_t>(Frame, Addr, Value, Length, Flags); break;
+    case 2: OpHandlers<IR::OP_MEMSET>::handle<uint16_t>(Frame, Addr, Value, Length, Flags); break;
+    case 4: OpHandlers<IR::OP_MEMSET>::handle<uint32_t>(Frame, Addr, Value, Length, Flags); break;
+    case 8: OpHandlers<IR::OP_MEMSET>::handle<uint64_t>(Frame, Addr, Value, Length, Flags); break;
+    default: LOGMAN_MSG_A_FMT("Unhandled MemSet size: {}", Op->ElementSize); break;
+  }
+}
+
+DEF_OP(MemCpy) {
+  auto Op = IROp->C<IR::IROp_MemCpy>();
+
+  uint64_t Dest = *GetSrc<uint64_t*>(Data->SSAData, Op->Dest);
+  uint64_t Src = *GetSrc<uint64_t*>(Data->SSAData, Op->Src);
+  uint64_t Length = *GetSrc<uint64_t*>(Data->SSAData, Op->Length);
+  uint64_t Flags = *GetSrc<uint64_t*>(Data->SSAData, Op->Flags);
+  auto Frame = Data->State->CurrentFrame;
+
+  switch (Op->ElementSize) {
+    case 1: OpHandlers<IR::OP_MEMCPY>::handle<uint8_t>(Frame, Dest, Src, Length, Flags); break;
+    case 2: OpHandlers<IR::OP_MEMCPY>::handle<uint16_t>(Frame, Dest, Src, Length, Flags); break;
+    case 4: OpHandlers<IR::OP_MEMCPY>::handle<uint32_t>(Frame, Dest, Src, Length, Flags); break;
+    case 8: OpHandlers<IR::OP_MEMCPY>::handle<uint64_t>(Frame, Dest, Src, Length, Flags); break;
+    default: LOGMAN_MSG_A_FMT("Unhandled MemCpy size: {}", Op->ElementSize); break;
+  }
+}
+
 #undef DEF_OP
 } // namespace FEXCore::CPU
@@ -0,0 +1,132 @@
+#pragma once
+#include "Interface/Core/SMCPageTracker.h"
+
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/X86Enums.h>
+#include <FEXCore/IR/IR.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace FEXCore::CPU {
+template<IR::IROps Op>
+struct OpHandlers;
+
+// Bulk versions of REP STOS and REP MOVS
+// Both the interpreter and the JITs call these, the host libc provides the vectorized copies
+//
+// The copy is split in to chunks that don't leave a page of the source or the destination, RCX, RSI and RDI
+// in the frame are committed after each chunk. A chunk's first access to a page either faults before anything
+// in the chunk was written or the whole chunk goes through, so a fault leaves the registers at the faulting element
+// like the element at a time loop would.
+namespace StringOps {
+  constexpr uint64_t PAGE_MASK = 4096 - 1;
+
+  // Elements from Addr onwards in the direction of the copy that don't leave Addr's page, at least one
+  template<typename T>
+  static uint64_t ElementsInPage(uint64_t Addr, bool Down) {
+    const uint64_t PageOffset = Addr & PAGE_MASK;
+    const uint64_t Elements = Down ? PageOffset / sizeof(T) + 1 : (PAGE_MASK + 1 - PageOffset) / sizeof(T);
+    return std::max<uint64_t>(Elements, 1);
+  }
+
+  static uint64_t AddressMask(uint64_t Flags) {
+    return (Flags & IR::MEMOP_ADDRESS_32BIT) ? 0xFFFF'FFFFULL : ~0ULL;
+  }
+
+  // Lowest address of Count elements ending at Addr in the direction of the copy
+  template<typename T>
+  static uint64_t ChunkStart(uint64_t Addr, uint64_t Count, bool Down) {
+    return Down ? Addr - (Count - 1) * sizeof(T) : Addr;
+  }
+
+  // The copy can have written to a tracked code page, the rest of the block must not exit in to its old blocks
+  static void InvalidateWrittenCode(FEXCore::Core::CpuStateFrame *Frame) {
+    if (Frame->PendingCodeInvalidation) {
+      SMCPageTracker::InvalidateHostWrites(Frame->Thread);
+    }
+  }
+}
+
+template<>
+struct OpHandlers<IR::OP_MEMSET> {
+  template<typename T>
+  static void handle(FEXCore::Core::CpuStateFrame *Frame, uint64_t Dest, uint64_t Value, uint64_t Length, uint64_t Flags) {
+    const bool Down = Flags & IR::MEMOP_DIRECTION_DOWN;
+    const uint64_t Mask = StringOps::AddressMask(Flags);
+    const int64_t Step = Down ? -static_cast<int64_t>(sizeof(T)) : static_cast<int64_t>(sizeof(T));
+    const T Element = static_cast<T>(Value);
+
+    while (Length) {
+      const uint64_t Count = std::min(Length, StringOps::ElementsInPage<T>(Dest, Down));
+      auto Ptr = reinterpret_cast<uint8_t*>(StringOps::ChunkStart<T>(Dest, Count, Down));
+
+      if constexpr (sizeof(T) == 1) {
+        memset(Ptr, Element, Count);
+      }
+      else {
+        for (uint64_t i = 0; i < Count; ++i) {
+          memcpy(Ptr + i * sizeof(T), &Element, sizeof(T));
+        }
+      }
+
+      Length -= Count;
+      Dest = (Dest + Step * Count) & Mask;
+      Frame->State.gregs[X86State::REG_RDI] = (Frame->State.gregs[X86State::REG_RDI] + Step * Count) & Mask;
+      Frame->State.gregs[X86State::REG_RCX] = Length;
+    }
+
+    StringOps::InvalidateWrittenCode(Frame);
+  }
+};
+
+template<>
+struct OpHandlers<IR::OP_MEMCPY> {
+  template<typename T>
+  static void handle(FEXCore::Core::CpuStateFrame *Frame, uint64_t Dest, uint64_t Src, uint64_t Length, uint64_t Flags) {
+    const bool Down = Flags & IR::MEMOP_DIRECTION_DOWN;
+    const uint64_t Mask = StringOps::AddressMask(Flags);
+    const int64_t Step = Down ? -static_cast<int64_t>(sizeof(T)) : static_cast<int64_t>(sizeof(T));
+
+    while (Length) {
+      const uint64_t Count = std::min({Length, StringOps::ElementsInPage<T>(Dest, Down), StringOps::ElementsInPage<T>(Src, Down)});
+      const uint64_t Size = Count * sizeof(T);
+      const uint64_t DestStart = StringOps::ChunkStart<T>(Dest, Count, Down);
+      const uint64_t SrcStart = StringOps::ChunkStart<T>(Src, Count, Down);
+
+      // Without an overlap, or when the destination trails the source in the direction of the copy,
+      // every element is read before it gets overwritten and a memmove gives the same result
+      const bool Overlaps = DestStart < (SrcStart + Size) && SrcStart < (DestStart + Size);
+      const bool Trails = Down ? DestStart >= SrcStart : DestStart <= SrcStart;
+
+      if (!Overlaps || Trails) {
+        memmove(reinterpret_cast<void*>(DestStart), reinterpret_cast<void*>(SrcStart), Size);
+      }
+      else {
+        // The destination runs ahead in to source elements that haven't been read yet
+        // x86 copies one element at a time, which repeats the start of the source
+        uint64_t ElementDest = Dest;
+        uint64_t ElementSrc = Src;
+        for (uint64_t i = 0; i < Count; ++i) {
+          T Element;
+          memcpy(&Element, reinterpret_cast<void*>(ElementSrc), sizeof(T));
+          memcpy(reinterpret_cast<void*>(ElementDest), &Element, sizeof(T));
+          ElementSrc += Step;
+          ElementDest += Step;
+        }
+      }
+
+      Length -= Count;
+      Dest = (Dest + Step * Count) & Mask;
+      Src = (Src + Step * Count) & Mask;
+      Frame->State.gregs[X86State::REG_RSI] = (Frame->State.gregs[X86State::REG_RSI] + Step * Count) & Mask;
+      Frame->State.gregs[X86State::REG_RDI] = (Frame->State.gregs[X86State::REG_RDI] + Step * Count) & Mask;
+      Frame->State.gregs[X86State::REG_RCX] = Length;
+    }
+
+    StringOps::InvalidateWrittenCode(Frame);
+  }
+};
+
+}
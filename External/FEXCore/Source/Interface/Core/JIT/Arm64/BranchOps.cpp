@@ -19,12 +19,27 @@ namespace FEXCore::CPU {
 using namespace vixl;
 using namespace vixl::aarch64;
 #define DEF_OP(x) void Arm64JITCore::Op_##x(IR::IROp_Header *IROp, IR::NodeID Node)
-DEF_OP(GuestCallDirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestCallIndirect) {
-  LogMan::Msg::DFmt("Unimplemented");
+DEF_OP(GuestCall) {
+  auto Op = IROp->C<IR::IROp_GuestCall>();
+  auto ReturnRIP = GetReg<RA_64>(Op->ReturnRIP.ID());
+
+  // Grab the host code from L1, zero if it isn't there
+  ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, Pointers.AArch64.L1Pointer)));
+  and_(x3, ReturnRIP, LookupCache::L1_ENTRIES_MASK);
+  add(x0, x0, Operand(x3, Shift::LSL, 4));
+  ldp(x1, x0, MemOperand(x0));
+  cmp(x0, ReturnRIP);
+  csel(x1, x1, xzr, Condition::eq);
+
+  // Push it
+  ldr(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)));
+  add(x2, x2, 1);
+  and_(x2, x2, FEXCore::Core::RETURN_STACK_ENTRIES_MASK);
+  str(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)));
+
+  add(x0, STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStack));
+  add(x0, x0, Operand(x2, Shift::LSL, 4));
+  stp(ReturnRIP, x1, MemOperand(x0));
 }
 
 DEF_OP(SignalReturn) {
@@ -72,18 +87,44 @@ DEF_OP(ExitFunction) {
   aarch64::Register RipReg;
   uint64_t NewRIP;
 
-  if (IsInlineConstant(Op->NewRIP, &NewRIP) || IsInlineEntrypointOffset(Op->NewRIP, &NewRIP)) {
+  bool IsEntrypointOffset = false;
+  if (IsInlineConstant(Op->NewRIP, &NewRIP) || (IsEntrypointOffset = IsInlineEntrypointOffset(Op->NewRIP, &NewRIP))) {
     Literal l_BranchHost{ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress};
     Literal l_BranchGuest{NewRIP};
 
     ldr(x0, &l_BranchHost);
     blr(x0);
 
+    // Literals are placed directly after the blr, ExitFunctionLink relies on this layout
+    InsertNamedSymbolLiteralRelocation(NamedSymbol::SYMBOL_EXIT_FUNCTION_LINKER);
     place(&l_BranchHost);
+    if (IsEntrypointOffset) {
+      InsertGuestRIPLiteralRelocation(NewRIP);
+    }
     place(&l_BranchGuest);
   } else {
     RipReg = GetReg<RA_64>(Op->Header.Args[0].ID());
 
+    if (Op->IsReturn) {
+      Label ReturnStackMiss;
+
+      // Pop the top entry, it is consumed whether it matches or not
+      ldr(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)));
+      add(x0, STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStack));
+      add(x0, x0, Operand(x2, Shift::LSL, 4));
+      sub(x2, x2, 1);
+      and_(x2, x2, FEXCore::Core::RETURN_STACK_ENTRIES_MASK);
+      str(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)));
+
+      ldp(x0, x1, MemOperand(x0));
+      cmp(x0, RipReg);
+      b(&ReturnStackMiss, Condition::ne);
+      cbz(x1, &ReturnStackMiss);
+      br(x1);
+
+      bind(&ReturnStackMiss);
+    }
+
     // L1 Cache
     ldr(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, Pointers.AArch64.L1Pointer)));
 
@@ -387,6 +428,8 @@ DEF_OP(Thunk) {
 
   auto thunkFn = ThreadState->CTX->ThunkHandler->LookupThunk(Op->ThunkNameHash);
   LoadConstant(x2, (uintptr_t)thunkFn);
+  // Thunk pointers are process specific
+  Relocatable = false;
   blr(x2);
 
   PopDynamicRegsAndLR();
@@ -401,7 +444,7 @@ DEF_OP(ValidateCode) {
   int idx = 0;
 
   LoadConstant(GetReg<RA_64>(Node), 0);
-  LoadConstant(x0, Entry + Op->Offset);
+  MoveGuestRIP(x0, Entry + Op->Offset);
   LoadConstant(x1, 1);
 
   while (len >= 8)
@@ -450,7 +493,7 @@ DEF_OP(RemoveCodeEntry) {
   PushDynamicRegsAndLR();
 
   mov(x0, STATE);
-  LoadConstant(x1, Entry);
+  MoveGuestRIP(x1, Entry);
 
   ldr(x2, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, Pointers.AArch64.RemoveCodeEntryFromJIT)));
   SpillStaticRegs();
@@ -489,8 +532,7 @@ DEF_OP(CPUID) {
 #undef DEF_OP
 void Arm64JITCore::RegisterBranchHandlers() {
 #define REGISTER_OP(op, x) OpHandlers[FEXCore::IR::IROps::OP_##op] = &Arm64JITCore::Op_##x
-  REGISTER_OP(GUESTCALLDIRECT,   GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT, GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,         GuestCall);
   REGISTER_OP(SIGNALRETURN,      SignalReturn);
   REGISTER_OP(CALLBACKRETURN,    CallbackReturn);
   REGISTER_OP(EXITFUNCTION,      ExitFunction);
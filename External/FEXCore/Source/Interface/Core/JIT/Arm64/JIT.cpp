@@ -11,7 +11,9 @@ $end_info$
 */
 
 #include "Interface/Context/Context.h"
+#include "Interface/Core/CodeInvalidationService.h"
 #include "Interface/Core/LookupCache.h"
+#include "Interface/Core/SharedCodeCache.h"
 
 #include "Interface/Core/ArchHelpers/Arm64.h"
 #include "Interface/Core/ArchHelpers/MContext.h"
@@ -322,6 +324,26 @@ void Arm64JITCore::Op_Unhandled(IR::IROp_Header *IROp, IR::NodeID Node) {
       }
       break;
 
+      case FABI_VOID_FRAME_U64_U64_U64_U64:{
+        // The handler updates guest registers in the frame, they need to be there and get picked up again after
+        SpillStaticRegs();
+
+        PushDynamicRegsAndLR();
+
+        mov(x0, STATE);
+        mov(x1, GetReg<RA_64>(IROp->Args[0].ID()));
+        mov(x2, GetReg<RA_64>(IROp->Args[1].ID()));
+        mov(x3, GetReg<RA_64>(IROp->Args[2].ID()));
+        mov(x4, GetReg<RA_64>(IROp->Args[3].ID()));
+        ldr(x5, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, Pointers.AArch64.FallbackHandlerPointers[Info.HandlerIndex])));
+        blr(x5);
+
+        PopDynamicRegsAndLR();
+
+        FillStaticRegs();
+      }
+      break;
+
       case FABI_UNKNOWN:
       default:
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
@@ -499,7 +521,7 @@ void Arm64JITCore::EmitDetectionString() {
 void Arm64JITCore::ClearCache() {
   // Get the backing code buffer
   auto Buffer = GetBuffer();
-  if (*ThreadSharedData.SignalHandlerRefCounterPtr == 0) {
+  if (!SharedCode && *ThreadSharedData.SignalHandlerRefCounterPtr == 0) {
     if (!CodeBuffers.empty()) {
       // If we have more than one code buffer we are tracking then walk them and delete
       // This is a cleanup step
@@ -528,6 +550,22 @@ void Arm64JITCore::ClearCache() {
       *Buffer = vixl::CodeBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
     }
   }
+  else if (SharedCode) {
+    // Only the SharedCodeCache's and the TierUpService's compile threads generate shared code
+    // Every guest thread can be executing this code, it gets freed once all of them have left it
+    const uint64_t Epoch = CTX->CodeInvalidation->RetireSharedCode();
+    RetiredCodeBuffers.emplace_back(RetiredCodeBuffer{InitialCodeBuffer, Epoch});
+    for (auto CodeBuffer : CodeBuffers) {
+      RetiredCodeBuffers.emplace_back(RetiredCodeBuffer{CodeBuffer, Epoch});
+    }
+    CodeBuffers.clear();
+
+    FreeRetiredCodeBuffers();
+
+    InitialCodeBuffer = AllocateNewCodeBuffer(InitialCodeBuffer.Size);
+    *Buffer = vixl::CodeBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
+    CurrentCodeBuffer = &InitialCodeBuffer;
+  }
   else {
     // We have signal handlers that have generated code
     // This means that we can not safely clear the code at this point in time
@@ -539,12 +577,31 @@ void Arm64JITCore::ClearCache() {
   EmitDetectionString();
 }
 
+void Arm64JITCore::FreeRetiredCodeBuffers() {
+  std::erase_if(RetiredCodeBuffers, [this](RetiredCodeBuffer const &Retired) {
+    if (!CTX->CodeInvalidation->IsEpochQuiescent(Retired.Epoch)) {
+      return false;
+    }
+
+    if (CTX->SharedCode) {
+      CTX->SharedCode->EraseLinksInRange(reinterpret_cast<uintptr_t>(Retired.Buffer.Ptr), Retired.Buffer.Size);
+    }
+    FreeCodeBuffer(Retired.Buffer);
+    return true;
+  });
+}
+
 Arm64JITCore::~Arm64JITCore() {
   for (auto CodeBuffer : CodeBuffers) {
     FreeCodeBuffer(CodeBuffer);
   }
   CodeBuffers.clear();
 
+  for (auto &Retired : RetiredCodeBuffers) {
+    FreeCodeBuffer(Retired.Buffer);
+  }
+  RetiredCodeBuffers.clear();
+
   FreeCodeBuffer(InitialCodeBuffer);
 }
 
@@ -696,6 +753,11 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
     ThreadState->CTX->ClearCodeCache(ThreadState, false);
   }
 
+  if (!RetiredCodeBuffers.empty()) {
+    // Reclaim retired code once the guest threads passed their safe points instead of holding it until the next retirement
+    FreeRetiredCodeBuffers();
+  }
+
   // AAPCS64
   // r30      = LR
   // r29      = FP
@@ -718,6 +780,30 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
 
   auto GuestEntry = GetCursorAddress<uint64_t>();
 
+  CodeBegin = GuestEntry;
+  Relocations.clear();
+  Relocatable = true;
+
+  if (TierUp) {
+    // Baseline tier, every entry goes through a pointer that the TierUpService replaces with the optimized block
+    // The pointer needs to be naturally aligned so it can be updated atomically
+    if (GetCursorAddress<uint64_t>() & 7) {
+      nop();
+    }
+    ldr(x0, 2);
+    br(x0);
+    TierUp->EntryTarget = GetCursorAddress<uint64_t*>();
+    dc64(GetCursorAddress<uint64_t>() + sizeof(uint64_t));
+
+    LoadConstant(x0, reinterpret_cast<uint64_t>(&TierUp->ExecutionCount));
+    ldr(x1, MemOperand(x0));
+    add(x1, x1, 1);
+    str(x1, MemOperand(x0));
+
+    // Counter pointers are process specific
+    Relocatable = false;
+  }
+
  if (CTX->GetGdbServerStatus()) {
     aarch64::Label RunBlock;
 
@@ -733,7 +819,7 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
     cbz(w0, &RunBlock);
     {
       // Make sure RIP is syncronized to the context
-      LoadConstant(x0, Entry);
+      MoveGuestRIP(x0, Entry);
       str(x0, MemOperand(STATE, offsetof(FEXCore::Core::CpuStateFrame, State.rip)));
 
       // Stop the thread
@@ -807,6 +893,8 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
 
   if (DebugData) {
     DebugData->HostCodeSize = reinterpret_cast<uintptr_t>(CodeEnd) - reinterpret_cast<uintptr_t>(GuestEntry);
+    DebugData->Relocatable = Relocatable;
+    DebugData->Relocations = std::move(Relocations);
   }
 
   this->IR = nullptr;
@@ -814,6 +902,114 @@ void *Arm64JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IR
   return reinterpret_cast<void*>(GuestEntry);
 }
 
+void Arm64JITCore::MoveGuestRIP(aarch64::Register Reg, uint64_t GuestRIP) {
+  if (!CTX->Config.AOTCodeCapture()) {
+    LoadConstant(Reg, GuestRIP);
+    return;
+  }
+
+  // Always four instructions so the relocation can rewrite it in place
+  Relocations.push_back({
+    .Type = RelocationTypes::RELOC_GUEST_RIP_MOVE,
+    .Data = Reg.GetCode(),
+    .HostOffset = GetCursorAddress<uint64_t>() - CodeBegin,
+    .GuestEntryOffset = static_cast<int64_t>(GuestRIP - Entry),
+  });
+
+  movz(Reg.X(), GuestRIP & 0xFFFF, 0);
+  movk(Reg.X(), (GuestRIP >> 16) & 0xFFFF, 16);
+  movk(Reg.X(), (GuestRIP >> 32) & 0xFFFF, 32);
+  movk(Reg.X(), (GuestRIP >> 48) & 0xFFFF, 48);
+}
+
+void Arm64JITCore::InsertNamedSymbolLiteralRelocation(FEXCore::CPU::NamedSymbol Symbol) {
+  Relocations.push_back({
+    .Type = RelocationTypes::RELOC_NAMED_SYMBOL_LITERAL,
+    .Data = static_cast<uint32_t>(Symbol),
+    .HostOffset = GetCursorAddress<uint64_t>() - CodeBegin,
+    .GuestEntryOffset = 0,
+  });
+}
+
+void Arm64JITCore::InsertGuestRIPLiteralRelocation(uint64_t GuestRIP) {
+  Relocations.push_back({
+    .Type = RelocationTypes::RELOC_GUEST_RIP_LITERAL,
+    .Data = 0,
+    .HostOffset = GetCursorAddress<uint64_t>() - CodeBegin,
+    .GuestEntryOffset = static_cast<int64_t>(GuestRIP - Entry),
+  });
+}
+
+void *Arm64JITCore::RelocateJITObjectCode(uint64_t GuestEntry, RelocatableCode const &Code) {
+  if ((GetCursorOffset() + Code.HostCodeSize) > CurrentCodeBuffer->Size) {
+    ThreadState->CTX->ClearCodeCache(ThreadState, false);
+  }
+
+  auto HostCode = GetCursorAddress<uint8_t*>();
+  GetBuffer()->EmitData(Code.HostCode, Code.HostCodeSize);
+
+  const uint64_t GuestMask = CTX->Config.Is64BitMode ? ~0ULL : 0xFFFF'FFFFULL;
+
+  for (size_t i = 0; i < Code.RelocationCount; ++i) {
+    const auto &Reloc = Code.Relocations[i];
+    auto RelocAddress = HostCode + Reloc.HostOffset;
+    const uint64_t GuestRIP = (GuestEntry + Reloc.GuestEntryOffset) & GuestMask;
+
+    switch (Reloc.Type) {
+      case RelocationTypes::RELOC_NAMED_SYMBOL_LITERAL: {
+        uint64_t Pointer{};
+        switch (static_cast<NamedSymbol>(Reloc.Data)) {
+          case NamedSymbol::SYMBOL_EXIT_FUNCTION_LINKER:
+            Pointer = ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress;
+            break;
+          default:
+            LogMan::Msg::EFmt("Unknown named symbol in code cache: {}", Reloc.Data);
+            return nullptr;
+        }
+        memcpy(RelocAddress, &Pointer, sizeof(Pointer));
+        break;
+      }
+      case RelocationTypes::RELOC_GUEST_RIP_LITERAL:
+        memcpy(RelocAddress, &GuestRIP, sizeof(GuestRIP));
+        break;
+      case RelocationTypes::RELOC_GUEST_RIP_MOVE: {
+        vixl::aarch64::Assembler emit(RelocAddress, 16);
+        vixl::CodeBufferCheckScope scope(&emit, 16, vixl::CodeBufferCheckScope::kDontReserveBufferSpace, vixl::CodeBufferCheckScope::kNoAssert);
+        auto Reg = aarch64::Register::GetXRegFromCode(Reloc.Data);
+        emit.movz(Reg, GuestRIP & 0xFFFF, 0);
+        emit.movk(Reg, (GuestRIP >> 16) & 0xFFFF, 16);
+        emit.movk(Reg, (GuestRIP >> 32) & 0xFFFF, 32);
+        emit.movk(Reg, (GuestRIP >> 48) & 0xFFFF, 48);
+        emit.FinalizeCode();
+        break;
+      }
+      default:
+        LogMan::Msg::EFmt("Unknown relocation type in code cache: {}", static_cast<uint32_t>(Reloc.Type));
+        return nullptr;
+    }
+  }
+
+  CPU.EnsureIAndDCacheCoherency(HostCode, Code.HostCodeSize);
+
+  return HostCode;
+}
+
+static void DelinkBranch(uintptr_t HostLink, uintptr_t LinkerAddress) {
+  uintptr_t branch = HostLink - 8;
+  vixl::aarch64::Assembler emit((uint8_t*)(branch), 24);
+  vixl::CodeBufferCheckScope scope(&emit, 24, vixl::CodeBufferCheckScope::kDontReserveBufferSpace, vixl::CodeBufferCheckScope::kNoAssert);
+  Literal l_BranchHost{LinkerAddress};
+  emit.ldr(x0, &l_BranchHost);
+  emit.blr(x0);
+  emit.place(&l_BranchHost);
+  emit.FinalizeCode();
+  vixl::aarch64::CPU::EnsureIAndDCacheCoherency((void*)branch, 24);
+}
+
+static void DelinkRecord(uintptr_t HostLink, uintptr_t LinkerAddress) {
+  reinterpret_cast<uint64_t*>(HostLink)[0] = LinkerAddress;
+}
+
 uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *record) {
   auto Thread = Frame->Thread;
   auto GuestRip = record[1];
@@ -823,7 +1019,12 @@ uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuSt
   if (!HostCode) {
     //fmt::print("ExitFunctionLink: Aborting, {:X} not in cache\n", GuestRip);
     Frame->State.rip = GuestRip;
-    return core->ThreadSharedData.Dispatcher->AbsoluteLoopTopAddress;
+    // Return to the dispatcher of the thread that is executing, the code may be shared between threads
+    return Frame->Pointers.AArch64.DispatcherLoopTop;
+  }
+
+  if (!Thread->LookupCache->CanLinkBlock((uintptr_t)record, HostCode)) {
+    return HostCode;
   }
 
   uintptr_t branch = (uintptr_t)(record) - 8;
@@ -840,24 +1041,13 @@ uint64_t Arm64JITCore::ExitFunctionLink(Arm64JITCore *core, FEXCore::Core::CpuSt
     vixl::aarch64::CPU::EnsureIAndDCacheCoherency((void*)branch, 24);
 
     // Add de-linking handler
-    Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [branch, LinkerAddress]{
-      vixl::aarch64::Assembler emit((uint8_t*)(branch), 24);
-      vixl::CodeBufferCheckScope scope(&emit, 24, vixl::CodeBufferCheckScope::kDontReserveBufferSpace, vixl::CodeBufferCheckScope::kNoAssert);
-      Literal l_BranchHost{LinkerAddress};
-      emit.ldr(x0, &l_BranchHost);
-      emit.blr(x0);
-      emit.place(&l_BranchHost);
-      emit.FinalizeCode();
-      vixl::aarch64::CPU::EnsureIAndDCacheCoherency((void*)branch, 24);
-    });
+    Thread->LookupCache->AddBlockLink(GuestRip, {(uintptr_t)record, LinkerAddress, &DelinkBranch});
   } else {
     // fallback case - do a soft-er link by patching the pointer
     record[0] = HostCode;
 
     // Add de-linking handler
-    Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [record, LinkerAddress]{
-      record[0] = LinkerAddress;
-    });
+    Thread->LookupCache->AddBlockLink(GuestRip, {(uintptr_t)record, LinkerAddress, &DelinkRecord});
   }
 
   return HostCode;
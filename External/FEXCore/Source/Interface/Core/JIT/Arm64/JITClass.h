@@ -64,10 +64,16 @@ public:
   [[nodiscard]] CodeBuffer AllocateNewCodeBuffer(size_t Size);
 
   void CopyNecessaryDataForCompileThread(CPUBackend *Original) override;
+  bool IsInSignalHandler() const override {
+    // Compile threads never run guest code
+    return ThreadSharedData.SignalHandlerRefCounterPtr && *ThreadSharedData.SignalHandlerRefCounterPtr != 0;
+  }
   bool IsAddressInJITCode(uint64_t Address, bool IncludeDispatcher = true, bool IncludeCompileService = true) const override {
     return Dispatcher->IsAddressInJITCode(Address, IncludeDispatcher, IncludeCompileService);
   }
 
+  [[nodiscard]] void *RelocateJITObjectCode(uint64_t Entry, RelocatableCode const &Code) override;
+
   static void InitializeSignalHandlers(FEXCore::Context::Context *CTX);
 
 private:
@@ -82,6 +88,23 @@ private:
 
   std::map<IR::NodeID, aarch64::Label> JumpTargets;
 
+  /**
+   * @name Relocations
+   * @{ */
+  // Host address of the block currently being compiled, relocations are stored relative to this
+  uint64_t CodeBegin{};
+  std::vector<FEXCore::CPU::Relocation> Relocations;
+  // Cleared when the block embeds something that can't be relocated (Thunk pointers)
+  bool Relocatable{};
+
+  /**
+   * @brief Moves a guest RIP in to a register with a fixed size sequence so it can be relocated
+   */
+  void MoveGuestRIP(aarch64::Register Reg, uint64_t GuestRIP);
+  void InsertNamedSymbolLiteralRelocation(FEXCore::CPU::NamedSymbol Symbol);
+  void InsertGuestRIPLiteralRelocation(uint64_t GuestRIP);
+  /**  @} */
+
   /**
    * @name Register Allocation
    * @{ */
@@ -165,6 +188,16 @@ private:
   // This is the current code buffer that we are tracking
   CodeBuffer *CurrentCodeBuffer{};
 
+  // Shared code buffers that other threads might still be executing
+  // Freed once the CodeInvalidationService says that every thread has left the epoch
+  struct RetiredCodeBuffer {
+    CodeBuffer Buffer;
+    uint64_t Epoch;
+  };
+  std::vector<RetiredCodeBuffer> RetiredCodeBuffers{};
+
+  void FreeRetiredCodeBuffers();
+
   // We don't want to mvoe above 128MB atm because that means we will have to encode longer jumps
   static constexpr size_t MAX_CODE_SIZE = 1024 * 1024 * 128;
   static constexpr size_t MAX_DISPATCHER_CODE_SIZE = 4096 * 2;
@@ -280,8 +313,7 @@ private:
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
   DEF_OP(ExitFunction);
@@ -29,12 +29,29 @@ $end_info$
 
 namespace FEXCore::CPU {
 #define DEF_OP(x) void X86JITCore::Op_##x(IR::IROp_Header *IROp, IR::NodeID Node)
-DEF_OP(GuestCallDirect) {
-  LogMan::Msg::DFmt("Unimplemented");
-}
-
-DEF_OP(GuestCallIndirect) {
-  LogMan::Msg::DFmt("Unimplemented");
+DEF_OP(GuestCall) {
+  auto Op = IROp->C<IR::IROp_GuestCall>();
+  Xbyak::Reg ReturnRIP = GetSrc<RA_64>(Op->ReturnRIP.ID());
+
+  // Grab the host code from L1, zero if it isn't there
+  mov(rcx, qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, Pointers.X86.L1Pointer)]);
+  mov(rax, ReturnRIP);
+  and_(rax, LookupCache::L1_ENTRIES_MASK);
+  shl(rax, 4);
+
+  xor_(edx, edx);
+  cmp(qword[rcx + rax + 8], ReturnRIP);
+  cmove(rdx, qword[rcx + rax]);
+
+  // Push it
+  mov(rax, qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)]);
+  add(rax, 1);
+  and_(rax, FEXCore::Core::RETURN_STACK_ENTRIES_MASK);
+  mov(qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)], rax);
+
+  shl(rax, 4);
+  mov(qword [STATE + rax + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack) + offsetof(FEXCore::Core::ReturnStackEntry, GuestRIP)], ReturnRIP);
+  mov(qword [STATE + rax + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack) + offsetof(FEXCore::Core::ReturnStackEntry, HostCode)], rdx);
 }
 
 DEF_OP(SignalReturn) {
@@ -97,6 +114,26 @@ DEF_OP(ExitFunction) {
   } else {
     Xbyak::Reg RipReg = GetSrc<RA_64>(Op->NewRIP.ID());
 
+    if (Op->IsReturn) {
+      Label ReturnStackMiss;
+
+      // Pop the top entry, it is consumed whether it matches or not
+      mov(rax, qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)]);
+      lea(rcx, ptr[rax - 1]);
+      and_(rcx, FEXCore::Core::RETURN_STACK_ENTRIES_MASK);
+      mov(qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, ReturnStackTop)], rcx);
+
+      shl(rax, 4);
+      cmp(qword [STATE + rax + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack) + offsetof(FEXCore::Core::ReturnStackEntry, GuestRIP)], RipReg);
+      jne(ReturnStackMiss);
+      mov(rax, qword [STATE + rax + offsetof(FEXCore::Core::CpuStateFrame, ReturnStack) + offsetof(FEXCore::Core::ReturnStackEntry, HostCode)]);
+      test(rax, rax);
+      jz(ReturnStackMiss);
+      jmp(rax);
+
+      L(ReturnStackMiss);
+    }
+
     // L1 Cache
     mov(rcx, qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, Pointers.X86.L1Pointer)]);
 
@@ -204,6 +241,67 @@ DEF_OP(Syscall) {
   mov (GetDst<RA_64>(Node), rax);
 }
 
+DEF_OP(InlineSyscall) {
+  auto Op = IROp->C<IR::IROp_InlineSyscall>();
+  // Arguments are passed as follows:
+  // RAX: SyscallNumber & Return
+  // RDI: Arg0
+  // RSI: Arg1 - RA INTERSECT
+  // RDX: Arg2
+  // R10: Arg3 - RA INTERSECT
+  // R8:  Arg4 - RA INTERSECT
+  // R9:  Arg5 - RA INTERSECT
+  //
+  // The kernel additionally clobbers RCX and R11 - RA INTERSECT
+  // Guest state is never held in host registers on this backend, there is nothing to sync before entering
+
+  // One argument is removed from the SyscallArguments::MAX_ARGS since the first argument was syscall number
+  const static std::array<Xbyak::Reg, FEXCore::HLE::SyscallArguments::MAX_ARGS-1> RegArgs = {{
+    rdi, rsi, rdx, r10, r8, r9
+  }};
+
+  // Allocatable registers that are overwritten, any of them can still be live after the syscall
+  const static std::array<Xbyak::Reg, 5> ClobberedRegs = {{
+    rsi, r8, r9, r10, r11
+  }};
+
+  for (auto &Reg : ClobberedRegs)
+    push(Reg);
+
+  // Sources can live in each other's argument registers, go through the stack to shuffle them
+  uint32_t NumArgs{};
+  for (; NumArgs < FEXCore::HLE::SyscallArguments::MAX_ARGS-1; ++NumArgs) {
+    if (Op->Header.Args[NumArgs].IsInvalid()) break;
+    push(GetSrc<RA_64>(Op->Header.Args[NumArgs].ID()));
+  }
+
+  for (uint32_t i = NumArgs; i > 0; --i) {
+    pop(RegArgs[i - 1]);
+
+    if (!CTX->Config.Is64BitMode()) {
+      // Zero extend
+      mov(RegArgs[i - 1].cvt32(), RegArgs[i - 1].cvt32());
+    }
+  }
+
+  mov(rax, Op->HostSyscallNumber);
+  syscall();
+
+  for (uint32_t i = ClobberedRegs.size(); i > 0; --i)
+    pop(ClobberedRegs[i - 1]);
+
+  if ((Op->Flags & FEXCore::IR::SyscallFlags::NORETURN) != FEXCore::IR::SyscallFlags::NORETURN) {
+    // Result is now in rax
+    // Move result to its destination register
+    if (CTX->Config.Is64BitMode()) {
+      mov(GetDst<RA_64>(Node), rax);
+    }
+    else {
+      mov(GetDst<RA_32>(Node), eax);
+    }
+  }
+}
+
 DEF_OP(Thunk) {
   auto Op = IROp->C<IR::IROp_Thunk>();
 
@@ -320,14 +418,14 @@ DEF_OP(CPUID) {
 #undef DEF_OP
 void X86JITCore::RegisterBranchHandlers() {
 #define REGISTER_OP(op, x) OpHandlers[FEXCore::IR::IROps::OP_##op] = &X86JITCore::Op_##x
-  REGISTER_OP(GUESTCALLDIRECT,   GuestCallDirect);
-  REGISTER_OP(GUESTCALLINDIRECT, GuestCallIndirect);
+  REGISTER_OP(GUESTCALL,         GuestCall);
   REGISTER_OP(SIGNALRETURN,      SignalReturn);
   REGISTER_OP(CALLBACKRETURN,    CallbackReturn);
   REGISTER_OP(EXITFUNCTION,      ExitFunction);
   REGISTER_OP(JUMP,              Jump);
   REGISTER_OP(CONDJUMP,          CondJump);
   REGISTER_OP(SYSCALL,           Syscall);
+  REGISTER_OP(INLINESYSCALL,     InlineSyscall);
   REGISTER_OP(THUNK,             Thunk);
   REGISTER_OP(VALIDATECODE,      ValidateCode);
   REGISTER_OP(REMOVECODEENTRY,   RemoveCodeEntry);
@@ -6,7 +6,9 @@ $end_info$
 */
 
 #include "Interface/Context/Context.h"
+#include "Interface/Core/CodeInvalidationService.h"
 #include "Interface/Core/LookupCache.h"
+#include "Interface/Core/SharedCodeCache.h"
 
 #include "Interface/Core/Dispatcher/Dispatcher.h"
 #include "Interface/Core/Dispatcher/X86Dispatcher.h"
@@ -285,6 +287,23 @@ void X86JITCore::Op_Unhandled(IR::IROp_Header *IROp, IR::NodeID Node) {
       }
       break;
 
+      case FABI_VOID_FRAME_U64_U64_U64_U64:{
+        PushRegs();
+
+        // rsi and r8 are also allocatable registers, go through rax so neither gets overwritten before it is read
+        mov(rdx, GetSrc<RA_64>(IROp->Args[1].ID()));
+        mov(rcx, GetSrc<RA_64>(IROp->Args[2].ID()));
+        mov(rax, GetSrc<RA_64>(IROp->Args[3].ID()));
+        mov(rsi, GetSrc<RA_64>(IROp->Args[0].ID()));
+        mov(r8, rax);
+        mov(rdi, STATE);
+
+        call(qword [STATE + offsetof(FEXCore::Core::CpuStateFrame, Pointers.X86.FallbackHandlerPointers[Info.HandlerIndex])]);
+
+        PopRegs();
+      }
+      break;
+
       case FABI_UNKNOWN:
       default:
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
@@ -398,12 +417,31 @@ void X86JITCore::InitializeSignalHandlers(FEXCore::Context::Context *CTX) {
   }
 }
 
+void X86JITCore::FreeRetiredCodeBuffers() {
+  std::erase_if(RetiredCodeBuffers, [this](RetiredCodeBuffer const &Retired) {
+    if (!CTX->CodeInvalidation->IsEpochQuiescent(Retired.Epoch)) {
+      return false;
+    }
+
+    if (CTX->SharedCode) {
+      CTX->SharedCode->EraseLinksInRange(reinterpret_cast<uintptr_t>(Retired.Buffer.Ptr), Retired.Buffer.Size);
+    }
+    FreeCodeBuffer(Retired.Buffer);
+    return true;
+  });
+}
+
 X86JITCore::~X86JITCore() {
   for (auto CodeBuffer : CodeBuffers) {
     FreeCodeBuffer(CodeBuffer);
   }
   CodeBuffers.clear();
 
+  for (auto &Retired : RetiredCodeBuffers) {
+    FreeCodeBuffer(Retired.Buffer);
+  }
+  RetiredCodeBuffers.clear();
+
 
   FreeCodeBuffer(InitialCodeBuffer);
 }
@@ -416,7 +454,7 @@ void X86JITCore::EmitDetectionString() {
 }
 
 void X86JITCore::ClearCache() {
-  if (*ThreadSharedData.SignalHandlerRefCounterPtr == 0) {
+  if (!SharedCode && *ThreadSharedData.SignalHandlerRefCounterPtr == 0) {
     if (!CodeBuffers.empty()) {
       // If we have more than one code buffer we are tracking then walk them and delete
       // This is a cleanup step
@@ -445,6 +483,22 @@ void X86JITCore::ClearCache() {
       setNewBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
     }
   }
+  else if (SharedCode) {
+    // Only the SharedCodeCache's and the TierUpService's compile threads generate shared code
+    // Every guest thread can be executing this code, it gets freed once all of them have left it
+    const uint64_t Epoch = CTX->CodeInvalidation->RetireSharedCode();
+    RetiredCodeBuffers.emplace_back(RetiredCodeBuffer{InitialCodeBuffer, Epoch});
+    for (auto CodeBuffer : CodeBuffers) {
+      RetiredCodeBuffers.emplace_back(RetiredCodeBuffer{CodeBuffer, Epoch});
+    }
+    CodeBuffers.clear();
+
+    FreeRetiredCodeBuffers();
+
+    InitialCodeBuffer = AllocateNewCodeBuffer(CTX, InitialCodeBuffer.Size);
+    setNewBuffer(InitialCodeBuffer.Ptr, InitialCodeBuffer.Size);
+    CurrentCodeBuffer = &InitialCodeBuffer;
+  }
   else {
     // We have signal handlers that have generated code
     // This means that we can not safely clear the code at this point in time
@@ -635,9 +689,28 @@ void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRLi
     ThreadState->CTX->ClearCodeCache(ThreadState, false);
   }
 
+  if (!RetiredCodeBuffers.empty()) {
+    // Reclaim retired code once the guest threads passed their safe points instead of holding it until the next retirement
+    FreeRetiredCodeBuffers();
+  }
+
 	void *GuestEntry = getCurr<void*>();
   this->IR = IR;
 
+  if (TierUp) {
+    // Baseline tier, every entry goes through a pointer that the TierUpService replaces with the optimized block
+    // The pointer needs to be naturally aligned so it can be updated atomically
+    Label EntryTarget;
+    jmp(qword [rip + EntryTarget]);
+    align(8);
+    L(EntryTarget);
+    TierUp->EntryTarget = getCurr<uint64_t*>();
+    dq(getCurr<uint64_t>() + sizeof(uint64_t));
+
+    mov(rax, reinterpret_cast<uint64_t>(&TierUp->ExecutionCount));
+    inc(qword [rax]);
+  }
+
   if (CTX->GetGdbServerStatus()) {
     Label RunBlock;
 
@@ -792,6 +865,11 @@ void *X86JITCore::CompileCode(uint64_t Entry, [[maybe_unused]] FEXCore::IR::IRLi
   return GuestEntry;
 }
 
+static void DelinkRecord(uintptr_t HostLink, uintptr_t LinkerAddress) {
+  // undo the link
+  reinterpret_cast<uint64_t*>(HostLink)[0] = LinkerAddress;
+}
+
 uint64_t X86JITCore::ExitFunctionLink(X86JITCore *core, FEXCore::Core::CpuStateFrame *Frame, uint64_t *record) {
   auto Thread = Frame->Thread;
   auto GuestRip = record[1];
@@ -800,14 +878,16 @@ uint64_t X86JITCore::ExitFunctionLink(X86JITCore *core, FEXCore::Core::CpuStateF
 
   if (!HostCode) {
     Thread->CurrentFrame->State.rip = GuestRip;
-    return core->ThreadSharedData.Dispatcher->AbsoluteLoopTopAddress;
+    // Return to the dispatcher of the thread that is executing, the code may be shared between threads
+    return Frame->Pointers.X86.DispatcherLoopTop;
+  }
+
+  if (!Thread->LookupCache->CanLinkBlock((uintptr_t)record, HostCode)) {
+    return HostCode;
   }
 
   auto LinkerAddress = core->ThreadSharedData.Dispatcher->ExitFunctionLinkerAddress;
-  Thread->LookupCache->AddBlockLink(GuestRip, (uintptr_t)record, [record, LinkerAddress]{
-    // undo the link
-    record[0] = LinkerAddress;
-  });
+  Thread->LookupCache->AddBlockLink(GuestRip, {(uintptr_t)record, LinkerAddress, &DelinkRecord});
 
   record[0] = HostCode;
   return HostCode;
@@ -21,6 +21,7 @@ using namespace Xbyak;
 #include <FEXCore/Utils/MathUtils.h>
 #include "Interface/IR/Passes/RegisterAllocationPass.h"
 
+#include <algorithm>
 #include <tuple>
 
 namespace FEXCore::CPU {
@@ -79,7 +80,16 @@ public:
   static constexpr size_t MAX_CODE_SIZE = 1024 * 1024 * 256;
   void CopyNecessaryDataForCompileThread(CPUBackend *Original) override;
 
+  bool IsInSignalHandler() const override {
+    // Compile threads never run guest code
+    return ThreadSharedData.SignalHandlerRefCounterPtr && *ThreadSharedData.SignalHandlerRefCounterPtr != 0;
+  }
+
   bool IsAddressInJITCode(uint64_t Address, bool IncludeDispatcher = true, bool IncludeCompileService = true) const override {
+    if (!Dispatcher) {
+      // Compile threads don't have a dispatcher, only check the code buffers that we own
+      return IsAddressInCodeBuffer(Address);
+    }
     return Dispatcher->IsAddressInJITCode(Address, IncludeDispatcher, IncludeCompileService);
   }
 
@@ -152,6 +162,17 @@ private:
     CurrentCodeBuffer = &CodeBuffers.emplace_back(Buffer);
   }
 
+  bool IsAddressInCodeBuffer(uint64_t Address) const {
+    auto InBuffer = [Address](CodeBuffer const &Buffer) {
+      auto Start = reinterpret_cast<uint64_t>(Buffer.Ptr);
+      return Address >= Start && Address < (Start + Buffer.Size);
+    };
+    return InBuffer(InitialCodeBuffer) || std::any_of(CodeBuffers.begin(), CodeBuffers.end(), InBuffer) ||
+           std::any_of(RetiredCodeBuffers.begin(), RetiredCodeBuffers.end(), [&InBuffer](auto const &Retired) {
+             return InBuffer(Retired.Buffer);
+           });
+  }
+
   static uint64_t ExitFunctionLink(X86JITCore* code, FEXCore::Core::CpuStateFrame *Frame, uint64_t *record);
 
   // This is purely a debugging aid for developers to see if they are in JIT code space when inspecting raw memory
@@ -169,6 +190,16 @@ private:
   // This is the current code buffer that we are tracking
   CodeBuffer *CurrentCodeBuffer{};
 
+  // Shared code buffers that other threads might still be executing
+  // Freed once the CodeInvalidationService says that every thread has left the epoch
+  struct RetiredCodeBuffer {
+    CodeBuffer Buffer;
+    uint64_t Epoch;
+  };
+  std::vector<RetiredCodeBuffer> RetiredCodeBuffers{};
+
+  void FreeRetiredCodeBuffers();
+
   struct CompilerSharedData {
     uint64_t SignalHandlerReturnAddress{};
     uint64_t UnimplementedInstructionAddress{};
@@ -279,14 +310,14 @@ private:
   DEF_OP(AtomicFetchNeg);
 
   ///< Branch ops
-  DEF_OP(GuestCallDirect);
-  DEF_OP(GuestCallIndirect);
+  DEF_OP(GuestCall);
   DEF_OP(SignalReturn);
   DEF_OP(CallbackReturn);
   DEF_OP(ExitFunction);
   DEF_OP(Jump);
   DEF_OP(CondJump);
   DEF_OP(Syscall);
+  DEF_OP(InlineSyscall);
   DEF_OP(Thunk);
   DEF_OP(ValidateCode);
   DEF_OP(RemoveCodeEntry);
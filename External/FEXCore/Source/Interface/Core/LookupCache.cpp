@@ -11,14 +11,20 @@ $end_info$
 #include "Interface/Context/Context.h"
 #include "Interface/Core/LookupCache.h"
 
+#include <cstring>
+#include <iterator>
 #include <sys/mman.h>
 
 namespace FEXCore {
-LookupCache::LookupCache(FEXCore::Context::Context *CTX)
-  : ctx {CTX} {
+LookupCache::LookupCache(FEXCore::Context::Context *CTX, FEXCore::SharedCodeCache *Shared)
+  : ctx {CTX}
+  , Shared {Shared} {
 
   // Block cache ends up looking like this
-  // PageMemoryMap[VirtualMemoryRegion >> 12]
+  // PagePointer[(VirtualMemoryRegion >> 12) >> L2_TABLE_BITS]
+  //       |
+  //       v
+  // L2Table[(VirtualMemoryRegion >> 12) & L2_TABLE_MASK]
   //       |
   //       v
   // PageMemory[Memory & (VIRTUAL_PAGE_SIZE - 1)]
@@ -26,45 +32,115 @@ LookupCache::LookupCache(FEXCore::Context::Context *CTX)
   //       v
   // Pointer to Code
   //
-  // Allocate a region of memory that we can use to back our block pointers
-  // We need one pointer per page of virtual memory
-  // At 64GB of virtual memory this will allocate 128MB of virtual memory space
-  PagePointer = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, ctx->Config.VirtualMemSize / 4096 * 8, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-
-  // Allocate our memory backing our pages
-  // We need 32KB per guest page (One pointer per byte)
-  // XXX: We can drop down to 16KB if we store 4byte offsets from the code base
-  // We currently limit to 128MB of real memory for caching for the total cache size.
-  // Can end up being inefficient if we compile a small number of blocks per page
-  PageMemory = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
-  LOGMAN_THROW_A_FMT(PageMemory != -1ULL, "Failed to allocate page memory");
+  // Only the directory is allocated up front, one pointer per 2MB of virtual memory
+  // At 64GB of virtual memory this is 256KB of virtual memory space
+  // Tables and page backings are allocated the first time a block in their range gets cached
+  VirtualMemSize = ctx->Config.VirtualMemSize;
+  DirectorySize = ((VirtualMemSize >> 12) + L2_TABLE_MASK) / L2_TABLE_ENTRIES * sizeof(uintptr_t);
+  PagePointer = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, DirectorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  LOGMAN_THROW_A_FMT(PagePointer != -1ULL, "Failed to allocate page pointer directory");
 
   // L1 Cache
   L1Pointer = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, L1_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
   LOGMAN_THROW_A_FMT(L1Pointer != -1ULL, "Failed to allocate L1Pointer");
 
-  VirtualMemSize = ctx->Config.VirtualMemSize;
+  // Every dispatch hits the L1 at a random offset, ask for huge pages to cut down on TLB misses
+  // Not an error if THP is disabled
+  madvise(reinterpret_cast<void*>(L1Pointer), L1_SIZE, MADV_HUGEPAGE);
 }
 
 LookupCache::~LookupCache() {
-  FEXCore::Allocator::munmap(reinterpret_cast<void*>(PagePointer), ctx->Config.VirtualMemSize / 4096 * 8);
-  FEXCore::Allocator::munmap(reinterpret_cast<void*>(PageMemory), CODE_SIZE);
+  for (auto Slab : L2Slabs) {
+    FEXCore::Allocator::munmap(reinterpret_cast<void*>(Slab), L2_SLAB_SIZE);
+  }
+  FEXCore::Allocator::munmap(reinterpret_cast<void*>(PagePointer), DirectorySize);
   FEXCore::Allocator::munmap(reinterpret_cast<void*>(L1Pointer), L1_SIZE);
 }
 
+uintptr_t LookupCache::AllocateL2Memory(size_t Size) {
+  if (L2SlabCursor + Size > L2SlabEnd) {
+    auto Slab = reinterpret_cast<uintptr_t>(FEXCore::Allocator::mmap(nullptr, L2_SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    LOGMAN_THROW_A_FMT(Slab != -1ULL, "Failed to allocate L2 slab");
+    L2Slabs.emplace_back(Slab);
+    L2SlabCursor = Slab;
+    L2SlabEnd = Slab + L2_SLAB_SIZE;
+  }
+
+  // Fresh anonymous memory, already zero
+  auto Result = L2SlabCursor;
+  L2SlabCursor += Size;
+  return Result;
+}
+
+uintptr_t LookupCache::AllocateBackingForPage(uint64_t GuestPage) {
+  uintptr_t Memory{};
+
+  if (PageBackings.size() < MAX_PAGE_BACKINGS) {
+    Memory = AllocateL2Memory(SIZE_PER_PAGE);
+  }
+  else {
+    // Out of backing space, take over the page that was filled the longest time ago
+    // Its blocks are still in the BlockList and get cached again on their next lookup
+    auto Oldest = std::prev(PageBackingLRU.end());
+    auto OldTable = reinterpret_cast<uintptr_t*>(PagePointer)[Oldest->GuestPage >> L2_TABLE_BITS];
+    reinterpret_cast<uintptr_t*>(OldTable)[Oldest->GuestPage & L2_TABLE_MASK] = 0;
+    PageBackings.erase(Oldest->GuestPage);
+
+    Memory = Oldest->Memory;
+    PageBackingLRU.erase(Oldest);
+    memset(reinterpret_cast<void*>(Memory), 0, SIZE_PER_PAGE);
+  }
+
+  PageBackingLRU.emplace_front(PageBacking{GuestPage, Memory});
+  PageBackings[GuestPage] = PageBackingLRU.begin();
+  return Memory;
+}
+
+void LookupCache::TouchBackingForPage(uint64_t GuestPage) {
+  // Only fills count as a use, lookups from the dispatcher don't come through here
+  auto it = PageBackings.find(GuestPage);
+  if (it != PageBackings.end()) {
+    PageBackingLRU.splice(PageBackingLRU.begin(), PageBackingLRU, it->second);
+  }
+}
+
 void LookupCache::HintUsedRange(uint64_t Address, uint64_t Size) {
-  // Tell the kernel we will definitely need [Address, Address+Size) mapped for the page pointer
-  // Page Pointer is allocated per page, so shift by page size
-  Address >>= 12;
-  Size >>= 12;
-  madvise(reinterpret_cast<void*>(PagePointer + Address), Size, MADV_WILLNEED);
+  // Create the L2 tables for [Address, Address+Size) now instead of on first use
+  auto FirstPage = (Address & (VirtualMemSize - 1)) >> 12;
+  auto LastPage = ((Address + Size - 1) & (VirtualMemSize - 1)) >> 12;
+  auto Directory = reinterpret_cast<uintptr_t*>(PagePointer);
+
+  for (auto Index = FirstPage >> L2_TABLE_BITS; Index <= (LastPage >> L2_TABLE_BITS); ++Index) {
+    if (!Directory[Index]) {
+      Directory[Index] = AllocateL2Memory(L2_TABLE_SIZE);
+    }
+  }
 }
 
 void LookupCache::ClearL2Cache() {
-  // Clear out the page memory
-  madvise(reinterpret_cast<void*>(PagePointer), ctx->Config.VirtualMemSize / 4096 * 8, MADV_DONTNEED);
-  madvise(reinterpret_cast<void*>(PageMemory), CODE_SIZE, MADV_DONTNEED);
-  AllocateOffset = 0;
+  // Drop every table and page backing
+  madvise(reinterpret_cast<void*>(PagePointer), DirectorySize, MADV_DONTNEED);
+  for (auto Slab : L2Slabs) {
+    FEXCore::Allocator::munmap(reinterpret_cast<void*>(Slab), L2_SLAB_SIZE);
+  }
+  L2Slabs.clear();
+  L2SlabCursor = L2SlabEnd = 0;
+
+  PageBackingLRU.clear();
+  PageBackings.clear();
+}
+
+void LookupCache::ClearSharedMappings() {
+  // Links from the retired shared code end up here too, so nothing may remain that points in to it
+  // Links between our own blocks get recreated on their next execution
+  BlockLinks.TakeIf([](uint64_t) {
+    return true;
+  }, [](const FEXCore::CPU::BlockLink &Link) {
+    Link.Delink();
+  });
+
+  madvise(reinterpret_cast<void*>(L1Pointer), L1_SIZE, MADV_DONTNEED);
+  ClearL2Cache();
 }
 
 void LookupCache::ClearCache() {
@@ -73,10 +149,10 @@ void LookupCache::ClearCache() {
   // Clear L2
   ClearL2Cache();
   // All code is gone, remove links
-  BlockLinks.clear();
+  BlockLinks.Clear();
   // All code is gone, clear the block list
   BlockList.clear();
+  CodePages.Clear();
 }
 
 }
-
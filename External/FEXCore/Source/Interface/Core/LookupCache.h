@@ -1,9 +1,14 @@
 #pragma once
+#include "Common/FlatMultiMap.h"
+#include "Interface/Core/SharedCodeCache.h"
+
+#include <FEXCore/Core/CPUBackend.h>
 #include <FEXCore/Utils/LogManager.h>
 
+#include <tsl/robin_map.h>
+
 #include <cstdint>
-#include <functional>
-#include <map>
+#include <list>
 #include <stddef.h>
 #include <utility>
 #include <vector>
@@ -21,7 +26,7 @@ public:
     uintptr_t GuestCode;
   };
 
-  LookupCache(FEXCore::Context::Context *CTX);
+  LookupCache(FEXCore::Context::Context *CTX, FEXCore::SharedCodeCache *Shared);
   ~LookupCache();
 
   using LookupCacheIter = uintptr_t;
@@ -37,13 +42,22 @@ public:
       if (HostCode != BlockList.end()) {
         CacheBlockMapping(Address, HostCode->second);
         return HostCode->second;
-      } else {
-        return 0;
       }
+
+      if (Shared) {
+        // Pull the block in from the process wide cache
+        if (auto SharedHostCode = Shared->FindBlock(Address)) {
+          CacheBlockMapping(Address, SharedHostCode);
+          return SharedHostCode;
+        }
+      }
+
+      return 0;
     }
   }
 
-  std::map<uint64_t, std::vector<uint64_t>> CodePages;
+  // Guest page index to the blocks that were compiled from that page
+  FEXCore::FlatMultiMap<uint64_t> CodePages;
 
   void AddBlockMapping(uint64_t Address, void *HostCode, uint64_t Start, uint64_t Length) { 
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
@@ -53,7 +67,7 @@ public:
     LOGMAN_THROW_A_FMT(InsertPoint.second == true, "Dupplicate block mapping added");
 
     for (auto CurrentPage = Start >> 12, EndPage = (Start + Length) >> 12; CurrentPage <= EndPage; CurrentPage++) {
-      CodePages[CurrentPage].push_back(Address);
+      CodePages.Insert(CurrentPage, Address);
     }
 
     // There is no need to update L1 or L2, they will get updated on first lookup
@@ -63,14 +77,43 @@ public:
     L1Entry.HostCode = (uintptr_t)HostCode;
   }
 
+  /**
+   * @brief Replaces a block with a recompiled version of it
+   *
+   * Only replaces the mapping if it still points to the code that was recompiled, the block could have been
+   * invalidated and compiled again in the mean time.
+   */
+  void UpdateBlockMapping(uint64_t Address, uintptr_t OldHostCode, void *HostCode, uint64_t Start, uint64_t Length) {
+    auto Block = BlockList.find(Address);
+    if (Block == BlockList.end() || Block->second != OldHostCode) {
+      return;
+    }
+
+    // Sever links to the old code, they get relinked to the new code on their next execution
+    BlockLinks.Take(Address, [](const FEXCore::CPU::BlockLink &Link) {
+      Link.Delink();
+    });
+
+    Block.value() = (uintptr_t)HostCode;
+
+    // The new code can cover more guest code than the old code did
+    for (auto CurrentPage = Start >> 12, EndPage = (Start + Length) >> 12; CurrentPage <= EndPage; CurrentPage++) {
+      CodePages.Insert(CurrentPage, Address);
+    }
+
+    CacheBlockMapping(Address, (uintptr_t)HostCode);
+  }
+
   void Erase(uint64_t Address) {
+    if (Shared) {
+      // Sever links from shared code and remove it from the process wide cache
+      Shared->Erase(Address);
+    }
 
     // Sever any links to this block
-    auto lower = BlockLinks.lower_bound({Address, 0});
-    auto upper = BlockLinks.upper_bound({Address, UINTPTR_MAX});
-    for (auto it = lower; it != upper; it = BlockLinks.erase(it)) {
-      it->second();
-    }
+    BlockLinks.Take(Address, [](const FEXCore::CPU::BlockLink &Link) {
+      Link.Delink();
+    });
 
     // Remove from BlockList
     BlockList.erase(Address);
@@ -82,31 +125,49 @@ public:
     }
 
     // Do full map
-    Address = Address & (VirtualMemSize -1);
-    uint64_t PageOffset = Address & (0x0FFF);
-    Address >>= 12;
-
-    uintptr_t *Pointers = reinterpret_cast<uintptr_t*>(PagePointer);
-    uint64_t LocalPagePointer = Pointers[Address];
-    if (!LocalPagePointer) {
+    auto L2Entry = FindL2Entry(Address);
+    if (!L2Entry) {
       // Page for this code didn't even exist, nothing to do
       return;
     }
 
     // Page exists, just set the offset to zero
-    auto BlockPointers = reinterpret_cast<LookupCacheEntry*>(LocalPagePointer);
-    BlockPointers[PageOffset].GuestCode = 0;
-    BlockPointers[PageOffset].HostCode = 0;
+    L2Entry->GuestCode = 0;
+    L2Entry->HostCode = 0;
+  }
+
+
+  /**
+   * @brief Can the exit at HostLink be linked directly to HostCode
+   *
+   * Shared code runs on every thread so it may only be linked to other shared code, a block from our BlockList
+   * is only known to this thread. Those exits keep going through the dispatcher.
+   */
+  bool CanLinkBlock(uintptr_t HostLink, uintptr_t HostCode) const {
+    return !Shared || !Shared->IsAddressInJITCode(HostLink) || Shared->IsAddressInJITCode(HostCode);
   }
 
+  void AddBlockLink(uint64_t GuestDestination, const FEXCore::CPU::BlockLink &Link) {
+    if (Shared && Shared->IsAddressInJITCode(Link.HostLink)) {
+      // The link lives in shared code, it needs to be severed regardless of which thread erases the destination
+      Shared->AddBlockLink(GuestDestination, Link);
+      return;
+    }
 
-  void AddBlockLink(uint64_t GuestDestination, uintptr_t HostLink, const std::function<void()> &delinker) {
-    BlockLinks.insert({{GuestDestination, HostLink}, delinker});
+    BlockLinks.Insert(GuestDestination, Link);
   }
 
   void ClearCache();
   void ClearL2Cache();
 
+  /**
+   * @brief Forgets every block that was pulled in from the SharedCodeCache
+   *
+   * The L1 and L2 don't know where their blocks came from so both are thrown away, our own blocks get
+   * cached again from the BlockList. All of our links are severed.
+   */
+  void ClearSharedMappings();
+
   void HintUsedRange(uint64_t Address, uint64_t Size);
 
   uintptr_t GetL1Pointer() const { return L1Pointer; }
@@ -116,6 +177,11 @@ public:
   constexpr static size_t L1_ENTRIES = 1 * 1024 * 1024; // Must be a power of 2
   constexpr static size_t L1_ENTRIES_MASK = L1_ENTRIES - 1;
 
+  // Each L2 table holds the page pointers for 2MB of guest memory
+  constexpr static size_t L2_TABLE_BITS = 9;
+  constexpr static size_t L2_TABLE_ENTRIES = 1ULL << L2_TABLE_BITS;
+  constexpr static size_t L2_TABLE_MASK = L2_TABLE_ENTRIES - 1;
+
 private:
   void CacheBlockMapping(uint64_t Address, uintptr_t HostCode) { 
     // Do L1
@@ -123,111 +189,97 @@ private:
     L1Entry.GuestCode = Address;
     L1Entry.HostCode = HostCode;
 
-    // Do ful map
-    auto FullAddress = Address;
-    Address = Address & (VirtualMemSize -1);
+    // Do full map
+    auto GuestPage = (Address & (VirtualMemSize - 1)) >> 12;
+    auto &Table = reinterpret_cast<uintptr_t*>(PagePointer)[GuestPage >> L2_TABLE_BITS];
+    if (!Table) {
+      Table = AllocateL2Memory(L2_TABLE_SIZE);
+    }
 
-    uint64_t PageOffset = Address & (0x0FFF);
-    Address >>= 12;
-    uintptr_t *Pointers = reinterpret_cast<uintptr_t*>(PagePointer);
-    uint64_t LocalPagePointer = Pointers[Address];
-    if (!LocalPagePointer) {
+    auto &Page = reinterpret_cast<uintptr_t*>(Table)[GuestPage & L2_TABLE_MASK];
+    if (!Page) {
       // We don't have a page pointer for this address
-      // Allocate one now if we can
-      uintptr_t NewPageBacking = AllocateBackingForPage();
-      if (!NewPageBacking) {
-        // Couldn't allocate, clear L2 and retry
-        ClearL2Cache();
-        CacheBlockMapping(Address, HostCode);
-        return;
-      }
-      Pointers[Address] = NewPageBacking;
-      LocalPagePointer = NewPageBacking;
+      Page = AllocateBackingForPage(GuestPage);
+    }
+    else {
+      TouchBackingForPage(GuestPage);
     }
-
-    // Add the new pointer to the page block
-    auto BlockPointers = reinterpret_cast<LookupCacheEntry*>(LocalPagePointer);
 
     // This silently replaces existing mappings
-    BlockPointers[PageOffset].GuestCode = FullAddress;
-    BlockPointers[PageOffset].HostCode = HostCode;
+    auto &L2Entry = reinterpret_cast<LookupCacheEntry*>(Page)[Address & 0x0FFF];
+    L2Entry.GuestCode = Address;
+    L2Entry.HostCode = HostCode;
   }
 
-  uintptr_t AllocateBackingForPage() {
-    uintptr_t NewBase = AllocateOffset;
-    uintptr_t NewEnd = AllocateOffset + SIZE_PER_PAGE;
+  LookupCacheEntry *FindL2Entry(uint64_t Address) const {
+    auto GuestPage = (Address & (VirtualMemSize - 1)) >> 12;
+    auto Table = reinterpret_cast<uintptr_t*>(PagePointer)[GuestPage >> L2_TABLE_BITS];
+    if (!Table) {
+      return nullptr;
+    }
 
-    if (NewEnd >= CODE_SIZE) {
-      // We ran out of block backing space. Need to clear the block cache and tell the JIT cores to clear their caches as well
-      // Tell whatever is calling this that it needs to do it.
-      return 0;
+    auto Page = reinterpret_cast<uintptr_t*>(Table)[GuestPage & L2_TABLE_MASK];
+    if (!Page) {
+      return nullptr;
     }
 
-    AllocateOffset = NewEnd;
-    return PageMemory + NewBase;
+    return &reinterpret_cast<LookupCacheEntry*>(Page)[Address & 0x0FFF];
   }
 
+  uintptr_t AllocateBackingForPage(uint64_t GuestPage);
+  void TouchBackingForPage(uint64_t GuestPage);
+  uintptr_t AllocateL2Memory(size_t Size);
+
   uintptr_t FindCodePointerForAddress(uint64_t Address) {
-    
     // Do L1
     auto &L1Entry = reinterpret_cast<LookupCacheEntry*>(L1Pointer)[Address & L1_ENTRIES_MASK];
     if (L1Entry.GuestCode == Address) {
       return L1Entry.HostCode;
     }
 
-    auto FullAddress = Address;
-    Address = Address & (VirtualMemSize -1);
-
-    uint64_t PageOffset = Address & (0x0FFF);
-    Address >>= 12;
-    uintptr_t *Pointers = reinterpret_cast<uintptr_t*>(PagePointer);
-    uint64_t LocalPagePointer = Pointers[Address];
-    if (!LocalPagePointer) {
-      // We don't have a page pointer for this address
-      return 0;
+    auto L2Entry = FindL2Entry(Address);
+    if (L2Entry && L2Entry->GuestCode == Address) {
+      L1Entry.GuestCode = Address;
+      return L1Entry.HostCode = L2Entry->HostCode;
     }
 
-    // Find there pointer for the address in the blocks
-    auto BlockPointers = reinterpret_cast<LookupCacheEntry*>(LocalPagePointer);
-
-    if (BlockPointers[PageOffset].GuestCode == FullAddress)
-    {
-      L1Entry.GuestCode = FullAddress;
-      return L1Entry.HostCode = BlockPointers[PageOffset].HostCode;
-    }
-    else
-      return 0;
+    // We don't have a page pointer for this address
+    return 0;
   }
 
+  // Directory of L2 tables, one per L2_TABLE_ENTRIES guest pages
   uintptr_t PagePointer;
-  uintptr_t PageMemory;
   uintptr_t L1Pointer;
 
-  struct BlockLinkTag {
-    uint64_t GuestDestination;
-    uintptr_t HostLink;
-
-    bool operator <(const BlockLinkTag& other) const {
-      if (GuestDestination < other.GuestDestination)
-        return true;
-      else if (GuestDestination == other.GuestDestination)
-        return HostLink < other.HostLink;
-      else
-        return false;
-    }
-  };
-
-
-  std::map<BlockLinkTag, std::function<void()>> BlockLinks;
-  std::map<uint64_t, uint64_t> BlockList;
+  // Guest destination to the exits that are linked to it
+  FEXCore::FlatMultiMap<FEXCore::CPU::BlockLink> BlockLinks;
+  tsl::robin_map<uint64_t, uintptr_t> BlockList;
 
+  // Limit on the real memory used by page backings, once reached the least recently filled page gets reused
   constexpr static size_t CODE_SIZE = 128 * 1024 * 1024;
   constexpr static size_t SIZE_PER_PAGE = 4096 * sizeof(LookupCacheEntry);
+  constexpr static size_t MAX_PAGE_BACKINGS = CODE_SIZE / SIZE_PER_PAGE;
+  constexpr static size_t L2_TABLE_SIZE = L2_TABLE_ENTRIES * sizeof(uintptr_t);
+  constexpr static size_t L2_SLAB_SIZE = 2 * 1024 * 1024;
   constexpr static size_t L1_SIZE = L1_ENTRIES * sizeof(LookupCacheEntry);
 
-  size_t AllocateOffset {};
+  struct PageBacking {
+    uint64_t GuestPage;
+    uintptr_t Memory;
+  };
+
+  // Most recently filled page at the front
+  std::list<PageBacking> PageBackingLRU;
+  tsl::robin_map<uint64_t, std::list<PageBacking>::iterator> PageBackings;
+
+  // Tables and page backings are carved out of these, nothing gets returned until the L2 is cleared
+  std::vector<uintptr_t> L2Slabs;
+  uintptr_t L2SlabCursor{};
+  uintptr_t L2SlabEnd{};
+  size_t DirectorySize{};
 
   FEXCore::Context::Context *ctx;
+  FEXCore::SharedCodeCache *Shared;
   uint64_t VirtualMemSize{};
 };
 }
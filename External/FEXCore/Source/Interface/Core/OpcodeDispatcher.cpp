@@ -7,6 +7,7 @@ $end_info$
 
 #include "Interface/Context/Context.h"
 #include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/TierUpService.h"
 
 #include <FEXCore/Config/Config.h>
 #include <FEXCore/Core/Context.h>
@@ -194,8 +195,18 @@ void OpDispatchBuilder::RETOp(OpcodeArgs) {
   // Store the new stack pointer
   _StoreContext(GPRSize, GPRClass, NewSP, RSPOffset);
 
+  // Could be the RET of an inlined callee, the stack still decides where we go
+  for (auto ReturnRIP : InlinedCallReturns) {
+    auto CondJump = _CondJump(NewRIP, _EntrypointOffset(ReturnRIP - Entry, GPRSize), InvalidNode, InvalidNode, {COND_EQ}, GPRSize);
+    SetTrueJumpTarget(CondJump, GetNewJumpBlock(ReturnRIP));
+
+    auto NextCheck = CreateNewCodeBlockAfter(GetCurrentBlock());
+    SetFalseJumpTarget(CondJump, NextCheck);
+    SetCurrentCodeBlock(NextCheck);
+  }
+
   // Store the new RIP
-  _ExitFunction(NewRIP);
+  _ExitFunction(NewRIP, true);
   BlockSetRIP = true;
 }
 
@@ -753,6 +764,22 @@ void OpDispatchBuilder::CALLOp(OpcodeArgs) {
 
   _StoreMem(GPRClass, GPRSize, NewSP, ConstantPCReturn, GPRSize);
 
+  const uint64_t ReturnRIP = Op->PC + Op->InstSize;
+  if (Multiblock &&
+      std::find(InlinedCallReturns.begin(), InlinedCallReturns.end(), ReturnRIP) != InlinedCallReturns.end()) {
+    uint64_t TargetRIP = ReturnRIP + Op->Src[0].Data.Literal.Value;
+    if (GPRSize == 4) {
+      TargetRIP &= 0xFFFFFFFFU;
+    }
+
+    // The callee was decoded in to this region. Its RET doesn't go through the shadow return stack
+    // so there is no GuestCall here either, the return address on the guest stack is all it needs
+    _Jump(GetNewJumpBlock(TargetRIP));
+    return;
+  }
+
+  _GuestCall(ConstantPCReturn);
+
   // Store the RIP
   _ExitFunction(NewRIP); // If we get here then leave the function now
 }
@@ -780,6 +807,15 @@ void OpDispatchBuilder::CALLAbsoluteOp(OpcodeArgs) {
   _StoreContext(GPRSize, GPRClass, NewSP, RSPOffset);
 
   _StoreMem(GPRClass, Size, NewSP, ConstantPCReturn, Size);
+  _GuestCall(ConstantPCReturn);
+
+  // Virtual calls get the same treatment as indirect jumps
+  if (ProfileIndirectBranches) {
+    RecordIndirectBranch(Op, JMPPCOffset);
+  }
+  else if (Multiblock && CTX->TierUp) {
+    GuardIndirectBranchTargets(Op, JMPPCOffset);
+  }
 
   // Store the RIP
   _ExitFunction(JMPPCOffset); // If we get here then leave the function now
@@ -1319,13 +1355,60 @@ void OpDispatchBuilder::JUMPAbsoluteOp(OpcodeArgs) {
   BlockSetRIP = true;
   // This is just an unconditional jump
   // This uses ModRM to determine its location
-  // No way to use this effectively in multiblock
   auto RIPOffset = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
 
+  if (ProfileIndirectBranches) {
+    RecordIndirectBranch(Op, RIPOffset);
+  }
+  else if (Multiblock && CTX->TierUp) {
+    GuardIndirectBranchTargets(Op, RIPOffset);
+  }
+
   // Store the new RIP
   _ExitFunction(RIPOffset);
 }
 
+void OpDispatchBuilder::RecordIndirectBranch(FEXCore::X86Tables::DecodedOp Op, OrderedNode *Target) {
+  const uint8_t GPRSize = CTX->GetGPRSize();
+  const uint32_t EntryOffset = offsetof(FEXCore::Core::CpuStateFrame, IndirectBranchProfile) +
+    FEXCore::TierUpService::GetIndirectBranchProfileIndex(Op->PC) * sizeof(FEXCore::Core::IndirectBranchProfileEntry);
+  const uint32_t CountOffset = EntryOffset + offsetof(FEXCore::Core::IndirectBranchProfileEntry, Count);
+
+  // Ring of the most recent targets, the sampler reads all of them at once
+  auto Count = _LoadContext(8, GPRClass, CountOffset);
+  auto TargetIndex = _And(Count, _Constant(FEXCore::Core::INDIRECT_BRANCH_PROFILE_TARGETS - 1));
+  _StoreContextIndexed(Target, TargetIndex, GPRSize, EntryOffset + offsetof(FEXCore::Core::IndirectBranchProfileEntry, Targets), sizeof(uint64_t), GPRClass);
+  _StoreContext(8, GPRClass, _Add(Count, _Constant(1)), CountOffset);
+  _StoreContext(GPRSize, GPRClass, _EntrypointOffset(Op->PC - Entry, GPRSize), EntryOffset + offsetof(FEXCore::Core::IndirectBranchProfileEntry, Site));
+}
+
+void OpDispatchBuilder::GuardIndirectBranchTargets(FEXCore::X86Tables::DecodedOp Op, OrderedNode *Target) {
+  const uint8_t GPRSize = CTX->GetGPRSize();
+
+  // Check the targets that the baseline tier saw the most before falling back to the lookup
+  for (auto HotTarget : CTX->TierUp->GetIndirectBranchTargets(Op->PC)) {
+    auto CondJump = _CondJump(Target, _EntrypointOffset(HotTarget - Entry, GPRSize), InvalidNode, InvalidNode, {COND_EQ}, GPRSize);
+
+    auto NextCheck = CreateNewCodeBlockAfter(GetCurrentBlock());
+    SetFalseJumpTarget(CondJump, NextCheck);
+
+    auto TargetBlock = JumpTargets.find(HotTarget);
+    if (TargetBlock != JumpTargets.end()) {
+      // The decoder pulled the target in to this region
+      SetTrueJumpTarget(CondJump, TargetBlock->second.BlockEntry);
+    }
+    else {
+      // Outside of the region the exit still gets linked directly to the target's block
+      auto TargetExit = CreateNewCodeBlockAtEnd();
+      SetTrueJumpTarget(CondJump, TargetExit);
+      SetCurrentCodeBlock(TargetExit);
+      _ExitFunction(_EntrypointOffset(HotTarget - Entry, GPRSize));
+    }
+
+    SetCurrentCodeBlock(NextCheck);
+  }
+}
+
 template<uint32_t SrcIndex>
 void OpDispatchBuilder::TESTOp(OpcodeArgs) {
   // TEST is an instruction that does an AND between the sources
@@ -3519,71 +3602,24 @@ void OpDispatchBuilder::STOSOp(OpcodeArgs) {
     _StoreContext(GPRSize, GPRClass, TailDest, GPROffset(X86State::REG_RDI));
   }
   else {
-    // Calculate deffered flags.
-    // This block is ending and it needs flag status
-    CalculateDeferredFlags();
-
-    // Create all our blocks
-    auto LoopHead = CreateNewCodeBlockAfter(GetCurrentBlock());
-    auto LoopTail = CreateNewCodeBlockAfter(LoopHead);
-    auto LoopEnd = CreateNewCodeBlockAfter(LoopTail);
-
-    // At the time this was written, our RA can't handle accessing nodes across blocks.
-    // So we need to re-load and re-calculate essential values each iteration of the loop.
-
-    // First thing we need to do is finish this block and jump to the start of the loop.
-
-    // RA can now better allocate things, move these ops before the header, to avoid accessing
-    // DF on every iteration
-    auto SizeConst = _Constant(Size);
-    auto NegSizeConst = _Constant(-Size);
-
-    // Calculate direction.
-    auto DF = GetRFLAG(FEXCore::X86State::RFLAG_DF_LOC);
-    auto PtrDir = _Select(FEXCore::IR::COND_EQ,
-        DF,  _Constant(0),
-        SizeConst, NegSizeConst);
+    // The whole repeat is a single MemSet, it leaves RCX and RDI where the last iteration would
+    OrderedNode *Src = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
+    OrderedNode *Counter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
+    OrderedNode *Dest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
 
-    _Jump(LoopHead);
+    // Only ES prefix
+    OrderedNode *DestAddr = AppendSegmentOffset(Dest, 0, FEXCore::X86Tables::DecodeFlags::FLAG_ES_PREFIX, true);
 
-    SetCurrentCodeBlock(LoopHead);
-    {
-      OrderedNode *Counter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
-      // Can we end the block?
-      _CondJump(Counter, LoopEnd, LoopTail, {COND_EQ});
+    // The host memset uses plain stores, fence it off from the surrounding TSO accesses
+    if (CTX->Config.TSOEnabled) {
+      _Fence({FEXCore::IR::Fence_LoadStore});
     }
 
-    SetCurrentCodeBlock(LoopTail);
-    {
-      OrderedNode *Src = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-      OrderedNode *Dest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
+    _MemSet(Size, DestAddr, Src, Counter, GetStringOpFlags());
 
-      // Only ES prefix
-      Dest = AppendSegmentOffset(Dest, 0, FEXCore::X86Tables::DecodeFlags::FLAG_ES_PREFIX, true);
-
-      // Store to memory where RDI points
-      _StoreMemAutoTSO(GPRClass, Size, Dest, Src, Size);
-
-      OrderedNode *TailCounter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
-      OrderedNode *TailDest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
-
-      // Decrement counter
-      TailCounter = _Sub(TailCounter, _Constant(1));
-
-      // Store the counter so we don't have to deal with PHI here
-      _StoreContext(GPRSize, GPRClass, TailCounter, GPROffset(X86State::REG_RCX));
-
-      // Offset the pointer
-      TailDest = _Add(TailDest, PtrDir);
-      _StoreContext(GPRSize, GPRClass, TailDest, GPROffset(X86State::REG_RDI));
-
-      // Jump back to the start, we have more work to do
-      _Jump(LoopHead);
+    if (CTX->Config.TSOEnabled) {
+      _Fence({FEXCore::IR::Fence_LoadStore});
     }
-
-    // Make sure to start a new block after ending this one
-
-    SetCurrentCodeBlock(LoopEnd);
   }
 }
 
@@ -3605,63 +3641,23 @@ void OpDispatchBuilder::MOVSOp(OpcodeArgs) {
   auto PtrDir = _Select(FEXCore::IR::COND_EQ, DF,  _Constant(0), SizeConst, NegSizeConst);
 
   if (Op->Flags & (FEXCore::X86Tables::DecodeFlags::FLAG_REP_PREFIX | FEXCore::X86Tables::DecodeFlags::FLAG_REPNE_PREFIX)) {
-    // Calculate flags early. because end of block
-    CalculateDeferredFlags();
-
-    // Create all our blocks
-    auto LoopHead = CreateNewCodeBlockAfter(GetCurrentBlock());
-    auto LoopTail = CreateNewCodeBlockAfter(LoopHead);
-    auto LoopEnd = CreateNewCodeBlockAfter(LoopTail);
-
-
-    // At the time this was written, our RA can't handle accessing nodes across blocks.
-    // So we need to re-load and re-calculate essential values each iteration of the loop.
-
-    // First thing we need to do is finish this block and jump to the start of the loop.
-
-    _Jump(LoopHead);
+    // The whole repeat is a single MemCpy, it leaves RCX, RSI and RDI where the last iteration would
+    OrderedNode *Counter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
+    OrderedNode *Src = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RSI));
+    OrderedNode *Dest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
+    OrderedNode *DestAddr = AppendSegmentOffset(Dest, 0, FEXCore::X86Tables::DecodeFlags::FLAG_ES_PREFIX, true);
+    OrderedNode *SrcAddr = AppendSegmentOffset(Src, Op->Flags, FEXCore::X86Tables::DecodeFlags::FLAG_DS_PREFIX);
 
-    SetCurrentCodeBlock(LoopHead);
-    {
-      OrderedNode *Counter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
-      _CondJump(Counter, LoopEnd, LoopTail, {COND_EQ});
+    // The host memmove uses plain loads and stores, fence it off from the surrounding TSO accesses
+    if (CTX->Config.TSOEnabled) {
+      _Fence({FEXCore::IR::Fence_LoadStore});
     }
 
-    SetCurrentCodeBlock(LoopTail);
-    {
-      OrderedNode *Src = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RSI));
-      OrderedNode *Dest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
-      Dest = AppendSegmentOffset(Dest, 0, FEXCore::X86Tables::DecodeFlags::FLAG_ES_PREFIX, true);
-      Src = AppendSegmentOffset(Src, Op->Flags, FEXCore::X86Tables::DecodeFlags::FLAG_DS_PREFIX);
-
-      Src = _LoadMemAutoTSO(GPRClass, Size, Src, Size);
-
-      // Store to memory where RDI points
-      _StoreMemAutoTSO(GPRClass, Size, Dest, Src, Size);
-
-      OrderedNode *TailCounter = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RCX));
-
-      // Decrement counter
-      TailCounter = _Sub(TailCounter, _Constant(1));
-
-      // Store the counter so we don't have to deal with PHI here
-      _StoreContext(GPRSize, GPRClass, TailCounter, GPROffset(X86State::REG_RCX));
-
-      // Offset the pointer
-      OrderedNode *TailSrc = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RSI));
-      OrderedNode *TailDest = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RDI));
-      TailSrc = _Add(TailSrc, PtrDir);
-      TailDest = _Add(TailDest, PtrDir);
-      _StoreContext(GPRSize, GPRClass, TailSrc, GPROffset(X86State::REG_RSI));
-      _StoreContext(GPRSize, GPRClass, TailDest, GPROffset(X86State::REG_RDI));
+    _MemCpy(Size, DestAddr, SrcAddr, Counter, GetStringOpFlags());
 
-      // Jump back to the start, we have more work to do
-      _Jump(LoopHead);
+    if (CTX->Config.TSOEnabled) {
+      _Fence({FEXCore::IR::Fence_LoadStore});
     }
-
-    // Make sure to start a new block after ending this one
-
-    SetCurrentCodeBlock(LoopEnd);
   }
   else {
     OrderedNode *RSI = _LoadContext(GPRSize, GPRClass, GPROffset(X86State::REG_RSI));
@@ -4462,6 +4458,10 @@ void OpDispatchBuilder::CreateJumpBlocks(std::vector<FEXCore::Frontend::Decoder:
     auto CodeNode = CreateCodeNode();
 
     JumpTargets.try_emplace(Target.Entry, JumpTargetInfo{CodeNode, false});
+    // The baseline tier decodes the same regions but doesn't inline the calls
+    if (Multiblock && Target.IsInlinedCallReturn) {
+      InlinedCallReturns.emplace_back(Target.Entry);
+    }
 
     if (PrevCodeBlock) {
       LinkCodeBlocks(PrevCodeBlock, CodeNode);
@@ -4604,6 +4604,15 @@ OrderedNode *OpDispatchBuilder::AppendSegmentOffset(OrderedNode *Value, uint32_t
   return Value;
 }
 
+OrderedNode *OpDispatchBuilder::GetStringOpFlags() {
+  // DF is zero or one, which lines up with MEMOP_DIRECTION_DOWN
+  OrderedNode *Flags = GetRFLAG(FEXCore::X86State::RFLAG_DF_LOC);
+  if (CTX->GetGPRSize() == 4) {
+    Flags = _Or(Flags, _Constant(FEXCore::IR::MEMOP_ADDRESS_32BIT));
+  }
+  return Flags;
+}
+
 OrderedNode *OpDispatchBuilder::LoadSource_WithOpSize(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint8_t OpSize, uint32_t Flags, int8_t Align, bool LoadData, bool ForceLoad) {
   LOGMAN_THROW_A_FMT(Operand.IsGPR() ||
                      Operand.IsLiteral() ||
@@ -4887,6 +4896,7 @@ void OpDispatchBuilder::StoreResult(FEXCore::IR::RegisterClassType Class, FEXCor
 
 OpDispatchBuilder::OpDispatchBuilder(FEXCore::Context::Context *ctx)
   : CTX {ctx} {
+  X87ReducedPrecision = CTX->Config.X87ReducedPrecision();
   ResetWorkingList();
   InstallHostSpecificOpcodeHandlers();
 }
@@ -4894,6 +4904,7 @@ OpDispatchBuilder::OpDispatchBuilder(FEXCore::Context::Context *ctx)
 void OpDispatchBuilder::ResetWorkingList() {
   IREmitter::ResetWorkingList();
   JumpTargets.clear();
+  InlinedCallReturns.clear();
   BlockSetRIP = false;
   DecodeFailure = false;
   ShouldDump = false;
@@ -84,6 +84,8 @@ public:
   };
 
   std::map<uint64_t, JumpTargetInfo> JumpTargets;
+  // Return addresses of the calls that the decoder inlined, every RET in the region checks these
+  std::vector<uint64_t> InlinedCallReturns;
 
   OrderedNode* GetNewJumpBlock(uint64_t RIP) {
     auto it = JumpTargets.find(RIP);
@@ -571,15 +573,21 @@ public:
   OrderedNode *GetPackedRFLAG(bool Lower8);
 
   void SetMultiblock(bool _Multiblock) { Multiblock = _Multiblock; }
+  void SetProfileIndirectBranches(bool _ProfileIndirectBranches) { ProfileIndirectBranches = _ProfileIndirectBranches; }
 
   bool HandledLock = false;
 private:
   bool DecodeFailure{false};
+  // x87 stack registers hold doubles instead of 80-bit floats
+  bool X87ReducedPrecision{false};
   FEXCore::IR::IROp_IRHeader *Current_Header{};
   OrderedNode *Current_HeaderNode{};
 
   OrderedNode *AppendSegmentOffset(OrderedNode *Value, uint32_t Flags, uint32_t DefaultPrefix = 0, bool Override = false);
 
+  // $Flags for MemSet and MemCpy from DF and the address size
+  OrderedNode *GetStringOpFlags();
+
   OrderedNode *GetRelocatedPC(FEXCore::X86Tables::DecodedOp const& Op, int64_t Offset = 0);
   OrderedNode *LoadSource(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint32_t Flags, int8_t Align, bool LoadData = true, bool ForceLoad = false);
   OrderedNode *LoadSource_WithOpSize(FEXCore::IR::RegisterClassType Class, FEXCore::X86Tables::DecodedOp const& Op, FEXCore::X86Tables::DecodedOperand const& Operand, uint8_t OpSize, uint32_t Flags, int8_t Align, bool LoadData = true, bool ForceLoad = false);
@@ -1148,6 +1156,18 @@ private:
   OrderedNode *GetX87FTW(OrderedNode *Value);
   void SetX87Top(OrderedNode *Value);
 
+  // Converts between the stack register format and memory floats of `Width` bits
+  OrderedNode *X87FromMemory(OrderedNode *Data, size_t Width);
+  OrderedNode *X87ToMemory(OrderedNode *Data, size_t Width);
+  // Converts between the stack register format and integers of `Size` bytes
+  OrderedNode *X87FromInt(OrderedNode *Data, size_t Size);
+  OrderedNode *X87ToInt(OrderedNode *Data, size_t Size, bool Truncate);
+  OrderedNode *X87Const(uint64_t Mantissa, uint16_t Exponent);
+  // Takes the F80 op, uses the host double op instead in reduced precision mode when there is one
+  OrderedNode *X87UnaryALUOp(FEXCore::IR::IROps F80Op, OrderedNode *Src);
+  OrderedNode *X87BinaryALUOp(FEXCore::IR::IROps F80Op, OrderedNode *Src1, OrderedNode *Src2);
+  OrderedNode *X87Cmp(OrderedNode *Src1, OrderedNode *Src2, uint32_t Flags);
+
   bool DestIsLockedMem(FEXCore::X86Tables::DecodedOp Op) const {
     return DestIsMem(Op) && (Op->Flags & FEXCore::X86Tables::DecodeFlags::FLAG_LOCK) != 0;
   }
@@ -1160,8 +1180,13 @@ private:
   bool BlockSetRIP {false};
 
   bool Multiblock{};
+  // Baseline tier, indirect branches record their targets for the TierUpService
+  bool ProfileIndirectBranches{};
   uint64_t Entry;
 
+  void RecordIndirectBranch(FEXCore::X86Tables::DecodedOp Op, OrderedNode *Target);
+  void GuardIndirectBranchTargets(FEXCore::X86Tables::DecodedOp Op, OrderedNode *Target);
+
   OrderedNode* _StoreMemAutoTSO(FEXCore::IR::RegisterClassType Class, uint8_t Size, OrderedNode *Addr, OrderedNode *Value, uint8_t Align = 1) {
     if (CTX->Config.TSOEnabled)
       return _StoreMemTSO(Class, Size, Value, Addr, Invalid(), Align, MEM_OFFSET_SXTX, 1);
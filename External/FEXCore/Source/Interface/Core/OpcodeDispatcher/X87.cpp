@@ -14,6 +14,8 @@ $end_info$
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXCore/IR/IREmitter.h>
 
+#include <bit>
+#include <cmath>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -55,6 +57,124 @@ void OpDispatchBuilder::SetX87Top(OrderedNode *Value) {
   _StoreContext(1, GPRClass, Value, offsetof(FEXCore::Core::CPUState, flags) + FEXCore::X86State::X87FLAG_TOP_LOC);
 }
 
+OrderedNode *OpDispatchBuilder::X87FromMemory(OrderedNode *Data, size_t Width) {
+  if (!X87ReducedPrecision) {
+    return Width == 80 ? Data : _F80CVTTo(Data, Width / 8);
+  }
+
+  switch (Width) {
+    case 32: return _Float_FToF(8, 4, Data);
+    case 64: return Data;
+    case 80: return _F80CVT(8, Data);
+    default: LOGMAN_MSG_A_FMT("Unhandled x87 memory width: {}", Width); return Data;
+  }
+}
+
+OrderedNode *OpDispatchBuilder::X87ToMemory(OrderedNode *Data, size_t Width) {
+  if (!X87ReducedPrecision) {
+    return Width == 80 ? Data : _F80CVT(Width / 8, Data);
+  }
+
+  switch (Width) {
+    case 32: return _Float_FToF(4, 8, Data);
+    case 64: return Data;
+    case 80: return _F80CVTTo(Data, 8);
+    default: LOGMAN_MSG_A_FMT("Unhandled x87 memory width: {}", Width); return Data;
+  }
+}
+
+OrderedNode *OpDispatchBuilder::X87FromInt(OrderedNode *Data, size_t Size) {
+  if (!X87ReducedPrecision) {
+    return _F80CVTToInt(Data, Size);
+  }
+
+  if (Size != 8) {
+    Data = _Sext(Size * 8, Data);
+  }
+  return _Float_FromGPR_S(8, 8, Data);
+}
+
+OrderedNode *OpDispatchBuilder::X87ToInt(OrderedNode *Data, size_t Size, bool Truncate) {
+  if (!X87ReducedPrecision) {
+    return _F80CVTInt(Size, Data, Truncate);
+  }
+
+  // 16-bit results get truncated by the store
+  const uint8_t DestSize = Size == 8 ? 8 : 4;
+  if (Truncate) {
+    return _Float_ToGPR_ZS(DestSize, 8, Data);
+  }
+  return _Float_ToGPR_S(DestSize, 8, Data);
+}
+
+OrderedNode *OpDispatchBuilder::X87Const(uint64_t Mantissa, uint16_t Exponent) {
+  if (X87ReducedPrecision) {
+    double Value{};
+    if (Mantissa != 0) {
+      Value = std::ldexp(static_cast<double>(Mantissa), static_cast<int>(Exponent & 0x7FFF) - 16383 - 63);
+    }
+    if (Exponent & 0x8000) {
+      Value = -Value;
+    }
+    return _VCastFromGPR(16, 8, _Constant(std::bit_cast<uint64_t>(Value)));
+  }
+
+  OrderedNode *Data = _VCastFromGPR(16, 8, _Constant(Mantissa));
+  return _VInsGPR(16, 8, 1, Data, _Constant(Exponent));
+}
+
+OrderedNode *OpDispatchBuilder::X87UnaryALUOp(FEXCore::IR::IROps F80Op, OrderedNode *Src) {
+  if (X87ReducedPrecision) {
+    if (F80Op == IR::OP_F80SQRT) {
+      return _VFSqrt(8, 8, Src);
+    }
+
+    // No host equivalent, round trip through soft float
+    Src = _F80CVTTo(Src, 8);
+  }
+
+  auto Result = _F80Round(Src);
+  // Overwrite the op
+  Result.first->Header.Op = F80Op;
+
+  if (X87ReducedPrecision) {
+    return _F80CVT(8, Result);
+  }
+  return Result;
+}
+
+OrderedNode *OpDispatchBuilder::X87BinaryALUOp(FEXCore::IR::IROps F80Op, OrderedNode *Src1, OrderedNode *Src2) {
+  if (X87ReducedPrecision) {
+    switch (F80Op) {
+      case IR::OP_F80ADD: return _VFAdd(8, 8, Src1, Src2);
+      case IR::OP_F80SUB: return _VFSub(8, 8, Src1, Src2);
+      case IR::OP_F80MUL: return _VFMul(8, 8, Src1, Src2);
+      case IR::OP_F80DIV: return _VFDiv(8, 8, Src1, Src2);
+      default: break;
+    }
+
+    // No host equivalent, round trip through soft float
+    Src1 = _F80CVTTo(Src1, 8);
+    Src2 = _F80CVTTo(Src2, 8);
+  }
+
+  auto Result = _F80Add(Src1, Src2);
+  // Overwrite the op
+  Result.first->Header.Op = F80Op;
+
+  if (X87ReducedPrecision) {
+    return _F80CVT(8, Result);
+  }
+  return Result;
+}
+
+OrderedNode *OpDispatchBuilder::X87Cmp(OrderedNode *Src1, OrderedNode *Src2, uint32_t Flags) {
+  if (X87ReducedPrecision) {
+    return _FCmp(8, Src1, Src2, Flags);
+  }
+  return _F80Cmp(Src1, Src2, Flags);
+}
+
 template<size_t width>
 void OpDispatchBuilder::FLD(OpcodeArgs) {
   // Update TOP
@@ -77,9 +197,9 @@ void OpDispatchBuilder::FLD(OpcodeArgs) {
   }
   OrderedNode *converted = data;
 
-  // Convert to 80bit float
-  if constexpr (width == 32 || width == 64) {
-    converted = _F80CVTTo(data, width / 8);
+  // Convert to the stack format, implicit args are already in it
+  if (!Op->Src[0].IsNone()) {
+    converted = X87FromMemory(data, width);
   }
 
   auto top = _And(_Sub(orig_top, _Constant(1)), mask);
@@ -108,13 +228,19 @@ void OpDispatchBuilder::FBLD(OpcodeArgs) {
   // Read from memory
   OrderedNode *data = LoadSource_WithOpSize(FPRClass, Op, Op->Src[0], 16, Op->Flags, -1);
   OrderedNode *converted = _F80BCDLoad(data);
+  if (X87ReducedPrecision) {
+    converted = _F80CVT(8, converted);
+  }
   _StoreContextIndexed(converted, top, 16, MMBaseOffset(), 16, FPRClass);
 }
 
 void OpDispatchBuilder::FBSTP(OpcodeArgs) {
   auto orig_top = GetX87Top();
-  auto data = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
+  OrderedNode *data = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
 
+  if (X87ReducedPrecision) {
+    data = _F80CVTTo(data, 8);
+  }
   OrderedNode *converted = _F80BCDStore(data);
 
   StoreResult_WithOpSize(FPRClass, Op, Op->Dest, converted, 10, 1);
@@ -133,10 +259,7 @@ void OpDispatchBuilder::FLD_Const(OpcodeArgs) {
   SetX87TopTag(top, X87Tag::Valid);
   SetX87Top(top);
 
-  auto low = _Constant(Lower);
-  auto high = _Constant(Upper);
-  OrderedNode *data = _VCastFromGPR(16, 8, low);
-  data = _VInsGPR(16, 8, 1, data, high);
+  OrderedNode *data = X87Const(Lower, Upper);
   // Write to ST[TOP]
   _StoreContextIndexed(data, top, 16, MMBaseOffset(), 16, FPRClass);
 }
@@ -168,6 +291,11 @@ void OpDispatchBuilder::FILD(OpcodeArgs) {
   // Read from memory
   auto data = LoadSource_WithOpSize(GPRClass, Op, Op->Src[0], read_width, Op->Flags, -1);
 
+  if (X87ReducedPrecision) {
+    _StoreContextIndexed(X87FromInt(data, read_width), top, 16, MMBaseOffset(), 16, FPRClass);
+    return;
+  }
+
   auto zero = _Constant(0);
 
   // Sign extend to 64bits
@@ -198,11 +326,11 @@ template<size_t width>
 void OpDispatchBuilder::FST(OpcodeArgs) {
   auto orig_top = GetX87Top();
   auto data = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
+  auto result = X87ToMemory(data, width);
   if constexpr (width == 80) {
-    StoreResult_WithOpSize(FPRClass, Op, Op->Dest, data, 10, 1);
+    StoreResult_WithOpSize(FPRClass, Op, Op->Dest, result, 10, 1);
   }
   else if constexpr (width == 32 || width == 64) {
-    auto result = _F80CVT(width / 8, data);
     StoreResult_WithOpSize(FPRClass, Op, Op->Dest, result, width / 8, 1);
   }
 
@@ -228,7 +356,7 @@ void OpDispatchBuilder::FIST(OpcodeArgs) {
 
   auto orig_top = GetX87Top();
   OrderedNode *data = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
-  data = _F80CVTInt(Size, data, Truncate);
+  data = X87ToInt(data, Size, Truncate);
 
   StoreResult_WithOpSize(GPRClass, Op, Op->Dest, data, Size, 1);
 
@@ -261,11 +389,11 @@ void OpDispatchBuilder::FADD(OpcodeArgs) {
     if constexpr (width == 16 || width == 32 || width == 64) {
       if constexpr (Integer) {
         arg = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTToInt(arg, width / 8);
+        b = X87FromInt(arg, width / 8);
       }
       else {
         arg = LoadSource(FPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTTo(arg, width / 8);
+        b = X87FromMemory(arg, width);
       }
     }
   } else {
@@ -279,7 +407,7 @@ void OpDispatchBuilder::FADD(OpcodeArgs) {
   }
 
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
-  auto result = _F80Add(a, b);
+  auto result = X87BinaryALUOp(IR::OP_F80ADD, a, b);
 
   if ((Op->TableInfo->Flags & X86Tables::InstFlags::FLAGS_POP) != 0) {
     // if we are popping then we must first mark this location as empty
@@ -322,11 +450,11 @@ void OpDispatchBuilder::FMUL(OpcodeArgs) {
     if constexpr (width == 16 || width == 32 || width == 64) {
       if constexpr (Integer) {
         arg = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTToInt(arg, width / 8);
+        b = X87FromInt(arg, width / 8);
       }
       else {
         arg = LoadSource(FPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTTo(arg, width / 8);
+        b = X87FromMemory(arg, width);
       }
     }
   } else {
@@ -342,7 +470,7 @@ void OpDispatchBuilder::FMUL(OpcodeArgs) {
 
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80Mul(a, b);
+  auto result = X87BinaryALUOp(IR::OP_F80MUL, a, b);
 
   if ((Op->TableInfo->Flags & X86Tables::InstFlags::FLAGS_POP) != 0) {
     // if we are popping then we must first mark this location as empty
@@ -385,11 +513,11 @@ void OpDispatchBuilder::FDIV(OpcodeArgs) {
     if constexpr (width == 16 || width == 32 || width == 64) {
       if constexpr (Integer) {
         arg = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTToInt(arg, width / 8);
+        b = X87FromInt(arg, width / 8);
       }
       else {
         arg = LoadSource(FPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTTo(arg, width / 8);
+        b = X87FromMemory(arg, width);
       }
     }
   } else {
@@ -407,10 +535,10 @@ void OpDispatchBuilder::FDIV(OpcodeArgs) {
 
   OrderedNode *result{};
   if constexpr (reverse) {
-    result = _F80Div(b, a);
+    result = X87BinaryALUOp(IR::OP_F80DIV, b, a);
   }
   else {
-    result = _F80Div(a, b);
+    result = X87BinaryALUOp(IR::OP_F80DIV, a, b);
   }
 
   if ((Op->TableInfo->Flags & X86Tables::InstFlags::FLAGS_POP) != 0) {
@@ -470,11 +598,11 @@ void OpDispatchBuilder::FSUB(OpcodeArgs) {
     if constexpr (width == 16 || width == 32 || width == 64) {
       if constexpr (Integer) {
         arg = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTToInt(arg, width / 8);
+        b = X87FromInt(arg, width / 8);
       }
       else {
         arg = LoadSource(FPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTTo(arg, width / 8);
+        b = X87FromMemory(arg, width);
       }
     }
   } else {
@@ -491,10 +619,10 @@ void OpDispatchBuilder::FSUB(OpcodeArgs) {
 
   OrderedNode *result{};
   if constexpr (reverse) {
-    result = _F80Sub(b, a);
+    result = X87BinaryALUOp(IR::OP_F80SUB, b, a);
   }
   else {
-    result = _F80Sub(a, b);
+    result = X87BinaryALUOp(IR::OP_F80SUB, a, b);
   }
 
   if ((Op->TableInfo->Flags & X86Tables::InstFlags::FLAGS_POP) != 0) {
@@ -544,10 +672,16 @@ void OpDispatchBuilder::FCHS(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto low = _Constant(0);
-  auto high = _Constant(0b1'000'0000'0000'0000ULL);
-  OrderedNode *data = _VCastFromGPR(16, 8, low);
-  data = _VInsGPR(16, 8, 1, data, high);
+  OrderedNode *data{};
+  if (X87ReducedPrecision) {
+    data = _VCastFromGPR(16, 8, _Constant(1ULL << 63));
+  }
+  else {
+    auto low = _Constant(0);
+    auto high = _Constant(0b1'000'0000'0000'0000ULL);
+    data = _VCastFromGPR(16, 8, low);
+    data = _VInsGPR(16, 8, 1, data, high);
+  }
 
   auto result = _VXor(16, 1, a, data);
 
@@ -559,10 +693,16 @@ void OpDispatchBuilder::FABS(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto low = _Constant(~0ULL);
-  auto high = _Constant(0b0'111'1111'1111'1111ULL);
-  OrderedNode *data = _VCastFromGPR(16, 8, low);
-  data = _VInsGPR(16, 8, 1, data, high);
+  OrderedNode *data{};
+  if (X87ReducedPrecision) {
+    data = _VCastFromGPR(16, 8, _Constant(~(1ULL << 63)));
+  }
+  else {
+    auto low = _Constant(~0ULL);
+    auto high = _Constant(0b0'111'1111'1111'1111ULL);
+    data = _VCastFromGPR(16, 8, low);
+    data = _VInsGPR(16, 8, 1, data, high);
+  }
 
   auto result = _VAnd(16, 1, a, data);
 
@@ -574,10 +714,9 @@ void OpDispatchBuilder::FTST(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto low = _Constant(0);
-  OrderedNode *data = _VCastFromGPR(16, 8, low);
+  OrderedNode *data = X87Const(0, 0);
 
-  OrderedNode *Res = _F80Cmp(a, data,
+  OrderedNode *Res = X87Cmp(a, data,
     (1 << FCMP_FLAG_EQ) |
     (1 << FCMP_FLAG_LT) |
     (1 << FCMP_FLAG_UNORDERED));
@@ -598,7 +737,7 @@ void OpDispatchBuilder::FRNDINT(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80Round(a);
+  auto result = X87UnaryALUOp(IR::OP_F80ROUND, a);
 
   // Write to ST[TOP]
   _StoreContextIndexed(result, top, 16, MMBaseOffset(), 16, FPRClass);
@@ -612,8 +751,8 @@ void OpDispatchBuilder::FXTRACT(OpcodeArgs) {
 
   auto a = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto exp = _F80XTRACT_EXP(a);
-  auto sig = _F80XTRACT_SIG(a);
+  auto exp = X87UnaryALUOp(IR::OP_F80XTRACT_EXP, a);
+  auto sig = X87UnaryALUOp(IR::OP_F80XTRACT_SIG, a);
 
   // Write to ST[TOP]
   _StoreContextIndexed(exp, orig_top, 16, MMBaseOffset(), 16, FPRClass);
@@ -651,11 +790,11 @@ void OpDispatchBuilder::FCOMI(OpcodeArgs) {
     if constexpr (width == 16 || width == 32 || width == 64) {
       if constexpr (Integer) {
         arg = LoadSource(GPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTToInt(arg, width / 8);
+        b = X87FromInt(arg, width / 8);
       }
       else {
         arg = LoadSource(FPRClass, Op, Op->Src[0], Op->Flags, -1);
-        b = _F80CVTTo(arg, width / 8);
+        b = X87FromMemory(arg, width);
       }
     }
   } else {
@@ -667,7 +806,7 @@ void OpDispatchBuilder::FCOMI(OpcodeArgs) {
 
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  OrderedNode *Res = _F80Cmp(a, b,
+  OrderedNode *Res = X87Cmp(a, b,
     (1 << FCMP_FLAG_EQ) |
     (1 << FCMP_FLAG_LT) |
     (1 << FCMP_FLAG_UNORDERED));
@@ -778,9 +917,7 @@ void OpDispatchBuilder::X87UnaryOp(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80Round(a);
-  // Overwrite the op
-  result.first->Header.Op = IROp;
+  auto result = X87UnaryALUOp(IROp, a);
 
   // Write to ST[TOP]
   _StoreContextIndexed(result, top, 16, MMBaseOffset(), 16, FPRClass);
@@ -805,9 +942,7 @@ void OpDispatchBuilder::X87BinaryOp(OpcodeArgs) {
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
   st1 = _LoadContextIndexed(st1, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80Add(a, st1);
-  // Overwrite the op
-  result.first->Header.Op = IROp;
+  auto result = X87BinaryALUOp(IROp, a, st1);
 
   if constexpr (IROp == IR::OP_F80FPREM) {
     //TODO: Set C0 to Q2, C3 to Q1, C1 to Q0
@@ -851,8 +986,8 @@ void OpDispatchBuilder::X87SinCos(OpcodeArgs) {
 
   auto a = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto sin = _F80SIN(a);
-  auto cos = _F80COS(a);
+  auto sin = X87UnaryALUOp(IR::OP_F80SIN, a);
+  auto cos = X87UnaryALUOp(IR::OP_F80COS, a);
 
   // Write to ST[TOP]
   _StoreContextIndexed(sin, orig_top, 16, MMBaseOffset(), 16, FPRClass);
@@ -872,14 +1007,11 @@ void OpDispatchBuilder::X87FYL2X(OpcodeArgs) {
   OrderedNode *st1 = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
   if (Plus1) {
-    auto low = _Constant(0x8000'0000'0000'0000ULL);
-    auto high = _Constant(0b0'011'1111'1111'1111);
-    OrderedNode *data = _VCastFromGPR(16, 8, low);
-    data = _VInsGPR(16, 8, 1, data, high);
-    st0 = _F80Add(st0, data);
+    OrderedNode *data = X87Const(0x8000'0000'0000'0000ULL, 0b0'011'1111'1111'1111);
+    st0 = X87BinaryALUOp(IR::OP_F80ADD, st0, data);
   }
 
-  auto result = _F80FYL2X(st0, st1);
+  auto result = X87BinaryALUOp(IR::OP_F80FYL2X, st0, st1);
 
   // Write to ST[TOP]
   _StoreContextIndexed(result, top, 16, MMBaseOffset(), 16, FPRClass);
@@ -893,12 +1025,9 @@ void OpDispatchBuilder::X87TAN(OpcodeArgs) {
 
   auto a = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80TAN(a);
+  auto result = X87UnaryALUOp(IR::OP_F80TAN, a);
 
-  auto low = _Constant(0x8000'0000'0000'0000ULL);
-  auto high = _Constant(0b0'011'1111'1111'1111ULL);
-  OrderedNode *data = _VCastFromGPR(16, 8, low);
-  data = _VInsGPR(16, 8, 1, data, high);
+  OrderedNode *data = X87Const(0x8000'0000'0000'0000ULL, 0b0'011'1111'1111'1111ULL);
 
   // Write to ST[TOP]
   _StoreContextIndexed(result, orig_top, 16, MMBaseOffset(), 16, FPRClass);
@@ -915,7 +1044,7 @@ void OpDispatchBuilder::X87ATAN(OpcodeArgs) {
   auto a = _LoadContextIndexed(orig_top, 16, MMBaseOffset(), 16, FPRClass);
   OrderedNode *st1 = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
 
-  auto result = _F80ATAN(st1, a);
+  auto result = X87BinaryALUOp(IR::OP_F80ATAN, st1, a);
 
   // Write to ST[TOP]
   _StoreContextIndexed(result, top, 16, MMBaseOffset(), 16, FPRClass);
@@ -1262,10 +1391,14 @@ void OpDispatchBuilder::X87FRSTOR(OpcodeArgs) {
 void OpDispatchBuilder::X87FXAM(OpcodeArgs) {
   auto top = GetX87Top();
   auto a = _LoadContextIndexed(top, 16, MMBaseOffset(), 16, FPRClass);
-  OrderedNode *Result = _VExtractToGPR(16, 8, a, 1);
-
   // Extract the sign bit
-  Result = _Lshr(Result, _Constant(15));
+  OrderedNode *Result{};
+  if (X87ReducedPrecision) {
+    Result = _Lshr(_VExtractToGPR(16, 8, a, 0), _Constant(63));
+  }
+  else {
+    Result = _Lshr(_VExtractToGPR(16, 8, a, 1), _Constant(15));
+  }
   SetRFLAG<FEXCore::X86State::X87FLAG_C1_LOC>(Result);
 
   // Claim this is a normal number
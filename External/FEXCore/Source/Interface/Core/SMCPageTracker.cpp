@@ -0,0 +1,343 @@
+/*
+$info$
+tags: glue|block-database
+desc: Write-protects guest code pages and invalidates the blocks on a page when the guest writes to it
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/ArchHelpers/MContext.h"
+#include "Interface/Core/LookupCache.h"
+#include "Interface/Core/CodeInvalidationService.h"
+#include "Interface/Core/SharedCodeCache.h"
+#include "Interface/Core/SMCPageTracker.h"
+#include "Interface/Core/TierUpService.h"
+
+#include <FEXCore/Core/SignalDelegator.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <fstream>
+#include <new>
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <sys/mman.h>
+#include <utility>
+#include <vector>
+
+namespace FEXCore {
+  SMCPageTracker::SMCPageTracker(FEXCore::Context::Context *ctx)
+    : CTX {ctx} {
+    CTX->SignalDelegation->RegisterHostSignalHandler(SIGSEGV, [this](FEXCore::Core::InternalThreadState *Thread, int Signal, void *info, void *ucontext) -> bool {
+      auto SigInfo = reinterpret_cast<siginfo_t*>(info);
+
+      // Our protected pages are always mapped, anything else is a real fault
+      if (SigInfo->si_code != SEGV_ACCERR) {
+        return false;
+      }
+
+      return HandleWriteFault(Thread, reinterpret_cast<uint64_t>(SigInfo->si_addr), ucontext);
+    }, true);
+
+    // Reserved up front, the handler can't deal with the table moving
+    void *Table = ::mmap(nullptr, PROTECTED_PAGES_SIZE * sizeof(std::atomic<uint64_t>), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    LOGMAN_THROW_A_FMT(Table != MAP_FAILED, "Couldn't allocate the SMC page table");
+    ProtectedPages = reinterpret_cast<std::atomic<uint64_t>*>(Table);
+  }
+
+  SMCPageTracker::~SMCPageTracker() {
+    ::munmap(ProtectedPages, PROTECTED_PAGES_SIZE * sizeof(std::atomic<uint64_t>));
+  }
+
+  static uint64_t ProtectedPageHash(uint64_t Page, uint64_t Size) {
+    return (Page * 0x9E3779B97F4A7C15ULL) & (Size - 1);
+  }
+
+  std::atomic<uint64_t> *SMCPageTracker::FindEntry(uint64_t Page) {
+    const uint64_t Index = ProtectedPageHash(Page, PROTECTED_PAGES_SIZE);
+    for (uint64_t i = 0; i < PROTECTED_PAGES_SIZE; ++i) {
+      auto Entry = &ProtectedPages[(Index + i) & (PROTECTED_PAGES_SIZE - 1)];
+      uint64_t Value = Entry->load(std::memory_order_acquire);
+      if (Value == 0) {
+        return nullptr;
+      }
+
+      if (Value != ENTRY_TOMBSTONE && (Value >> ENTRY_PAGE_SHIFT) == Page) {
+        return Entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  std::atomic<uint64_t> *SMCPageTracker::InsertEntry(uint64_t Page, int Prot) {
+    const uint64_t Index = ProtectedPageHash(Page, PROTECTED_PAGES_SIZE);
+    for (uint64_t i = 0; i < PROTECTED_PAGES_SIZE; ++i) {
+      auto Entry = &ProtectedPages[(Index + i) & (PROTECTED_PAGES_SIZE - 1)];
+      uint64_t Value = Entry->load(std::memory_order_relaxed);
+      // The page isn't in the table, the first free slot is as good as any
+      if (Value == 0 || Value == ENTRY_TOMBSTONE) {
+        Entry->store((Page << ENTRY_PAGE_SHIFT) | ENTRY_VALID | (Prot & ENTRY_PROT_MASK), std::memory_order_release);
+        return Entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  void SMCPageTracker::ProtectCodeRange(uint64_t Start, uint64_t Length) {
+    if (Length == 0) {
+      return;
+    }
+
+    std::scoped_lock lk(PageMutex);
+
+    for (auto CurrentPage = Start >> PAGE_SHIFT, EndPage = (Start + Length - 1) >> PAGE_SHIFT; CurrentPage <= EndPage; CurrentPage++) {
+      auto it = Pages.find(CurrentPage);
+      if (it == Pages.end()) {
+        int Prot = GetMappedProtection(CurrentPage << PAGE_SHIFT);
+        if (Prot == -1 || !(Prot & PROT_WRITE)) {
+          // The guest can't write to this page without changing its mapping first, which flushes the code anyway
+          continue;
+        }
+
+        auto Entry = InsertEntry(CurrentPage, Prot);
+        if (!Entry) {
+          LogMan::Msg::DFmt("SMC page table is full, not tracking code page 0x{:x}", CurrentPage << PAGE_SHIFT);
+          continue;
+        }
+
+        it = Pages.emplace(CurrentPage, TrackedPage{Prot, Entry}).first;
+      }
+
+      auto &Page = it->second;
+      if (Page.Entry->load(std::memory_order_acquire) & ENTRY_PROTECTED) {
+        continue;
+      }
+
+      // Protected first, a fault before the flag is set only retries the write until it is
+      // The other way around the handler could unprotect the page before it gets protected and nothing would clear the flag
+      if (::mprotect(reinterpret_cast<void*>(CurrentPage << PAGE_SHIFT), PAGE_SIZE, Page.Prot & ~PROT_WRITE) == 0) {
+        Page.Entry->fetch_or(ENTRY_PROTECTED, std::memory_order_release);
+      }
+      else {
+        LogMan::Msg::DFmt("Couldn't write-protect code page 0x{:x}", CurrentPage << PAGE_SHIFT);
+      }
+    }
+  }
+
+  void SMCPageTracker::UntrackRange(uint64_t Start, uint64_t Length) {
+    if (Length == 0) {
+      return;
+    }
+
+    std::scoped_lock lk(PageMutex);
+    auto lower = Pages.lower_bound(Start >> PAGE_SHIFT);
+    auto upper = Pages.upper_bound((Start + Length - 1) >> PAGE_SHIFT);
+    for (auto it = lower; it != upper; ++it) {
+      it->second.Entry->store(ENTRY_TOMBSTONE, std::memory_order_release);
+    }
+    Pages.erase(lower, upper);
+
+    // The guest's protections changed, look them up again
+    Mappings.clear();
+  }
+
+  void SMCPageTracker::UnprotectRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length) {
+    if (Length == 0) {
+      return;
+    }
+
+    std::vector<uint64_t> Unprotected;
+
+    {
+      std::scoped_lock lk(PageMutex);
+      auto lower = Pages.lower_bound(Start >> PAGE_SHIFT);
+      auto upper = Pages.upper_bound((Start + Length - 1) >> PAGE_SHIFT);
+
+      for (auto it = lower; it != upper; ++it) {
+        if (it->second.Entry->exchange(ENTRY_TOMBSTONE, std::memory_order_acq_rel) & ENTRY_PROTECTED) {
+          ::mprotect(reinterpret_cast<void*>(it->first << PAGE_SHIFT), PAGE_SIZE, it->second.Prot);
+          Unprotected.emplace_back(it->first);
+        }
+      }
+
+      Pages.erase(lower, upper);
+      Mappings.clear();
+    }
+
+    // Writes to these pages aren't caught anymore, the code compiled from them can't be trusted
+    for (auto Page : Unprotected) {
+      InvalidatePage(Thread, Page);
+    }
+  }
+
+  void SMCPageTracker::CleanupAfterFork() {
+    // The protections are inherited by the child, only the lock could have been held by a thread that is gone now
+    new (&PageMutex) std::mutex{};
+  }
+
+  bool SMCPageTracker::HandleWriteFault(FEXCore::Core::InternalThreadState *Thread, uint64_t Address, void *ucontext) {
+    const uint64_t Page = Address >> PAGE_SHIFT;
+
+    auto Entry = FindEntry(Page);
+    if (!Entry) {
+      return false;
+    }
+
+    uint64_t Value = Entry->load(std::memory_order_acquire);
+    if (Value == ENTRY_TOMBSTONE || (Value >> ENTRY_PAGE_SHIFT) != Page) {
+      // Untracked while we were looking, the guest's mapping decides now
+      return false;
+    }
+
+    // If it isn't protected then another thread beat us to it or is just protecting it, the write can be retried as is
+    if (!(Value & ENTRY_PROTECTED)) {
+      return true;
+    }
+
+    // Unprotected before the flag is cleared so a racing ProtectCodeRange can't leave the page writable while unflagged
+    ::mprotect(reinterpret_cast<void*>(Page << PAGE_SHIFT), PAGE_SIZE, static_cast<int>(Value & ENTRY_PROT_MASK));
+
+    if (!(Entry->fetch_and(~ENTRY_PROTECTED, std::memory_order_acq_rel) & ENTRY_PROTECTED)) {
+      // Someone else got to record it
+      return true;
+    }
+
+    auto Data = Thread->CodeInvalidationData.get();
+    if (!Data) {
+      // Only guest threads write to guest code, anything else can't have blocks from the page anyway
+      return true;
+    }
+
+    if (Data->FaultedPageCount < Data->FaultedPages.size()) {
+      Data->FaultedPages[Data->FaultedPageCount++] = Page;
+    }
+    else {
+      Data->FaultedPagesOverflow = true;
+    }
+
+    std::atomic_ref<uint64_t>(Thread->CurrentFrame->PendingCodeInvalidation).store(1, std::memory_order_relaxed);
+
+    // JIT code holds none of our locks, the blocks are dropped before the write retries so the block's exits can't
+    // link back in to them. A guest signal handler nested in a compile still has the compile's locks held
+    if (Thread->CompileBlockReentrantRefCount == 0 &&
+        Thread->CPUBackend->IsAddressInJITCode(ArchHelpers::Context::GetPc(ucontext), false)) {
+      FEXCore::SignalDelegator::EnterCriticalSection();
+      InvalidateFaultedPages(Thread);
+      FEXCore::SignalDelegator::LeaveCriticalSection();
+    }
+
+    return true;
+  }
+
+  void SMCPageTracker::InvalidateHostWrites(FEXCore::Core::InternalThreadState *Thread) {
+    auto Tracker = Thread->CTX->SMCTracker.get();
+    auto Data = Thread->CodeInvalidationData.get();
+    if (!Tracker || !Data || (Data->FaultedPageCount == 0 && !Data->FaultedPagesOverflow)) {
+      return;
+    }
+
+    Tracker->InvalidateFaultedPages(Thread);
+  }
+
+  void SMCPageTracker::InvalidateFaultedPages(FEXCore::Core::InternalThreadState *Thread) {
+    auto Data = Thread->CodeInvalidationData.get();
+
+    std::vector<uint64_t> Faulted(Data->FaultedPages.begin(), Data->FaultedPages.begin() + Data->FaultedPageCount);
+    Data->FaultedPageCount = 0;
+
+    if (std::exchange(Data->FaultedPagesOverflow, false)) {
+      // The pages that didn't fit are still unprotected, invalidating a few pages too many is harmless
+      std::scoped_lock lk(PageMutex);
+      for (auto &[Page, Entry] : Pages) {
+        if (!(Entry.Entry->load(std::memory_order_acquire) & ENTRY_PROTECTED)) {
+          Faulted.emplace_back(Page);
+        }
+      }
+    }
+
+    for (auto Page : Faulted) {
+      InvalidatePage(Thread, Page);
+    }
+  }
+
+  void SMCPageTracker::InvalidatePage(FEXCore::Core::InternalThreadState *Thread, uint64_t Page) {
+    const uint64_t PageBase = Page << PAGE_SHIFT;
+
+    if (CTX->TierUp) {
+      // Optimized blocks can cover more guest code than the baseline blocks, their pages need to be known first
+      ++Thread->CompileBlockReentrantRefCount;
+      CTX->TierUp->InstallCompletedBlocks(Thread);
+      CTX->TierUp->FlushCodeRange(Thread, PageBase, PAGE_SIZE);
+      --Thread->CompileBlockReentrantRefCount;
+    }
+
+    Thread->LookupCache->CodePages.Take(Page, [Thread](uint64_t Address) {
+      FEXCore::Context::Context::RemoveCodeEntry(Thread, Address);
+    });
+
+    CTX->DecodedInstructions.InvalidateRange(PageBase, PAGE_SIZE - 1);
+
+    std::vector<uint64_t> SharedBlocks;
+    if (CTX->SharedCode) {
+      // Zero length only covers this page
+      SharedBlocks = CTX->SharedCode->TakeBlocksInRange(PageBase, 0);
+      for (auto Address : SharedBlocks) {
+        FEXCore::Context::Context::RemoveCodeEntry(Thread, Address);
+      }
+    }
+
+    // The other threads drop their blocks from the page at their next dispatcher loop top
+    CTX->CodeInvalidation->BroadcastCodeRange(Thread, PageBase, PAGE_SIZE - 1, SharedBlocks);
+  }
+
+  int SMCPageTracker::GetMappedProtection(uint64_t Address) {
+    auto FindProtection = [this, Address]() -> int {
+      auto it = std::upper_bound(Mappings.begin(), Mappings.end(), Address, [](uint64_t Address, const MappedRegion &Region) {
+        return Address < Region.End;
+      });
+
+      if (it == Mappings.end() || Address < it->Start) {
+        return -1;
+      }
+
+      return it->Prot;
+    };
+
+    int Prot = FindProtection();
+    if (Prot == -1) {
+      // Guest code can only come from mapped memory, the cached mappings are out of date
+      ReloadMappings();
+      Prot = FindProtection();
+    }
+
+    return Prot;
+  }
+
+  void SMCPageTracker::ReloadMappings() {
+    Mappings.clear();
+
+    std::fstream fs("/proc/self/maps", std::fstream::in | std::fstream::binary);
+    std::string Line;
+
+    while (std::getline(fs, Line)) {
+      uint64_t Begin, End;
+      char Perms[5]{};
+      if (sscanf(Line.c_str(), "%" SCNx64 "-%" SCNx64 " %4s", &Begin, &End, Perms) != 3) {
+        continue;
+      }
+
+      int Prot =
+        (Perms[0] == 'r' ? PROT_READ : 0) |
+        (Perms[1] == 'w' ? PROT_WRITE : 0) |
+        (Perms[2] == 'x' ? PROT_EXEC : 0);
+
+      Mappings.emplace_back(MappedRegion{Begin, End, Prot});
+    }
+  }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+
+/**
+ * @brief Self-modifying code detection through guest page protections
+ *
+ * Once code is compiled from a writable guest page the page gets write-protected.
+ * The first write to it raises a SIGSEGV, the handler restores the guest's protection, records the page for the
+ * faulting thread and lets the write retry. The page is protected again when code is compiled from it the next time.
+ *
+ * Blocks are entered through linked exits, the L1 cache and the return stack without passing a safe point, so the
+ * faulting thread drops the page's blocks before it runs any more of its guest code:
+ * - A write from JIT code holds none of our locks, the handler invalidates the page before the write retries.
+ * - Host code that writes guest memory for the guest (syscalls, string op helpers) can hold any lock. The handler
+ *   only records the page and the host code invalidates it through InvalidateHostWrites before it returns to JIT code.
+ * Other threads drop the blocks at their next safe point. Code of the block that did the write keeps running until the
+ * block exits, multiblock code that inlined the patched function doesn't see the write.
+ *
+ * Pages that the guest maps without PROT_WRITE are never tracked, writes to those are real faults.
+ */
+class SMCPageTracker final {
+  public:
+    SMCPageTracker(FEXCore::Context::Context *ctx);
+    ~SMCPageTracker();
+
+    /**
+     * @brief Write-protects the guest pages that a block was compiled from
+     */
+    void ProtectCodeRange(uint64_t Start, uint64_t Length);
+
+    /**
+     * @brief Stops tracking pages whose mapping was changed by the guest
+     *
+     * Called after the guest's mmap, munmap or mprotect, the guest's new protection is left alone
+     */
+    void UntrackRange(uint64_t Start, uint64_t Length);
+
+    /**
+     * @brief Restores the guest's protection of tracked pages in the range and stops tracking them
+     *
+     * Needs to happen before the guest moves the pages somewhere else, and before a syscall has the kernel write to
+     * them since the kernel fails the syscall with EFAULT instead of faulting
+     */
+    void UnprotectRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length);
+
+    /**
+     * @brief Invalidates the pages that the thread's writes faulted on
+     *
+     * Only to be called by the thread itself while it holds none of our locks
+     */
+    void InvalidateFaultedPages(FEXCore::Core::InternalThreadState *Thread);
+
+    /**
+     * @brief Invalidates the pages that host code faulted on while writing guest memory for the thread
+     *
+     * Called before returning to JIT code from host code that can write to guest code pages
+     */
+    static void InvalidateHostWrites(FEXCore::Core::InternalThreadState *Thread);
+
+    void CleanupAfterFork();
+
+  private:
+    constexpr static uint64_t PAGE_SHIFT = 12;
+    constexpr static uint64_t PAGE_SIZE = 1ULL << PAGE_SHIFT;
+
+    struct TrackedPage {
+      // Guest protection of the page
+      int Prot;
+      // The page's entry in ProtectedPages
+      std::atomic<uint64_t> *Entry;
+    };
+
+    // ProtectedPages entries are the page index shifted up with the state in the low bits
+    // Empty entries are zero, erased entries are tombstones so lookups keep probing past them
+    constexpr static uint64_t ENTRY_PAGE_SHIFT = 8;
+    constexpr static uint64_t ENTRY_PROT_MASK = 0b111;
+    constexpr static uint64_t ENTRY_VALID = 1ULL << 3;
+    constexpr static uint64_t ENTRY_PROTECTED = 1ULL << 4;
+    constexpr static uint64_t ENTRY_TOMBSTONE = ~0ULL;
+    constexpr static uint64_t PROTECTED_PAGES_SIZE = 1ULL << 18;
+
+    struct MappedRegion {
+      uint64_t Start;
+      uint64_t End;
+      int Prot;
+    };
+
+    /**
+     * @brief Restores the guest's protection of the page and records it for the thread
+     *
+     * Runs in the SIGSEGV handler, must not take locks or allocate unless the write came from JIT code
+     */
+    bool HandleWriteFault(FEXCore::Core::InternalThreadState *Thread, uint64_t Address, void *ucontext);
+
+    // Signal safe
+    std::atomic<uint64_t> *FindEntry(uint64_t Page);
+    // Under PageMutex, nullptr if the table is full
+    std::atomic<uint64_t> *InsertEntry(uint64_t Page, int Prot);
+
+    /**
+     * @brief Removes the blocks that the thread compiled from this guest page
+     *
+     * The other threads get the page queued through the CodeInvalidationService
+     */
+    void InvalidatePage(FEXCore::Core::InternalThreadState *Thread, uint64_t Page);
+
+    /**
+     * @return The protection of the mapping containing Address, -1 if it isn't mapped
+     */
+    int GetMappedProtection(uint64_t Address);
+    void ReloadMappings();
+
+    FEXCore::Context::Context *CTX;
+
+    // Protects everything below
+    std::mutex PageMutex{};
+
+    // Guest page index to tracking state, only holds guest writable pages
+    std::map<uint64_t, TrackedPage> Pages{};
+
+    // Open addressed copy of the tracked pages and their protection state that the SIGSEGV handler can read
+    // Only modified under PageMutex, except for the handler clearing ENTRY_PROTECTED
+    std::atomic<uint64_t> *ProtectedPages{};
+
+    // Cached copy of /proc/self/maps, sorted by address
+    // Dropped when the guest changes its mappings and reloaded on a lookup miss
+    std::vector<MappedRegion> Mappings{};
+};
+}
@@ -0,0 +1,218 @@
+/*
+$info$
+tags: glue|block-database
+desc: Process wide block cache, compiles blocks once and shares the host code between all guest threads
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/CodeInvalidationService.h"
+#include "Interface/Core/LookupCache.h"
+#include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/SharedCodeCache.h"
+#include "Interface/Core/SMCPageTracker.h"
+#include "Interface/IR/PassManager.h"
+
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/SignalDelegator.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/LogManager.h>
+#include <FEXHeaderUtils/ScopedSignalMask.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace FEXCore {
+  SharedCodeCache::SharedCodeCache(FEXCore::Context::Context *ctx)
+    : CTX {ctx}
+    , CurrentTable {std::make_unique<BlockTable>(BlockTable::INITIAL_SIZE)} {
+    Blocks.store(CurrentTable.get(), std::memory_order_relaxed);
+  }
+
+  SharedCodeCache::~SharedCodeCache() = default;
+
+  void SharedCodeCache::Initialize(FEXCore::Core::InternalThreadState *ParentThread) {
+    CompileThreadData = std::make_unique<FEXCore::Core::InternalThreadState>();
+    CompileThreadData->IsCompileService = true;
+
+    // Same as the CompileService, the compiler borrows the parent thread's dispatcher data
+    // The parent thread lives until the context is torn down so the code is valid for all threads
+    CTX->InitializeCompiler(CompileThreadData.get(), true);
+    CompileThreadData->CPUBackend->CopyNecessaryDataForCompileThread(ParentThread->CPUBackend.get());
+    CompileThreadData->CPUBackend->SetSharedCode(true);
+  }
+
+  void SharedCodeCache::ReplaceTable(std::unique_ptr<BlockTable> NewTable) {
+    Blocks.store(NewTable.get(), std::memory_order_release);
+
+    // Threads that loaded the old table before the store haven't passed a safe point in the new epoch yet
+    RetiredTables.emplace_back(std::move(CurrentTable), CTX->CodeInvalidation->AdvanceEpoch());
+    CurrentTable = std::move(NewTable);
+
+    std::erase_if(RetiredTables, [this](auto const &Retired) {
+      return CTX->CodeInvalidation->IsEpochQuiescent(Retired.second);
+    });
+  }
+
+  void SharedCodeCache::InsertBlock(uint64_t Address, uintptr_t HostCode) {
+    auto Table = CurrentTable.get();
+    for (size_t i = Table->Hash(Address);; i = (i + 1) & Table->Mask) {
+      auto &Entry = Table->Entries[i];
+      const uint64_t EntryAddress = Entry.Address.load(std::memory_order_relaxed);
+      if (EntryAddress == Address) {
+        LOGMAN_THROW_A_FMT(Entry.HostCode.load(std::memory_order_relaxed) == 0, "Duplicate shared block mapping added");
+        Entry.HostCode.store(HostCode, std::memory_order_release);
+        return;
+      }
+
+      if (EntryAddress == BlockTable::EMPTY) {
+        // The host code needs to be visible before a reader can match the address
+        Entry.HostCode.store(HostCode, std::memory_order_relaxed);
+        Entry.Address.store(Address, std::memory_order_release);
+        ++Table->Used;
+        break;
+      }
+    }
+
+    // Lookups stop at the first empty slot, keep at least half of them empty
+    const size_t Size = Table->Mask + 1;
+    if (Table->Used * 2 <= Size) {
+      return;
+    }
+
+    size_t Live{};
+    for (size_t i = 0; i < Size; ++i) {
+      Live += Table->Entries[i].HostCode.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Erased blocks get dropped, the table only grows if that doesn't free up enough slots
+    size_t NewSize = Size;
+    while (Live * 4 >= NewSize) {
+      NewSize *= 2;
+    }
+
+    auto NewTable = std::make_unique<BlockTable>(NewSize);
+    for (size_t i = 0; i < Size; ++i) {
+      const uintptr_t EntryHostCode = Table->Entries[i].HostCode.load(std::memory_order_relaxed);
+      if (!EntryHostCode) {
+        continue;
+      }
+
+      const uint64_t EntryAddress = Table->Entries[i].Address.load(std::memory_order_relaxed);
+      size_t j = NewTable->Hash(EntryAddress);
+      while (NewTable->Entries[j].Address.load(std::memory_order_relaxed) != BlockTable::EMPTY) {
+        j = (j + 1) & NewTable->Mask;
+      }
+      NewTable->Entries[j].Address.store(EntryAddress, std::memory_order_relaxed);
+      NewTable->Entries[j].HostCode.store(EntryHostCode, std::memory_order_relaxed);
+      ++NewTable->Used;
+    }
+
+    ReplaceTable(std::move(NewTable));
+  }
+
+  uintptr_t SharedCodeCache::CompileBlock(uint64_t GuestRIP) {
+    std::scoped_lock lk(CompileMutex);
+
+    // Another thread might have compiled this block while we were waiting on the compiler
+    if (auto HostCode = FindBlock(GuestRIP)) {
+      return HostCode;
+    }
+
+    CompileThreadData->CurrentFrame->State.rip = GuestRIP;
+
+    auto [CodePtr, IRList, DebugData, RAData, GeneratedIR, StartAddr, Length] = CTX->CompileCode(CompileThreadData.get(), GuestRIP);
+
+    if (CodePtr == nullptr) {
+      return 0;
+    }
+
+    CTX->RegisterBlockJITNaming(GuestRIP, CodePtr, DebugData);
+
+    if (CTX->IRCaptureCache.PostCompileCode(
+        CompileThreadData.get(),
+        CodePtr,
+        GuestRIP,
+        StartAddr,
+        Length,
+        RAData,
+        IRList,
+        DebugData,
+        GeneratedIR,
+        false)) {
+      // Early exit
+      return (uintptr_t)CodePtr;
+    }
+
+    {
+      FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+      InsertBlock(GuestRIP, (uintptr_t)CodePtr);
+
+      for (auto CurrentPage = StartAddr >> 12, EndPage = (StartAddr + Length) >> 12; CurrentPage <= EndPage; CurrentPage++) {
+        CodePages.Insert(CurrentPage, GuestRIP);
+      }
+    }
+
+    if (CTX->SMCTracker) {
+      CTX->SMCTracker->ProtectCodeRange(StartAddr, Length);
+    }
+
+    return (uintptr_t)CodePtr;
+  }
+
+  void SharedCodeCache::AddBlockLink(uint64_t GuestDestination, const FEXCore::CPU::BlockLink &Link) {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+    BlockLinks.Insert(GuestDestination, Link);
+  }
+
+  void SharedCodeCache::Erase(uint64_t Address) {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+
+    // Sever any links to this block
+    BlockLinks.Take(Address, [](const FEXCore::CPU::BlockLink &Link) {
+      Link.Delink();
+    });
+
+    auto Table = CurrentTable.get();
+    for (size_t i = Table->Hash(Address);; i = (i + 1) & Table->Mask) {
+      auto &Entry = Table->Entries[i];
+      const uint64_t EntryAddress = Entry.Address.load(std::memory_order_relaxed);
+      if (EntryAddress == Address) {
+        Entry.HostCode.store(0, std::memory_order_release);
+        return;
+      }
+      if (EntryAddress == BlockTable::EMPTY) {
+        return;
+      }
+    }
+  }
+
+  std::vector<uint64_t> SharedCodeCache::TakeBlocksInRange(uint64_t Start, uint64_t Length) {
+    std::vector<uint64_t> Blocks;
+
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+    CodePages.TakeRange(Start >> 12, (Start + Length) >> 12, [&Blocks](uint64_t Address) {
+      Blocks.emplace_back(Address);
+    });
+
+    return Blocks;
+  }
+
+  void SharedCodeCache::EraseLinksInRange(uintptr_t Start, size_t Size) {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+    BlockLinks.EraseIf([Start, Size](const FEXCore::CPU::BlockLink &Link) {
+      return Link.HostLink >= Start && Link.HostLink < (Start + Size);
+    });
+  }
+
+  void SharedCodeCache::ClearCache() {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(BlockMutex);
+
+    // The old code buffers are kept alive by the backend until every thread dropped
+    // these blocks from its L1/L2 and links, until then they can keep on executing them
+    BlockLinks.Clear();
+    CodePages.Clear();
+    ReplaceTable(std::make_unique<BlockTable>(BlockTable::INITIAL_SIZE));
+  }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Common/FlatMultiMap.h"
+
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+
+/**
+ * @brief Process wide code cache that is shared between all guest threads
+ *
+ * Blocks are compiled once by a single compiler instance and then pulled in to each thread's
+ * LookupCache L1/L2 on first lookup. Only the JIT supports this since its code doesn't rely on
+ * the retained IR copy that the interpreter needs.
+ *
+ * Shared code buffers are never rewound since any thread could be executing inside of them.
+ *
+ * Lookups don't take a lock, a thread can be interrupted by a guest signal in the middle of one and look up
+ * blocks again from the handler. The block table is an open addressed table that only the writers modify,
+ * erased blocks keep their slot with a null host pointer. Growing the table publishes a new one and retires the
+ * old one through the CodeInvalidationService's epochs, it is freed once no thread can still be probing it.
+ * Writers defer signals while they hold the lock so a handler can't run in to it again on the same thread.
+ */
+class SharedCodeCache final {
+  public:
+    SharedCodeCache(FEXCore::Context::Context *ctx);
+    ~SharedCodeCache();
+
+    /**
+     * @brief Creates the compiler that is shared between all threads
+     *
+     * @param ParentThread The first guest thread, the compiler copies its JIT data so it must outlive the cache
+     */
+    void Initialize(FEXCore::Core::InternalThreadState *ParentThread);
+
+    /**
+     * @brief Looks up a block in the shared cache
+     *
+     * Lock free, safe to be called from a signal handler
+     *
+     * @return Host code pointer or zero if the block isn't in the cache
+     */
+    uintptr_t FindBlock(uint64_t Address) {
+      auto Table = Blocks.load(std::memory_order_acquire);
+      for (size_t i = Table->Hash(Address);; i = (i + 1) & Table->Mask) {
+        auto &Entry = Table->Entries[i];
+        const uint64_t EntryAddress = Entry.Address.load(std::memory_order_acquire);
+        if (EntryAddress == Address) {
+          return Entry.HostCode.load(std::memory_order_acquire);
+        }
+        if (EntryAddress == BlockTable::EMPTY) {
+          return 0;
+        }
+      }
+    }
+
+    /**
+     * @brief Compiles the block at the guest RIP in to the shared code buffer
+     *
+     * Compilation is serialized between threads, if another thread compiled the block while we were waiting
+     * then that block is returned instead.
+     *
+     * Must not be called reentrantly from a signal handler, those go through the thread's CompileService
+     */
+    uintptr_t CompileBlock(uint64_t GuestRIP);
+
+    void AddBlockLink(uint64_t GuestDestination, const FEXCore::CPU::BlockLink &Link);
+    void Erase(uint64_t Address);
+
+    /**
+     * @brief Returns the guest blocks that overlap the guest range and forgets about the pages
+     *
+     * The caller is expected to erase the returned blocks through Context::RemoveCodeEntry
+     */
+    std::vector<uint64_t> TakeBlocksInRange(uint64_t Start, uint64_t Length);
+
+    void ClearCache();
+
+    /**
+     * @brief Forgets the links whose exit lives in the host range
+     *
+     * Threads that were still executing retired code can have linked it after the cache was cleared,
+     * those links must be gone before the code's memory is reused.
+     */
+    void EraseLinksInRange(uintptr_t Start, size_t Size);
+
+    bool IsCompileThread(FEXCore::Core::InternalThreadState const *Thread) const {
+      return Thread == CompileThreadData.get();
+    }
+
+    bool IsAddressInJITCode(uint64_t Address) const {
+      return CompileThreadData->CPUBackend->IsAddressInJITCode(Address, false, false);
+    }
+
+  private:
+    struct BlockTable final {
+      // Guest address of a slot that was never used, the guest can't execute a block there
+      constexpr static uint64_t EMPTY = ~0ULL;
+      constexpr static size_t INITIAL_SIZE = 4096;
+
+      struct Entry {
+        std::atomic<uint64_t> Address{EMPTY};
+        // Zero once the block was erased, the slot is reused if the block gets compiled again
+        std::atomic<uintptr_t> HostCode{};
+      };
+
+      explicit BlockTable(size_t Size)
+        : Mask {Size - 1}
+        , Shift {static_cast<uint32_t>(64 - __builtin_ctzll(Size))}
+        , Entries {std::make_unique<Entry[]>(Size)} {
+      }
+
+      size_t Hash(uint64_t Address) const {
+        return (Address * 0x9E37'79B9'7F4A'7C15ULL) >> Shift;
+      }
+
+      size_t Mask;
+      uint32_t Shift;
+      // Slots that hold an address, erased blocks included. Only touched by writers
+      size_t Used{};
+      std::unique_ptr<Entry[]> Entries;
+    };
+
+    /**
+     * @brief Publishes a new block table and retires the current one
+     *
+     * BlockMutex must be held
+     */
+    void ReplaceTable(std::unique_ptr<BlockTable> NewTable);
+    void InsertBlock(uint64_t Address, uintptr_t HostCode);
+
+    FEXCore::Context::Context *CTX;
+    std::unique_ptr<FEXCore::Core::InternalThreadState> CompileThreadData;
+
+    // Serializes compilation on CompileThreadData
+    std::mutex CompileMutex{};
+
+    // Serializes the writers of everything below, held only for short durations with signals deferred
+    std::mutex BlockMutex{};
+
+    std::atomic<BlockTable*> Blocks;
+    std::unique_ptr<BlockTable> CurrentTable;
+    // Tables that threads could still be probing and the epoch they were retired in
+    std::vector<std::pair<std::unique_ptr<BlockTable>, uint64_t>> RetiredTables;
+
+    FEXCore::FlatMultiMap<uint64_t> CodePages;
+    FEXCore::FlatMultiMap<FEXCore::CPU::BlockLink> BlockLinks;
+};
+}
@@ -2,12 +2,23 @@
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXHeaderUtils/Syscalls.h>
 
+#include <atomic>
 #include <unistd.h>
 #include <signal.h>
+#include <syscall.h>
 
 namespace FEXCore {
   struct ThreadState {
     FEXCore::Core::InternalThreadState *Thread{};
+
+    // Only ever touched by the thread itself and its signal handlers
+    uint32_t CriticalSectionDepth{};
+    // Signals that arrived in a critical section, they stay blocked until it is left
+    std::atomic<uint64_t> DeferredSignals{};
+    // Signals that LeaveCriticalSection raised again, their handler gets the original siginfo back
+    std::atomic<uint64_t> RedeliveredSignals{};
+    // The siginfo each deferred signal arrived with
+    siginfo_t DeferredInfo[SignalDelegator::MAX_SIGNALS]{};
   };
 
   thread_local ThreadState ThreadData{};
@@ -62,6 +73,68 @@ namespace FEXCore {
     MaskSignals(SIG_BLOCK);
   }
 
+  static void DeferSignal(int Signal, siginfo_t *Info, ucontext_t *Context) {
+    const uint64_t SignalBit = 1ULL << (Signal - 1);
+
+    // Block it past the return from this handler, the thread's mask when the section is left
+    // is what it was when the signal arrived
+    *reinterpret_cast<uint64_t*>(&Context->uc_sigmask) |= SignalBit;
+    // Also right now because of SA_NODEFER
+    // Any further instance of the signal stays pending in the kernel with its own siginfo
+    ::syscall(SYS_rt_sigprocmask, SIG_BLOCK, &SignalBit, nullptr, sizeof(SignalBit));
+
+    if (!(ThreadData.DeferredSignals.load(std::memory_order_relaxed) & SignalBit)) {
+      ThreadData.DeferredInfo[Signal - 1] = *Info;
+      ThreadData.DeferredSignals.fetch_or(SignalBit);
+    }
+  }
+
+  /**
+   * @brief Swaps the siginfo of a signal raised by LeaveCriticalSection for the one it was deferred with
+   */
+  static void RestoreDeferredInfo(int Signal, siginfo_t *Info) {
+    const uint64_t SignalBit = 1ULL << (Signal - 1);
+    if (!(ThreadData.RedeliveredSignals.load(std::memory_order_relaxed) & SignalBit) ||
+        Info->si_code != SI_TKILL ||
+        Info->si_pid != ::getpid()) {
+      return;
+    }
+
+    ThreadData.RedeliveredSignals.fetch_and(~SignalBit);
+    *Info = ThreadData.DeferredInfo[Signal - 1];
+  }
+
+  void SignalDelegator::EnterCriticalSection() {
+    ++ThreadData.CriticalSectionDepth;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+
+  void SignalDelegator::LeaveCriticalSection() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (--ThreadData.CriticalSectionDepth != 0) {
+      return;
+    }
+
+    // A signal arriving from here on is handled right away, anything before it got recorded
+    if (uint64_t Deferred = ThreadData.DeferredSignals.exchange(0)) {
+      // The handlers need a real signal frame to run on, raise each signal while it is still blocked
+      // and hand the handler the recorded siginfo when the unblock delivers it
+      ThreadData.RedeliveredSignals.fetch_or(Deferred);
+
+      const pid_t PID = ::getpid();
+      const pid_t TID = FHU::Syscalls::gettid();
+      for (uint64_t Pending = Deferred; Pending; Pending &= Pending - 1) {
+        FHU::Syscalls::tgkill(PID, TID, __builtin_ctzll(Pending) + 1);
+      }
+
+      ::syscall(SYS_rt_sigprocmask, SIG_UNBLOCK, &Deferred, nullptr, sizeof(Deferred));
+
+      // Everything that got unblocked was delivered on the way out of the syscall
+      // A raised signal that merged with an instance already pending in the kernel never shows up as ours
+      ThreadData.RedeliveredSignals.store(0);
+    }
+  }
+
   FEXCore::Core::InternalThreadState *SignalDelegator::GetTLSThread() {
     return ThreadData.Thread;
   }
@@ -87,6 +160,14 @@ namespace FEXCore {
   }
 
   void SignalDelegator::HandleSignal(int Signal, void *Info, void *UContext) {
+    RestoreDeferredInfo(Signal, static_cast<siginfo_t*>(Info));
+
+    if (ThreadData.CriticalSectionDepth && !IsSynchronous(Signal)) {
+      // Neither the host nor the guest handlers may run while the thread holds locks that they could need
+      DeferSignal(Signal, static_cast<siginfo_t*>(Info), static_cast<ucontext_t*>(UContext));
+      return;
+    }
+
     // Let the host take first stab at handling the signal
     auto Thread = GetTLSThread();
     HostSignalHandler &Handler = HostHandlers[Signal];
@@ -0,0 +1,506 @@
+/*
+$info$
+tags: glue|block-database
+desc: Background recompilation of hot baseline blocks with the full optimization pipeline
+$end_info$
+*/
+
+#include "Interface/Context/Context.h"
+#include "Interface/Core/LookupCache.h"
+#include "Interface/Core/OpcodeDispatcher.h"
+#include "Interface/Core/SMCPageTracker.h"
+#include "Interface/Core/TierUpService.h"
+#include "Interface/IR/PassManager.h"
+
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/LogManager.h>
+#include <FEXCore/Utils/Threads.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <pthread.h>
+#include <shared_mutex>
+#include <stdio.h>
+
+namespace FEXCore {
+  void *TierUpService::WorkerHandler(void *Arg) {
+    auto *This = reinterpret_cast<Worker*>(Arg);
+    This->Service->WorkerThread(This->CompileThreadData.get());
+    return nullptr;
+  }
+
+  void *TierUpService::SamplerHandler(void *Arg) {
+    reinterpret_cast<TierUpService*>(Arg)->SamplerThread();
+    return nullptr;
+  }
+
+  TierUpService::TierUpService(FEXCore::Context::Context *ctx)
+    : CTX {ctx}
+    , Threshold {ctx->Config.TierUpThreshold()} {
+  }
+
+  TierUpService::~TierUpService() = default;
+
+  void TierUpService::Initialize(FEXCore::Core::InternalThreadState *ParentThread) {
+    CreateThreads(ParentThread);
+  }
+
+  void TierUpService::CreateThreads(FEXCore::Core::InternalThreadState *ParentThread) {
+    uint32_t NumWorkers = std::max<uint32_t>(CTX->Config.TierUpThreads(), 1);
+
+    uint64_t OldMask = FEXCore::Threads::SetSignalMask(~0ULL);
+    for (uint32_t i = 0; i < NumWorkers; ++i) {
+      auto &NewWorker = Workers.emplace_back(std::make_unique<Worker>());
+      NewWorker->Service = this;
+      NewWorker->CompileThreadData = std::make_unique<FEXCore::Core::InternalThreadState>();
+      NewWorker->CompileThreadData->IsCompileService = true;
+
+      // Same as the CompileService, the compiler borrows the parent thread's dispatcher data
+      CTX->InitializeCompiler(NewWorker->CompileThreadData.get(), true);
+      NewWorker->CompileThreadData->CPUBackend->CopyNecessaryDataForCompileThread(ParentThread->CPUBackend.get());
+      // Any guest thread can be executing optimized code, the code buffers are retired instead of rewound
+      NewWorker->CompileThreadData->CPUBackend->SetSharedCode(true);
+
+      NewWorker->Thread = FEXCore::Threads::Thread::Create(WorkerHandler, NewWorker.get());
+    }
+
+    Sampler = FEXCore::Threads::Thread::Create(SamplerHandler, this);
+    FEXCore::Threads::SetSignalMask(OldMask);
+  }
+
+  void TierUpService::Shutdown() {
+    {
+      std::scoped_lock lk(QueueMutex);
+      ShuttingDown = true;
+    }
+    WorkAvailable.notify_all();
+    SamplerWake.notify_all();
+
+    Sampler->join(nullptr);
+    for (auto &It : Workers) {
+      It->Thread->join(nullptr);
+    }
+  }
+
+  void TierUpService::CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread) {
+    // None of our threads survived the fork, they could have been holding any of the locks
+    new (&QueueMutex) std::mutex{};
+    new (&WorkAvailable) std::condition_variable{};
+    new (&SamplerWake) std::condition_variable{};
+    new (&ThreadsMutex) std::mutex{};
+    new (&IndirectBranchMutex) std::shared_mutex{};
+
+    // The live thread can still be linked to optimized code from the dead workers, leak their code buffers
+    for (auto &It : Workers) {
+      [[maybe_unused]] auto Thread = It->Thread.release();
+      [[maybe_unused]] auto CompileThreadData = It->CompileThreadData.release();
+    }
+    Workers.clear();
+    [[maybe_unused]] auto SamplerThread = Sampler.release();
+
+    while (!WorkQueue.empty()) {
+      WorkQueue.pop();
+    }
+
+    // Only the live thread's data is still referenced
+    ThreadData.clear();
+
+    if (auto Data = LiveThread->TierUpData) {
+      new (&Data->Mutex) std::mutex{};
+      Data->InFlight = 0;
+      Data->FlushedRanges.clear();
+
+      // Anything that was queued died with the workers, let the sampler pick it up again
+      for (size_t i = Data->FirstLiveBlock; i < Data->BlocksEnd(); ++i) {
+        Data->GetBlock(i).Queued = false;
+      }
+
+      ThreadData.emplace_back(Data);
+    }
+
+    CreateThreads(LiveThread);
+  }
+
+  void TierUpService::RegisterThread(FEXCore::Core::InternalThreadState *Thread) {
+    Thread->TierUpData = std::make_shared<TierUpThreadData>();
+    Thread->TierUpData->Frame = Thread->CurrentFrame;
+
+    std::scoped_lock lk(ThreadsMutex);
+    ThreadData.emplace_back(Thread->TierUpData);
+  }
+
+  void TierUpService::UnregisterThread(FEXCore::Core::InternalThreadState *Thread) {
+    if (!Thread->TierUpData) {
+      return;
+    }
+
+    // Work items can still reference the data, make sure the workers don't touch the thread's code anymore
+    ClearCodeCache(Thread);
+
+    {
+      // The sampler can still hold the data, the frame goes away with the thread
+      std::scoped_lock lk(Thread->TierUpData->Mutex);
+      Thread->TierUpData->Frame = nullptr;
+    }
+    Thread->TierUpData.reset();
+  }
+
+  TierUpThreadData::Block *TierUpService::AllocateBlock(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP) {
+    auto Data = Thread->TierUpData.get();
+
+    std::scoped_lock lk(Data->Mutex);
+    auto &Block = Data->Blocks.emplace_back();
+    Block.GuestRIP = GuestRIP;
+    return &Block;
+  }
+
+  void TierUpService::BlockCompiled(FEXCore::Core::InternalThreadState *Thread, TierUpThreadData::Block *Block, void *CodePtr) {
+    auto Data = Thread->TierUpData.get();
+
+    std::scoped_lock lk(Data->Mutex);
+    Block->BaselineCode = reinterpret_cast<uintptr_t>(CodePtr);
+  }
+
+  void TierUpService::InstallCompletedBlocksSlow(FEXCore::Core::InternalThreadState *Thread) {
+    auto Data = Thread->TierUpData.get();
+    std::vector<TierUpThreadData::CompletedBlock> Completed;
+
+    {
+      std::scoped_lock lk(Data->Mutex);
+      Completed.swap(Data->Completed);
+      Data->HasCompleted = false;
+    }
+
+    // The worker protected the guest pages before it redirected the baseline block
+    for (auto &Block : Completed) {
+      Thread->LookupCache->UpdateBlockMapping(Block.GuestRIP, Block.BaselineCode, Block.HostCode, Block.StartAddr, Block.Length);
+    }
+  }
+
+  void TierUpService::RevertRetiredBlocks(FEXCore::Core::InternalThreadState *Thread) {
+    auto Data = Thread->TierUpData.get();
+    if (!Data) {
+      return;
+    }
+
+    std::vector<TierUpThreadData::CompletedBlock> Retired;
+    {
+      std::scoped_lock lk(Data->Mutex);
+      Retired.swap(Data->Retired);
+    }
+
+    for (auto &Block : Retired) {
+      Thread->LookupCache->UpdateBlockMapping(Block.GuestRIP, reinterpret_cast<uintptr_t>(Block.HostCode), reinterpret_cast<void*>(Block.BaselineCode), Block.StartAddr, Block.Length);
+    }
+  }
+
+  bool TierUpService::IsWorker(FEXCore::Core::InternalThreadState const *Thread) const {
+    return std::any_of(Workers.begin(), Workers.end(), [Thread](auto const &It) {
+      return It->CompileThreadData.get() == Thread;
+    });
+  }
+
+  void TierUpService::RetireWorkerCode(FEXCore::Core::InternalThreadState *CompileThreadData) {
+    auto Backend = CompileThreadData->CPUBackend.get();
+
+    std::scoped_lock lk(ThreadsMutex);
+    for (auto &Entry : ThreadData) {
+      auto Data = Entry.lock();
+      if (!Data) {
+        continue;
+      }
+
+      std::scoped_lock DataLock(Data->Mutex);
+      for (size_t i = Data->FirstLiveBlock; i < Data->BlocksEnd(); ++i) {
+        auto &Block = Data->GetBlock(i);
+        if (!Block.Instrumentation.EntryTarget) {
+          continue;
+        }
+
+        auto EntryTarget = std::atomic_ref<uint64_t>(*Block.Instrumentation.EntryTarget);
+        const uint64_t HostCode = EntryTarget.load(std::memory_order_relaxed);
+        if (!Backend->IsAddressInJITCode(HostCode, false, false)) {
+          continue;
+        }
+
+        // The baseline code continues right after its entry pointer
+        EntryTarget.store(reinterpret_cast<uint64_t>(Block.Instrumentation.EntryTarget + 1), std::memory_order_release);
+        Block.Queued = false;
+        // The baseline block's pages are already tracked, only its entry page is passed on
+        Data->Retired.push_back({Block.GuestRIP, Block.BaselineCode, reinterpret_cast<void*>(HostCode), Block.GuestRIP, 0});
+      }
+
+      // Never installed, the redirect was all that referenced them
+      std::erase_if(Data->Completed, [Backend](auto const &Block) {
+        return Backend->IsAddressInJITCode(reinterpret_cast<uint64_t>(Block.HostCode), false, false);
+      });
+    }
+  }
+
+  void TierUpService::FlushCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length) {
+    {
+      // Whatever is at these branches now hasn't been sampled
+      std::unique_lock lk(IndirectBranchMutex);
+      std::erase_if(IndirectBranches, [Start, Length](auto const &Branch) {
+        return Branch.first >= Start && Branch.first < (Start + Length);
+      });
+    }
+
+    auto Data = Thread->TierUpData.get();
+    if (!Data) {
+      return;
+    }
+
+    std::scoped_lock lk(Data->Mutex);
+    if (Data->InFlight) {
+      Data->FlushedRanges.emplace_back(Start, Length);
+    }
+  }
+
+  void TierUpService::ClearCodeCache(FEXCore::Core::InternalThreadState *Thread) {
+    if (IsWorker(Thread)) {
+      // The backend retires the code next, nothing may enter it through a baseline block anymore
+      RetireWorkerCode(Thread);
+      return;
+    }
+
+    auto Data = Thread->TierUpData.get();
+    if (!Data) {
+      return;
+    }
+
+    std::scoped_lock lk(Data->Mutex);
+    Data->FirstLiveBlock = Data->BlocksEnd();
+    Data->Completed.clear();
+    Data->Retired.clear();
+    Data->HasCompleted = false;
+
+    if (!Thread->CPUBackend->IsInSignalHandler()) {
+      // The backend frees the old code now, nothing counts in to the dead blocks anymore
+      // Inside a signal handler the interrupted code is kept alive and so are its blocks, until the next clear
+      while (Data->BlocksBase < Data->FirstLiveBlock) {
+        Data->Blocks.pop_front();
+        ++Data->BlocksBase;
+      }
+    }
+  }
+
+  bool TierUpService::IsAddressInJITCode(uint64_t Address) const {
+    for (auto &It : Workers) {
+      if (It->CompileThreadData->CPUBackend->IsAddressInJITCode(Address, false, false)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  std::vector<uint64_t> TierUpService::GetIndirectBranchTargets(uint64_t Site) {
+    std::vector<IndirectTarget> Candidates;
+    {
+      std::shared_lock lk(IndirectBranchMutex);
+      auto it = IndirectBranches.find(Site);
+      if (it == IndirectBranches.end()) {
+        return {};
+      }
+      Candidates = it->second;
+    }
+
+    std::sort(Candidates.begin(), Candidates.end(), [](auto const &a, auto const &b) {
+      return a.Samples > b.Samples;
+    });
+
+    std::vector<uint64_t> Targets;
+    for (size_t i = 0; i < std::min(Candidates.size(), MAX_INDIRECT_TARGETS); ++i) {
+      Targets.emplace_back(Candidates[i].Target);
+    }
+    return Targets;
+  }
+
+  void TierUpService::SampleIndirectBranches(TierUpThreadData *Data) {
+    std::unique_lock lk(IndirectBranchMutex);
+
+    for (auto &Entry : Data->Frame->IndirectBranchProfile) {
+      // The guest thread writes the entries without atomics, branches sharing an entry can get their targets mixed up
+      // That only costs a compare that never matches in the optimized code
+      auto Count = std::atomic_ref<uint64_t>(Entry.Count);
+      if (Count.load(std::memory_order_relaxed) < INDIRECT_BRANCH_MIN_COUNT) {
+        continue;
+      }
+      Count.store(0, std::memory_order_relaxed);
+
+      auto &Candidates = IndirectBranches[std::atomic_ref<uint64_t>(Entry.Site).load(std::memory_order_relaxed)];
+      for (auto &EntryTarget : Entry.Targets) {
+        const uint64_t Target = std::atomic_ref<uint64_t>(EntryTarget).load(std::memory_order_relaxed);
+        auto it = std::find_if(Candidates.begin(), Candidates.end(), [Target](auto const &Candidate) {
+          return Candidate.Target == Target;
+        });
+
+        if (it != Candidates.end()) {
+          ++it->Samples;
+        }
+        else if (Candidates.size() < MAX_INDIRECT_CANDIDATES) {
+          Candidates.emplace_back(IndirectTarget{Target, 1});
+        }
+      }
+    }
+  }
+
+  void TierUpService::SamplerThread() {
+    pthread_setname_np(pthread_self(), "TierUpSampler");
+
+    std::vector<WorkItem> HotBlocks;
+
+    while (true) {
+      {
+        std::unique_lock lk(QueueMutex);
+        SamplerWake.wait_for(lk, SAMPLE_INTERVAL, [this] { return ShuttingDown.load(); });
+        if (ShuttingDown.load()) {
+          break;
+        }
+      }
+
+      {
+        std::scoped_lock lk(ThreadsMutex);
+        std::erase_if(ThreadData, [](const auto &Entry) { return Entry.expired(); });
+
+        for (auto &Entry : ThreadData) {
+          auto Data = Entry.lock();
+          if (!Data) {
+            continue;
+          }
+
+          std::scoped_lock DataLock(Data->Mutex);
+          if (Data->Frame) {
+            // Before queueing anything so the optimized blocks already see the branch targets
+            SampleIndirectBranches(Data.get());
+          }
+
+          for (size_t i = Data->FirstLiveBlock; i < Data->BlocksEnd(); ++i) {
+            auto &Block = Data->GetBlock(i);
+            if (Block.Queued || !Block.BaselineCode) {
+              continue;
+            }
+
+            // The baseline code increments this without atomics, the count is only a heuristic
+            auto Count = std::atomic_ref<uint64_t>(Block.Instrumentation.ExecutionCount).load(std::memory_order_relaxed);
+            if (Count >= Threshold) {
+              Block.Queued = true;
+              HotBlocks.push_back({Data, i, Block.GuestRIP});
+            }
+          }
+        }
+      }
+
+      if (!HotBlocks.empty()) {
+        {
+          std::scoped_lock lk(QueueMutex);
+          for (auto &Item : HotBlocks) {
+            WorkQueue.push(std::move(Item));
+          }
+        }
+        HotBlocks.clear();
+        WorkAvailable.notify_all();
+      }
+    }
+  }
+
+  void TierUpService::WorkerThread(FEXCore::Core::InternalThreadState *CompileThreadData) {
+    pthread_setname_np(pthread_self(), "TierUp");
+
+    while (true) {
+      WorkItem Item{};
+      {
+        std::unique_lock lk(QueueMutex);
+        WorkAvailable.wait(lk, [this] { return ShuttingDown.load() || !WorkQueue.empty(); });
+        if (ShuttingDown.load()) {
+          break;
+        }
+
+        Item = std::move(WorkQueue.front());
+        WorkQueue.pop();
+      }
+
+      CompileWorkItem(CompileThreadData, Item);
+    }
+  }
+
+  void TierUpService::CompileWorkItem(FEXCore::Core::InternalThreadState *CompileThreadData, WorkItem &Item) {
+    auto Data = Item.Data.get();
+    size_t FirstFlushedRange{};
+
+    {
+      std::scoped_lock lk(Data->Mutex);
+      if (Item.BlockIndex < Data->FirstLiveBlock) {
+        // Code was cleared while this was in the queue
+        return;
+      }
+
+      ++Data->InFlight;
+      FirstFlushedRange = Data->FlushedRanges.size();
+    }
+
+    CompileThreadData->CurrentFrame->State.rip = Item.GuestRIP;
+
+    auto [CodePtr, IRList, DebugData, RAData, GeneratedIR, StartAddr, Length] = CTX->CompileCode(CompileThreadData, Item.GuestRIP);
+
+    if (CodePtr) {
+      CTX->RegisterBlockJITNaming(Item.GuestRIP, CodePtr, DebugData);
+      CTX->IRCaptureCache.PostCompileCode(
+        CompileThreadData,
+        CodePtr,
+        Item.GuestRIP,
+        StartAddr,
+        Length,
+        RAData,
+        IRList,
+        DebugData,
+        GeneratedIR,
+        false);
+    }
+
+    std::scoped_lock lk(Data->Mutex);
+    --Data->InFlight;
+
+    bool Flushed = std::any_of(Data->FlushedRanges.begin() + FirstFlushedRange, Data->FlushedRanges.end(), [&](auto const &Range) {
+      return Range.first < (StartAddr + Length) && StartAddr < (Range.first + Range.second);
+    });
+
+    if (Data->InFlight == 0) {
+      Data->FlushedRanges.clear();
+    }
+
+    if (Item.BlockIndex < Data->FirstLiveBlock) {
+      // The baseline code is gone, it must not be patched anymore
+      return;
+    }
+
+    auto &Block = Data->GetBlock(Item.BlockIndex);
+    if (!CodePtr) {
+      // Leave it queued, it isn't going to compile any better the next time
+      return;
+    }
+
+    if (Flushed) {
+      // Guest code changed underneath us, try again when it gets hot again
+      Block.Queued = false;
+      return;
+    }
+
+    if (CTX->SMCTracker) {
+      // The optimized code can cover more guest pages than the baseline block, they have to fault before anything runs it
+      CTX->SMCTracker->ProtectCodeRange(StartAddr, Length);
+    }
+
+    // Redirect the baseline block, this takes effect immediately even for branches that are already linked to it
+    std::atomic_ref<uint64_t>(*Block.Instrumentation.EntryTarget).store(reinterpret_cast<uint64_t>(CodePtr), std::memory_order_release);
+
+    Data->Completed.push_back({Item.GuestRIP, Block.BaselineCode, CodePtr, StartAddr, Length});
+    Data->HasCompleted = true;
+  }
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/Threads.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FEXCore {
+namespace Context {
+  struct Context;
+}
+
+/**
+ * @brief Tier-up bookkeeping of a single guest thread
+ *
+ * Owned by the guest thread, the TierUpService's threads only hold a reference while working on it.
+ */
+struct TierUpThreadData {
+  struct Block {
+    // Baseline code points directly in to this, so Blocks must never move
+    FEXCore::CPU::TierUpInstrumentation Instrumentation{};
+    uint64_t GuestRIP{};
+    // Zero until the baseline compile finished
+    uintptr_t BaselineCode{};
+    bool Queued{};
+  };
+
+  struct CompletedBlock {
+    uint64_t GuestRIP;
+    uintptr_t BaselineCode;
+    void *HostCode;
+    uint64_t StartAddr;
+    uint64_t Length;
+  };
+
+  // Protects everything below
+  std::mutex Mutex{};
+
+  // The guest thread's frame for sampling its indirect branch profile, cleared once the thread is gone
+  FEXCore::Core::CpuStateFrame *Frame{};
+
+  // Indexed from the first block the thread ever allocated, Blocks.front() is at BlocksBase
+  std::deque<Block> Blocks{};
+  size_t BlocksBase{};
+  // Blocks before this index belong to code that was cleared, they are never touched again
+  size_t FirstLiveBlock{};
+
+  size_t BlocksEnd() const { return BlocksBase + Blocks.size(); }
+  Block &GetBlock(size_t Index) { return Blocks[Index - BlocksBase]; }
+
+  // Guest ranges flushed while workers were compiling for this thread
+  // Optimized code that overlaps any of them is thrown away
+  uint32_t InFlight{};
+  std::vector<std::pair<uint64_t, uint64_t>> FlushedRanges{};
+
+  // Optimized blocks that the guest thread still needs to insert in to its LookupCache
+  std::vector<CompletedBlock> Completed{};
+  std::atomic_bool HasCompleted{};
+
+  // Installed blocks whose optimized code a worker retired, the guest thread maps them back to their baseline code
+  std::vector<CompletedBlock> Retired{};
+};
+
+/**
+ * @brief Recompiles hot baseline blocks with the full optimization pipeline on background threads
+ *
+ * Guest threads compile with a baseline tier that skips the optimization passes and multiblock.
+ * Each baseline block counts its executions and enters through a patchable pointer.
+ * A sampler thread periodically queues blocks that crossed TierUpThreshold, the worker threads
+ * compile them and then redirect the baseline block's entry to the optimized code.
+ *
+ * The guest thread picks up the optimized blocks in its LookupCache the next time it is in the
+ * compiler or flushes code, until then it reaches them through the redirected baseline entry.
+ *
+ * A worker whose code buffer fills up retires its code through the CodeInvalidationService. The baseline entries
+ * are pointed back at the baseline code first, the memory is reused once every guest thread passed a safe point.
+ *
+ * Baseline blocks also record the targets of their indirect jumps and calls in the frame's IndirectBranchProfile.
+ * The sampler collects them per branch, the optimized code compares against the hottest targets and
+ * continues in to them directly instead of going through the lookup.
+ */
+class TierUpService final {
+  public:
+    TierUpService(FEXCore::Context::Context *ctx);
+    ~TierUpService();
+
+    /**
+     * @brief Creates the worker and sampler threads
+     *
+     * @param ParentThread The first guest thread, the workers copy its JIT data so it must outlive the service
+     */
+    void Initialize(FEXCore::Core::InternalThreadState *ParentThread);
+    void Shutdown();
+
+    /**
+     * @brief Drops threads that died with the fork and restarts the service for the live thread
+     */
+    void CleanupAfterFork(FEXCore::Core::InternalThreadState *LiveThread);
+
+    void RegisterThread(FEXCore::Core::InternalThreadState *Thread);
+    void UnregisterThread(FEXCore::Core::InternalThreadState *Thread);
+
+    /**
+     * @brief Allocates the instrumentation for a baseline block that is about to be compiled
+     */
+    TierUpThreadData::Block *AllocateBlock(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP);
+    void BlockCompiled(FEXCore::Core::InternalThreadState *Thread, TierUpThreadData::Block *Block, void *CodePtr);
+
+    /**
+     * @brief Inserts blocks optimized by the workers in to the thread's LookupCache
+     *
+     * Must be called from the guest thread that owns the LookupCache
+     */
+    void InstallCompletedBlocks(FEXCore::Core::InternalThreadState *Thread) {
+      if (Thread->TierUpData && Thread->TierUpData->HasCompleted.load(std::memory_order_relaxed)) {
+        InstallCompletedBlocksSlow(Thread);
+      }
+    }
+
+    /**
+     * @brief Throws away optimized code that workers are still compiling from this guest range
+     */
+    void FlushCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length);
+
+    /**
+     * @brief The thread's code buffers are about to be cleared, none of its baseline blocks may be patched anymore
+     */
+    void ClearCodeCache(FEXCore::Core::InternalThreadState *Thread);
+
+    /**
+     * @brief Maps the thread's blocks whose optimized code got retired back to their baseline code
+     *
+     * Must be called from the guest thread that owns the LookupCache, at its safe point after the retirement
+     */
+    void RevertRetiredBlocks(FEXCore::Core::InternalThreadState *Thread);
+
+    bool IsAddressInJITCode(uint64_t Address) const;
+
+    // Most targets that the optimized code checks for a single indirect branch
+    constexpr static size_t MAX_INDIRECT_TARGETS = 4;
+
+    /**
+     * @brief The sampled targets of the indirect branch at Site, most sampled first
+     */
+    std::vector<uint64_t> GetIndirectBranchTargets(uint64_t Site);
+
+    /**
+     * @brief Entry of the frame's IndirectBranchProfile that the branch at Site records in to
+     */
+    static size_t GetIndirectBranchProfileIndex(uint64_t Site) {
+      return (Site ^ (Site >> 12)) & (FEXCore::Core::INDIRECT_BRANCH_PROFILE_ENTRIES - 1);
+    }
+
+  private:
+    constexpr static auto SAMPLE_INTERVAL = std::chrono::milliseconds(10);
+    // Branches that ran less often since the last sample don't get sampled
+    constexpr static uint64_t INDIRECT_BRANCH_MIN_COUNT = 64;
+    // Targets tracked per branch, new ones are ignored once it is full
+    constexpr static size_t MAX_INDIRECT_CANDIDATES = 8;
+
+    struct IndirectTarget {
+      uint64_t Target;
+      uint64_t Samples;
+    };
+
+    struct WorkItem {
+      std::shared_ptr<TierUpThreadData> Data;
+      size_t BlockIndex;
+      uint64_t GuestRIP;
+    };
+
+    struct Worker {
+      TierUpService *Service;
+      std::unique_ptr<FEXCore::Core::InternalThreadState> CompileThreadData;
+      std::unique_ptr<FEXCore::Threads::Thread> Thread;
+    };
+
+    static void *WorkerHandler(void *Arg);
+    static void *SamplerHandler(void *Arg);
+    void WorkerThread(FEXCore::Core::InternalThreadState *CompileThreadData);
+    void SamplerThread();
+
+    void CreateThreads(FEXCore::Core::InternalThreadState *ParentThread);
+    void InstallCompletedBlocksSlow(FEXCore::Core::InternalThreadState *Thread);
+    bool IsWorker(FEXCore::Core::InternalThreadState const *Thread) const;
+    void RetireWorkerCode(FEXCore::Core::InternalThreadState *CompileThreadData);
+    void CompileWorkItem(FEXCore::Core::InternalThreadState *CompileThreadData, WorkItem &Item);
+    void SampleIndirectBranches(TierUpThreadData *Data);
+
+    FEXCore::Context::Context *CTX;
+    uint64_t Threshold;
+
+    std::vector<std::unique_ptr<Worker>> Workers;
+    std::unique_ptr<FEXCore::Threads::Thread> Sampler;
+    std::atomic_bool ShuttingDown{false};
+
+    // Protects the work queue, also used for waking up the sampler early on shutdown
+    std::mutex QueueMutex{};
+    std::condition_variable WorkAvailable{};
+    std::condition_variable SamplerWake{};
+    std::queue<WorkItem> WorkQueue{};
+
+    std::mutex ThreadsMutex{};
+    std::vector<std::weak_ptr<TierUpThreadData>> ThreadData{};
+
+    // Written by the sampler, read by the compilers
+    std::shared_mutex IndirectBranchMutex{};
+    std::unordered_map<uint64_t, std::vector<IndirectTarget>> IndirectBranches{};
+};
+}
@@ -1,12 +1,18 @@
 #include "Interface/Context/Context.h"
 #include "Interface/IR/AOTIR.h"
+#include "Interface/IR/CompactIR.h"
 
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Debug/InternalThreadState.h>
 #include <FEXCore/IR/IntrusiveIRList.h>
 #include <FEXCore/IR/RegisterAllocationData.h>
 #include <FEXCore/Utils/Allocator.h>
 
+#include "git_version.h"
+
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <mutex>
@@ -22,7 +28,7 @@ namespace FEXCore::IR {
     return (AOTIRInlineEntry*)(This + DataBase + DataOffset);
   }
 
-  AOTIRInlineEntry *AOTIRInlineIndex::Find(uint64_t GuestStart) {
+  AOTIRInlineIndexEntry *AOTIRInlineIndex::FindIndexEntry(uint64_t GuestStart) {
     ssize_t l = 0;
     ssize_t r = Count - 1;
 
@@ -30,7 +36,7 @@ namespace FEXCore::IR {
       size_t m = l + (r - l) / 2;
 
       if (Entries[m].GuestStart == GuestStart)
-        return GetInlineEntry(Entries[m].DataOffset);
+        return &Entries[m];
       else if (Entries[m].GuestStart < GuestStart)
         l = m + 1;
       else
@@ -40,6 +46,33 @@ namespace FEXCore::IR {
     return nullptr;
   }
 
+  AOTIRInlineEntry *AOTIRInlineIndex::Find(uint64_t GuestStart) {
+    auto IndexEntry = FindIndexEntry(GuestStart);
+    if (!IndexEntry) {
+      return nullptr;
+    }
+
+    return GetInlineEntry(IndexEntry->DataOffset);
+  }
+
+  AOTCodeInlineEntry *AOTIRInlineIndex::FindCode(uint64_t GuestStart) {
+    auto IndexEntry = FindIndexEntry(GuestStart);
+    if (!IndexEntry) {
+      return nullptr;
+    }
+
+    uintptr_t This = (uintptr_t)this;
+    return (AOTCodeInlineEntry*)(This + DataBase + IndexEntry->DataOffset);
+  }
+
+  FEXCore::CPU::Relocation *AOTCodeInlineEntry::GetRelocations() {
+    return (FEXCore::CPU::Relocation *)InlineData;
+  }
+
+  uint8_t *AOTCodeInlineEntry::GetHostCode() {
+    return &InlineData[RelocationCount * sizeof(FEXCore::CPU::Relocation)];
+  }
+
   IR::RegisterAllocationData *AOTIRInlineEntry::GetRAData() {
     return (IR::RegisterAllocationData *)InlineData;
   }
@@ -51,10 +84,12 @@ namespace FEXCore::IR {
     return (IR::IRListView *)&InlineData[Offset];
   }
 
-  void AOTIRCaptureCacheEntry::AppendAOTIRCaptureCache(uint64_t GuestRIP, uint64_t Start, uint64_t Length, uint64_t Hash, FEXCore::IR::IRListView *IRList, FEXCore::IR::RegisterAllocationData *RAData) {
+  void AOTIRCaptureCacheEntry::AppendAOTIRCaptureCache(uint64_t GuestRIP, uint64_t Start, uint64_t Length, uint64_t Hash, std::vector<uint8_t> const &PackedIR) {
     auto Inserted = Index.emplace(GuestRIP, Stream->tellp());
 
     if (Inserted.second) {
+      auto [IRList, RAData] = FEXCore::IR::UnpackIR(PackedIR);
+
       //GuestHash
       Stream->write((const char*)&Hash, sizeof(Hash));
 
@@ -68,6 +103,29 @@ namespace FEXCore::IR {
     }
   }
 
+  void AOTIRCaptureCacheEntry::AppendAOTCodeCaptureCache(uint64_t GuestRIP, int64_t GuestStartOffset, uint64_t Length, uint64_t Hash, std::vector<uint8_t> const &HostCode, std::vector<FEXCore::CPU::Relocation> const &Relocations) {
+    // Keep the host code aligned in the file so it can be copied straight out of the mapping
+    constexpr char Zero = 0;
+    while(Stream->tellp() & 15)
+      Stream->write(&Zero, 1);
+
+    auto Inserted = Index.emplace(GuestRIP, Stream->tellp());
+
+    if (Inserted.second) {
+      const uint64_t HostCodeSize = HostCode.size();
+      const uint64_t RelocationCount = Relocations.size();
+
+      Stream->write((const char*)&Hash, sizeof(Hash));
+      Stream->write((const char*)&Length, sizeof(Length));
+      Stream->write((const char*)&GuestStartOffset, sizeof(GuestStartOffset));
+      Stream->write((const char*)&HostCodeSize, sizeof(HostCodeSize));
+      Stream->write((const char*)&RelocationCount, sizeof(RelocationCount));
+
+      Stream->write((const char*)Relocations.data(), RelocationCount * sizeof(FEXCore::CPU::Relocation));
+      Stream->write((const char*)HostCode.data(), HostCodeSize);
+    }
+  }
+
   static bool readAll(int fd, void *data, size_t size) {
     int rv = read(fd, data, size);
 
@@ -77,12 +135,7 @@ namespace FEXCore::IR {
       return true;
   }
 
-  bool LoadAOTIRCache(AOTCacheType *AOTIRCache, int streamfd) {
-    uint64_t tag;
-
-    if (!readAll(streamfd, (char*)&tag, sizeof(tag)) || tag != FEXCore::IR::AOTIR_COOKIE)
-      return false;
-
+  static bool LoadCacheIndex(AOTCacheType *Cache, int streamfd, const char *CacheName) {
     std::string Module;
     uint64_t ModSize;
     uint64_t IndexSize;
@@ -119,17 +172,52 @@ namespace FEXCore::IR {
 
     auto Array = (AOTIRInlineIndex *)((char*)FilePtr + IndexOffset);
 
-    AOTIRCache->insert({Module, {Array, FilePtr, Size}});
+    Cache->insert({Module, {Array, FilePtr, Size}});
 
-    LogMan::Msg::DFmt("AOTIR: Module {} has {} functions", Module, Array->Count);
+    LogMan::Msg::DFmt("{}: Module {} has {} functions", CacheName, Module, Array->Count);
 
     return true;
   }
 
+  bool LoadAOTIRCache(AOTCacheType *AOTIRCache, int streamfd) {
+    uint64_t tag;
+
+    if (!readAll(streamfd, (char*)&tag, sizeof(tag)) || tag != FEXCore::IR::AOTIR_COOKIE)
+      return false;
+
+    return LoadCacheIndex(AOTIRCache, streamfd, "AOTIR");
+  }
+
+  bool LoadAOTCodeCache(AOTCacheType *AOTCodeCache, int streamfd, uint64_t BuildHash) {
+    uint64_t tag;
+    uint64_t FileBuildHash;
+
+    if (!readAll(streamfd, (char*)&tag, sizeof(tag)) || tag != FEXCore::IR::AOTCODE_COOKIE)
+      return false;
+
+    // Host code is only valid for the exact FEX build and host that generated it
+    if (!readAll(streamfd, (char*)&FileBuildHash, sizeof(FileBuildHash)) || FileBuildHash != BuildHash) {
+      LogMan::Msg::DFmt("AOTCode: Ignoring cache from a different FEX build");
+      return false;
+    }
+
+    return LoadCacheIndex(AOTCodeCache, streamfd, "AOTCode");
+  }
+
+  AOTIRCaptureCache::AOTIRCaptureCache(FEXCore::Context::Context *ctx)
+    : CTX {ctx} {
+    AOTCodeBuildHash = XXH3_64bits(GIT_DESCRIBE_STRING, strlen(GIT_DESCRIBE_STRING));
+    AOTCodeBuildHash = XXH3_64bits_withSeed(&CTX->HostFeatures, sizeof(CTX->HostFeatures), AOTCodeBuildHash);
+  }
+
   AOTIRCaptureCache::~AOTIRCaptureCache() {
     for (auto &Mod: AOTIRCache) {
       FEXCore::Allocator::munmap(Mod.second.mapping, Mod.second.size);
     }
+
+    for (auto &Mod: AOTCodeCache) {
+      FEXCore::Allocator::munmap(Mod.second.mapping, Mod.second.size);
+    }
   }
 
   void AOTIRCaptureCache::FinalizeAOTIRCache() {
@@ -137,47 +225,50 @@ namespace FEXCore::IR {
 
     std::unique_lock lk(AOTIRCacheLock);
 
-    for (auto& [String, Entry] : AOTIRCaptureCacheMap) {
-      if (!Entry.Stream) {
-        continue;
-      }
+    // Both caches share the same index layout at the end of the file
+    for (auto CaptureMap : {&AOTIRCaptureCacheMap, &AOTCodeCaptureCacheMap}) {
+      for (auto& [String, Entry] : *CaptureMap) {
+        if (!Entry.Stream) {
+          continue;
+        }
 
-      const auto ModSize = String.size();
-      auto &stream = Entry.Stream;
+        const auto ModSize = String.size();
+        auto &stream = Entry.Stream;
 
-      // pad to 32 bytes
-      constexpr char Zero = 0;
-      while(stream->tellp() & 31)
-        stream->write(&Zero, 1);
+        // pad to 32 bytes
+        constexpr char Zero = 0;
+        while(stream->tellp() & 31)
+          stream->write(&Zero, 1);
 
-      // AOTIRInlineIndex
-      const auto FnCount = Entry.Index.size();
-      const size_t DataBase = -stream->tellp();
+        // AOTIRInlineIndex
+        const auto FnCount = Entry.Index.size();
+        const size_t DataBase = -stream->tellp();
 
-      stream->write((const char*)&FnCount, sizeof(FnCount));
-      stream->write((const char*)&DataBase, sizeof(DataBase));
+        stream->write((const char*)&FnCount, sizeof(FnCount));
+        stream->write((const char*)&DataBase, sizeof(DataBase));
 
-      for (const auto& [GuestStart, DataOffset] : Entry.Index) {
-        //AOTIRInlineIndexEntry
+        for (const auto& [GuestStart, DataOffset] : Entry.Index) {
+          //AOTIRInlineIndexEntry
 
-        // GuestStart
-        stream->write((const char*)&GuestStart, sizeof(GuestStart));
+          // GuestStart
+          stream->write((const char*)&GuestStart, sizeof(GuestStart));
 
-        // DataOffset
-        stream->write((const char*)&DataOffset, sizeof(DataOffset));
-      }
+          // DataOffset
+          stream->write((const char*)&DataOffset, sizeof(DataOffset));
+        }
 
-      // End of file header
-      const auto IndexSize = FnCount * sizeof(FEXCore::IR::AOTIRInlineIndexEntry) + sizeof(DataBase) + sizeof(FnCount);
-      stream->write((const char*)&IndexSize, sizeof(IndexSize));
-      stream->write(String.c_str(), ModSize);
-      stream->write((const char*)&ModSize, sizeof(ModSize));
+        // End of file header
+        const auto IndexSize = FnCount * sizeof(FEXCore::IR::AOTIRInlineIndexEntry) + sizeof(DataBase) + sizeof(FnCount);
+        stream->write((const char*)&IndexSize, sizeof(IndexSize));
+        stream->write(String.c_str(), ModSize);
+        stream->write((const char*)&ModSize, sizeof(ModSize));
 
-      // Close the stream
-      stream->close();
+        // Close the stream
+        stream->close();
 
-      // Rename the file to atomically update the cache with the temporary file
-      AOTIRRenamer(String);
+        // Rename the file to atomically update the cache with the temporary file
+        AOTIRRenamer(String);
+      }
     }
   }
 
@@ -313,6 +404,31 @@ namespace FEXCore::IR {
           CTX->Symbols.RegisterNamedRegion(CodePtr, DebugData->HostCodeSize, file->second.filename);
         }
 
+        // Add to AOT code cache if the backend gave us relocatable code
+        if (GeneratedIR && DebugData && DebugData->Relocatable && CTX->Config.AOTCodeCapture()) {
+          auto hash = XXH3_64bits((void*)StartAddr, Length);
+
+          auto LocalRIP = GuestRIP - file->second.Start + file->second.Offset;
+          int64_t GuestStartOffset = StartAddr - GuestRIP;
+
+          // Copy the code now, the code buffer can be cleared and block linking modifies it before the writeout happens
+          auto HostCodeStart = reinterpret_cast<const uint8_t*>(CodePtr);
+          std::vector<uint8_t> HostCode(HostCodeStart, HostCodeStart + DebugData->HostCodeSize);
+          auto Relocations = DebugData->Relocations;
+          auto fileid = GetCodeFileID(file->second.fileid);
+          AOTIRCaptureCacheWriteoutQueue_Append([this, LocalRIP, GuestStartOffset, Length, hash, HostCode, Relocations, fileid]() {
+            auto *AotFile = &AOTCodeCaptureCacheMap[fileid];
+
+            if (!AotFile->Stream) {
+              AotFile->Stream = AOTIRWriter(fileid);
+              uint64_t tag = FEXCore::IR::AOTCODE_COOKIE;
+              AotFile->Stream->write((char*)&tag, sizeof(tag));
+              AotFile->Stream->write((char*)&AOTCodeBuildHash, sizeof(AOTCodeBuildHash));
+            }
+            AotFile->AppendAOTCodeCaptureCache(LocalRIP, GuestStartOffset, Length, hash, HostCode, Relocations);
+          });
+        }
+
         // Add to AOT cache if aot generation is enabled
         if (GeneratedIR && RAData &&
             (CTX->Config.AOTIRCapture() || CTX->Config.AOTIRGenerate())) {
@@ -322,7 +438,11 @@ namespace FEXCore::IR {
           auto LocalRIP = GuestRIP - file->second.Start + file->second.Offset;
           auto LocalStartAddr = StartAddr - file->second.Start + file->second.Offset;
           auto fileid = file->second.fileid;
-          AOTIRCaptureCacheWriteoutQueue_Append([this, LocalRIP, LocalStartAddr, Length, hash, IRList, RAData, fileid]() {
+
+          // Packed now, the queue can hold on to thousands of blocks and the IR isn't retained past this call
+          std::vector<uint8_t> PackedIR;
+          FEXCore::IR::PackIR(IRList, RAData, &PackedIR);
+          AOTIRCaptureCacheWriteoutQueue_Append([this, LocalRIP, LocalStartAddr, Length, hash, PackedIR, fileid]() {
             auto *AotFile = &AOTIRCaptureCacheMap[fileid];
 
             if (!AotFile->Stream) {
@@ -330,7 +450,7 @@ namespace FEXCore::IR {
               uint64_t tag = FEXCore::IR::AOTIR_COOKIE;
               AotFile->Stream->write((char*)&tag, sizeof(tag));
             }
-            AotFile->AppendAOTIRCaptureCache(LocalRIP, LocalStartAddr, Length, hash, IRList, RAData);
+            AotFile->AppendAOTIRCaptureCache(LocalRIP, LocalStartAddr, Length, hash, PackedIR);
           });
 
           if (CTX->Config.AOTIRGenerate()) {
@@ -366,6 +486,80 @@ namespace FEXCore::IR {
     return false;
   }
 
+  AOTIRCaptureCache::PreGenerateCodeFetchResult AOTIRCaptureCache::PreGenerateCodeFetch(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP) {
+    PreGenerateCodeFetchResult Result{};
+
+    if (!CTX->Config.AOTCodeLoad()) {
+      return Result;
+    }
+
+    FEXCore::IR::AOTCodeInlineEntry *AOTEntry{};
+    {
+      std::shared_lock lk(AOTIRCacheLock);
+      auto file = FindAddrForFile(GuestRIP, 1);
+      if (file == AddrToFile.end()) {
+        return Result;
+      }
+
+      auto Mod = (FEXCore::IR::AOTIRInlineIndex*)file->second.CachedCodeEntry;
+
+      if (Mod == nullptr) {
+        auto CodeFile = AOTCodeCache.find(GetCodeFileID(file->second.fileid));
+        if (CodeFile == AOTCodeCache.end()) {
+          return Result;
+        }
+        file->second.CachedCodeEntry = Mod = CodeFile->second.Array;
+      }
+
+      AOTEntry = Mod->FindCode(GuestRIP - file->second.Start + file->second.Offset);
+    }
+
+    if (!AOTEntry) {
+      return Result;
+    }
+
+    // verify hash
+    auto MappedStart = GuestRIP + AOTEntry->GuestStartOffset;
+    auto hash = XXH3_64bits((void*)MappedStart, AOTEntry->GuestLength);
+    if (hash != AOTEntry->GuestHash) {
+      LogMan::Msg::IFmt("AOTCode: hash check failed {:x}\n", MappedStart);
+      return Result;
+    }
+
+    // The mapping stays alive until the cache is destroyed, so the backend can copy directly out of it
+    FEXCore::CPU::RelocatableCode Code {
+      .HostCode = AOTEntry->GetHostCode(),
+      .HostCodeSize = AOTEntry->HostCodeSize,
+      .Relocations = AOTEntry->GetRelocations(),
+      .RelocationCount = AOTEntry->RelocationCount,
+    };
+
+    Result.CodePtr = Thread->CPUBackend->RelocateJITObjectCode(GuestRIP, Code);
+    if (!Result.CodePtr) {
+      return Result;
+    }
+
+    // Relocations rewrite every process specific value, so the relocated code can be captured again as is
+    Result.DebugData = new FEXCore::Core::DebugData();
+    Result.DebugData->HostCodeSize = AOTEntry->HostCodeSize;
+    Result.DebugData->Relocations.assign(Code.Relocations, Code.Relocations + Code.RelocationCount);
+    Result.DebugData->Relocatable = true;
+    Result.StartAddr = MappedStart;
+    Result.Length = AOTEntry->GuestLength;
+
+    return Result;
+  }
+
+  std::string AOTIRCaptureCache::GetCodeFileID(const std::string &fileid) const {
+    // Host code additionally depends on backend options
+    std::string codefileid = fileid;
+    codefileid += CTX->Config.StaticRegisterAllocation ? "R" : "r";
+    codefileid += CTX->Config.ParanoidTSO ? "N" : "n";
+    // Blocks check for a paused guest while the gdb server runs
+    codefileid += CTX->GetGdbServerStatus() ? "G" : "g";
+    return codefileid + ".code";
+  }
+
   AOTIRCaptureCache::AddrToFileMapType::iterator AOTIRCaptureCache::FindAddrForFile(uint64_t Entry, uint64_t Length) {
     // Thread safety here! We are returning an iterator to the map object
     // This needs the AOTIRCacheLock locked prior to coming in to the function
@@ -393,10 +587,12 @@ namespace FEXCore::IR {
       fileid += CTX->Config.TSOEnabled ? "T" : "t";
       fileid += CTX->Config.ABILocalFlags ? "L" : "l";
       fileid += CTX->Config.ABINoPF ? "p" : "P";
+      fileid += CTX->Config.X87ReducedPrecision ? "X" : "x";
+      fileid += CTX->Config.StackTSOElision ? "E" : "e";
 
       std::unique_lock lk(AOTIRCacheLock);
 
-      AddrToFile.insert({ Base, { Base, Size, Offset, fileid, filename, nullptr, false} });
+      AddrToFile.insert({ Base, { Base, Size, Offset, fileid, filename, nullptr, nullptr, false} });
 
       if (CTX->Config.AOTIRLoad && !AOTIRCache.contains(fileid) && AOTIRLoader) {
         auto streamfd = AOTIRLoader(fileid);
@@ -405,7 +601,29 @@ namespace FEXCore::IR {
           close(streamfd);
         }
       }
+
+      auto codefileid = GetCodeFileID(fileid);
+      if (CTX->Config.AOTCodeLoad && !AOTCodeCache.contains(codefileid) && AOTIRLoader) {
+        auto streamfd = AOTIRLoader(codefileid);
+        if (streamfd != -1) {
+          FEXCore::IR::LoadAOTCodeCache(&AOTCodeCache, streamfd, AOTCodeBuildHash);
+          close(streamfd);
+        }
+      }
+    }
+  }
+
+  bool AOTIRCaptureCache::FindNamedRegion(uint64_t Address, std::string *Filename, uint64_t *FileOffset) {
+    std::shared_lock lk(AOTIRCacheLock);
+
+    auto file = FindAddrForFile(Address, 1);
+    if (file == AddrToFile.end()) {
+      return false;
     }
+
+    *Filename = file->second.filename;
+    *FileOffset = Address - file->second.Start + file->second.Offset;
+    return true;
   }
 
   void AOTIRCaptureCache::RemoveNamedRegion(uintptr_t Base, uintptr_t Size) {
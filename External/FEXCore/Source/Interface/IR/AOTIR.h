@@ -1,6 +1,7 @@
 #pragma once
 
 #include <FEXCore/Config/Config.h>
+#include <FEXCore/Core/CPUBackend.h>
 
 #include <atomic>
 #include <cstdint>
@@ -11,9 +12,11 @@
 #include <unordered_map>
 #include <shared_mutex>
 #include <queue>
+#include <vector>
 
 namespace FEXCore::Core {
 struct DebugData;
+struct InternalThreadState;
 }
 
 namespace FEXCore::IR {
@@ -35,9 +38,13 @@ namespace FEXCore::IR {
 
     return Cookie;
   };
-  constexpr static uint32_t AOTIR_VERSION = 0x0000'00004;
+  constexpr static uint32_t AOTIR_VERSION = 0x0000'00005;
   constexpr static uint64_t AOTIR_COOKIE = COOKIE_VERSION("FEXI", AOTIR_VERSION);
 
+  // The AOT code cache is additionally tagged with a hash of the FEX build and host features after the cookie
+  constexpr static uint32_t AOTCODE_VERSION = 0x0000'00001;
+  constexpr static uint64_t AOTCODE_COOKIE = COOKIE_VERSION("FEXC", AOTCODE_VERSION);
+
   struct AOTIRInlineEntry {
     uint64_t GuestHash;
     uint64_t GuestLength;
@@ -49,6 +56,21 @@ namespace FEXCore::IR {
     IR::IRListView *GetIRData();
   };
 
+  struct AOTCodeInlineEntry {
+    uint64_t GuestHash;
+    uint64_t GuestLength;
+    // Start of the hashed guest range relative to the block's entry
+    int64_t GuestStartOffset;
+    uint64_t HostCodeSize;
+    uint64_t RelocationCount;
+
+    /* Relocations followed by the host code */
+    uint8_t InlineData[0];
+
+    FEXCore::CPU::Relocation *GetRelocations();
+    uint8_t *GetHostCode();
+  };
+
   struct AOTIRInlineIndexEntry {
     uint64_t GuestStart;
     uint64_t DataOffset;
@@ -61,13 +83,19 @@ namespace FEXCore::IR {
 
     AOTIRInlineEntry *Find(uint64_t GuestStart);
     AOTIRInlineEntry *GetInlineEntry(uint64_t DataOffset);
+
+    AOTCodeInlineEntry *FindCode(uint64_t GuestStart);
+
+  private:
+    AOTIRInlineIndexEntry *FindIndexEntry(uint64_t GuestStart);
   };
 
   struct AOTIRCaptureCacheEntry {
     std::unique_ptr<std::ofstream> Stream;
     std::map<uint64_t, uint64_t> Index;
 
-    void AppendAOTIRCaptureCache(uint64_t GuestRIP, uint64_t Start, uint64_t Length, uint64_t Hash, FEXCore::IR::IRListView *IRList, FEXCore::IR::RegisterAllocationData *RAData);
+    void AppendAOTIRCaptureCache(uint64_t GuestRIP, uint64_t Start, uint64_t Length, uint64_t Hash, std::vector<uint8_t> const &PackedIR);
+    void AppendAOTCodeCaptureCache(uint64_t GuestRIP, int64_t GuestStartOffset, uint64_t Length, uint64_t Hash, std::vector<uint8_t> const &HostCode, std::vector<FEXCore::CPU::Relocation> const &Relocations);
   };
 
   struct AOTIRCacheEntry {
@@ -78,11 +106,12 @@ namespace FEXCore::IR {
 
   using AOTCacheType = std::unordered_map<std::string, FEXCore::IR::AOTIRCacheEntry>;
   bool LoadAOTIRCache(AOTCacheType *AOTIRCache, int streamfd);
+  bool LoadAOTCodeCache(AOTCacheType *AOTCodeCache, int streamfd, uint64_t BuildHash);
 
   class AOTIRCaptureCache final {
     public:
 
-      AOTIRCaptureCache(FEXCore::Context::Context *ctx) : CTX {ctx} {}
+      AOTIRCaptureCache(FEXCore::Context::Context *ctx);
       ~AOTIRCaptureCache();
 
       void FinalizeAOTIRCache();
@@ -100,6 +129,19 @@ namespace FEXCore::IR {
       };
       [[nodiscard]] PreGenerateIRFetchResult PreGenerateIRFetch(uint64_t GuestRIP, FEXCore::IR::IRListView *IRList);
 
+      struct PreGenerateCodeFetchResult {
+        void *CodePtr {};
+        FEXCore::Core::DebugData *DebugData {};
+        uint64_t StartAddr {};
+        uint64_t Length {};
+      };
+      /**
+       * @brief Pulls relocated host code for the guest RIP out of the AOT code cache
+       *
+       * @return CodePtr is nullptr if the block isn't in the cache or the CPUBackend couldn't load it
+       */
+      [[nodiscard]] PreGenerateCodeFetchResult PreGenerateCodeFetch(FEXCore::Core::InternalThreadState *Thread, uint64_t GuestRIP);
+
       bool PostCompileCode(FEXCore::Core::InternalThreadState *Thread,
         void* CodePtr,
         uint64_t GuestRIP,
@@ -114,6 +156,17 @@ namespace FEXCore::IR {
       void AddNamedRegion(uintptr_t Base, uintptr_t Size, uintptr_t Offset, const std::string &filename);
       void RemoveNamedRegion(uintptr_t Base, uintptr_t Size);
 
+      /**
+       * @brief Finds the file backing a guest address
+       *
+       * @param Address Guest address to look up
+       * @param Filename Path of the file the region was mapped from
+       * @param FileOffset Offset of the address inside of that file
+       *
+       * @return false if the address isn't inside of a named region
+       */
+      bool FindNamedRegion(uint64_t Address, std::string *Filename, uint64_t *FileOffset);
+
       // Callbacks
       void SetAOTIRLoader(std::function<int(const std::string&)> CacheReader) {
         AOTIRLoader = CacheReader;
@@ -145,6 +198,7 @@ namespace FEXCore::IR {
         std::string fileid;
         std::string filename;
         void *CachedFileEntry;
+        void *CachedCodeEntry;
         bool ContainsCode;
       };
 
@@ -157,6 +211,11 @@ namespace FEXCore::IR {
       std::function<void(const std::string&)> AOTIRRenamer;
       std::unordered_map<std::string, FEXCore::IR::AOTIRCaptureCacheEntry> AOTIRCaptureCacheMap;
 
+      FEXCore::IR::AOTCacheType AOTCodeCache;
+      std::unordered_map<std::string, FEXCore::IR::AOTIRCaptureCacheEntry> AOTCodeCaptureCacheMap;
+      uint64_t AOTCodeBuildHash{};
+
       AddrToFileMapType::iterator FindAddrForFile(uint64_t Entry, uint64_t Length);
+      std::string GetCodeFileID(const std::string &fileid) const;
   };
 }
@@ -0,0 +1,143 @@
+/*
+$info$
+meta: ir|compact ~ Varint packing of retained IR
+tags: ir|compact
+$end_info$
+*/
+
+#include "Interface/IR/CompactIR.h"
+
+#include <FEXCore/IR/IR.h>
+#include <FEXCore/IR/IntrusiveIRList.h>
+#include <FEXCore/IR/RegisterAllocationData.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace FEXCore::IR {
+  namespace {
+    // Each word of an OrderedNode is predicted from the same word in the node before it
+    // The links and op offsets only move by a small amount from one node to the next
+    constexpr size_t LIST_STRIDE = sizeof(OrderedNode) / sizeof(uint32_t);
+    static_assert(sizeof(OrderedNode) % sizeof(uint32_t) == 0);
+
+    void WriteVarint(std::vector<uint8_t> *Out, uint64_t Value) {
+      while (Value >= 0x80) {
+        Out->push_back((Value & 0x7F) | 0x80);
+        Value >>= 7;
+      }
+      Out->push_back(Value);
+    }
+
+    uint64_t ReadVarint(uint8_t const *&Ptr) {
+      uint64_t Value{};
+      uint32_t Shift{};
+      uint8_t Byte{};
+      do {
+        Byte = *Ptr++;
+        Value |= static_cast<uint64_t>(Byte & 0x7F) << Shift;
+        Shift += 7;
+      } while (Byte & 0x80);
+      return Value;
+    }
+
+    // Small negative deltas stay small
+    uint32_t ZigZag(uint32_t Value) {
+      return (Value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(Value) >> 31);
+    }
+
+    uint32_t UnZigZag(uint32_t Value) {
+      return (Value >> 1) ^ (0U - (Value & 1));
+    }
+
+    // Stride of zero stores every word as-is
+    void PackWords(uint8_t const *Data, size_t Size, size_t Stride, std::vector<uint8_t> *Out) {
+      const size_t Words = Size / sizeof(uint32_t);
+
+      for (size_t i = 0; i < Words; ++i) {
+        uint32_t Word, Predicted{};
+        memcpy(&Word, Data + i * sizeof(uint32_t), sizeof(uint32_t));
+        if (Stride && i >= Stride) {
+          memcpy(&Predicted, Data + (i - Stride) * sizeof(uint32_t), sizeof(uint32_t));
+        }
+        WriteVarint(Out, ZigZag(Word - Predicted));
+      }
+
+      // Trailing bytes that don't make up a full word
+      Out->insert(Out->end(), Data + Words * sizeof(uint32_t), Data + Size);
+    }
+
+    void UnpackWords(uint8_t const *&Ptr, uint8_t *Data, size_t Size, size_t Stride) {
+      const size_t Words = Size / sizeof(uint32_t);
+
+      for (size_t i = 0; i < Words; ++i) {
+        uint32_t Predicted{};
+        if (Stride && i >= Stride) {
+          memcpy(&Predicted, Data + (i - Stride) * sizeof(uint32_t), sizeof(uint32_t));
+        }
+        const uint32_t Word = UnZigZag(ReadVarint(Ptr)) + Predicted;
+        memcpy(Data + i * sizeof(uint32_t), &Word, sizeof(uint32_t));
+      }
+
+      const size_t Remaining = Size - Words * sizeof(uint32_t);
+      memcpy(Data + Words * sizeof(uint32_t), Ptr, Remaining);
+      Ptr += Remaining;
+    }
+  }
+
+  void PackIR(IRListView const *IRList, RegisterAllocationData const *RAData, std::vector<uint8_t> *Out) {
+    const size_t DataSize = IRList->GetDataSize();
+    const size_t ListSize = IRList->GetListSize();
+
+    Out->clear();
+    WriteVarint(Out, DataSize);
+    WriteVarint(Out, ListSize);
+
+    WriteVarint(Out, RAData != nullptr);
+    if (RAData) {
+      WriteVarint(Out, RAData->SpillSlotCount);
+      WriteVarint(Out, RAData->MapCount);
+      auto Map = reinterpret_cast<uint8_t const*>(&RAData->Map[0]);
+      Out->insert(Out->end(), Map, Map + sizeof(RAData->Map[0]) * RAData->MapCount);
+    }
+
+    PackWords(reinterpret_cast<uint8_t const*>(IRList->GetData()), DataSize, 0, Out);
+    PackWords(reinterpret_cast<uint8_t const*>(IRList->GetListData()), ListSize, LIST_STRIDE, Out);
+
+    Out->shrink_to_fit();
+  }
+
+  UnpackedIR UnpackIR(std::vector<uint8_t> const &In) {
+    UnpackedIR Result{};
+    uint8_t const *Ptr = In.data();
+
+    const size_t DataSize = ReadVarint(Ptr);
+    const size_t ListSize = ReadVarint(Ptr);
+
+    if (ReadVarint(Ptr)) {
+      const uint32_t SpillSlotCount = ReadVarint(Ptr);
+      const uint32_t MapCount = ReadVarint(Ptr);
+
+      auto RAData = reinterpret_cast<RegisterAllocationData*>(FEXCore::Allocator::malloc(RegisterAllocationData::Size(MapCount)));
+      RAData->SpillSlotCount = SpillSlotCount;
+      RAData->MapCount = MapCount;
+      RAData->IsShared = false;
+      memcpy(&RAData->Map[0], Ptr, sizeof(RAData->Map[0]) * MapCount);
+      Ptr += sizeof(RAData->Map[0]) * MapCount;
+      Result.RAData.reset(RAData);
+    }
+
+    // The IRListView copy constructor does the allocation for us
+    DualIntrusiveAllocator Allocator(std::max(DataSize, ListSize));
+    UnpackWords(Ptr, reinterpret_cast<uint8_t*>(Allocator.DataAllocate(DataSize)), DataSize, 0);
+    UnpackWords(Ptr, reinterpret_cast<uint8_t*>(Allocator.ListAllocate(ListSize)), ListSize, LIST_STRIDE);
+    Result.IRList.reset(new IRListView(&Allocator, true));
+
+    LOGMAN_THROW_A_FMT(Ptr == In.data() + In.size(), "Packed IR was {} bytes, consumed {}", In.size(), Ptr - In.data());
+    return Result;
+  }
+}
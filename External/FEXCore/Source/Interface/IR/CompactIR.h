@@ -0,0 +1,32 @@
+#pragma once
+
+#include <FEXCore/IR/IntrusiveIRList.h>
+#include <FEXCore/IR/RegisterAllocationData.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace FEXCore::IR {
+  /**
+   * @brief Packs a block's IR and register allocation in to a varint encoded buffer
+   *
+   * For IR that has to outlive the block's compilation but isn't looked at until much later.
+   * Usually a quarter of the size of the IRListView copy.
+   *
+   * @param IRList The IR to pack
+   * @param RAData Register allocation of the IR, can be nullptr
+   * @param Out Receives the packed data
+   */
+  void PackIR(IRListView const *IRList, RegisterAllocationData const *RAData, std::vector<uint8_t> *Out);
+
+  struct UnpackedIR {
+    std::unique_ptr<IRListView, IRListViewDeleter> IRList;
+    std::unique_ptr<RegisterAllocationData, RegisterAllocationDataDeleter> RAData;
+  };
+
+  /**
+   * @brief Recreates the IR and register allocation that PackIR was given
+   */
+  UnpackedIR UnpackIR(std::vector<uint8_t> const &In);
+}
@@ -11,39 +11,53 @@ $end_info$
 #include "Interface/IR/Passes/RegisterAllocationPass.h"
 
 #include <FEXCore/Config/Config.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+
+#include <chrono>
 
 namespace FEXCore::IR {
 class IREmitter;
 
-void PassManager::AddDefaultPasses(bool InlineConstants, bool StaticRegisterAllocation) {
+void PassManager::AddDefaultPasses(bool InlineConstants, bool StaticRegisterAllocation, bool BaselineTier) {
   FEX_CONFIG_OPT(DisablePasses, O0);
+  FEX_CONFIG_OPT(TSOEnabled, TSOENABLED);
+  FEX_CONFIG_OPT(StackTSOElision, STACKTSOELISION);
 
-  if (!DisablePasses()) {
-    InsertPass(CreateContextLoadStoreElimination());
+  // The baseline tier only runs what is required for correctness, hot blocks get recompiled with the full pipeline
+  if (!DisablePasses() && !BaselineTier) {
+    InsertPass(CreateContextLoadStoreElimination(), "RCLSE");
 
     if (Is64BitMode()) {
       // This needs to run after RCLSE
       // This only matters for 64-bit code since these instructions don't exist in 32-bit
-      InsertPass(CreateLongDivideEliminationPass());
+      InsertPass(CreateLongDivideEliminationPass(), "LongDivideElimination");
     }
 
-    InsertPass(CreateDeadStoreElimination());
-    InsertPass(CreatePassDeadCodeElimination());
-    InsertPass(CreateConstProp(InlineConstants));
+    // Needs RCLSE to have forwarded TOP so the stack indexes share a single base
+    InsertPass(CreateX87StackOptimizationPass(), "X87StackOptimization");
+
+    if (TSOEnabled() && StackTSOElision()) {
+      // Needs RCLSE to have forwarded copies of RSP back to the LoadContext
+      InsertPass(CreateStackTSOElision(), "StackTSOElision");
+    }
+
+    InsertPass(CreateDeadStoreElimination(), "DSE");
+    InsertPass(CreatePassDeadCodeElimination(), "DCE");
+    InsertPass(CreateConstProp(InlineConstants), "ConstProp");
 
     ////// InsertPass(CreateDeadFlagCalculationEliminination());
 
-    InsertPass(CreateSyscallOptimization());
-    InsertPass(CreatePassDeadCodeElimination());
+    InsertPass(CreateSyscallOptimization(), "SyscallOptimization");
+    InsertPass(CreatePassDeadCodeElimination(), "DCE");
 
     // only do SRA if enabled and JIT
     if (InlineConstants && StaticRegisterAllocation)
-      InsertPass(CreateStaticRegisterAllocationPass());
+      InsertPass(CreateStaticRegisterAllocationPass(), "SRA");
   }
   else {
     // only do SRA if enabled and JIT
     if (InlineConstants && StaticRegisterAllocation)
-      InsertPass(CreateStaticRegisterAllocationPass());
+      InsertPass(CreateStaticRegisterAllocationPass(), "SRA");
   }
 
   // If the IR is compacted post-RA then the node indexing gets messed up and the backend isn't able to find the register assigned to a node
@@ -64,10 +78,21 @@ void PassManager::InsertRegisterAllocationPass(bool OptimizeSRA) {
   InsertPass(IR::CreateRegisterAllocationPass(GetPass("Compaction"), OptimizeSRA), "RA");
 }
 
-bool PassManager::Run(IREmitter *IREmit) {
+bool PassManager::Run(IREmitter *IREmit, FEXCore::Core::CompileStats *Stats) {
   bool Changed = false;
-  for (auto const &Pass : Passes) {
-    Changed |= Pass->Run(IREmit);
+  if (Stats) {
+    for (size_t i = 0; i < Passes.size(); ++i) {
+      auto Start = std::chrono::steady_clock::now();
+      Changed |= Passes[i]->Run(IREmit);
+      auto Time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start);
+      // Passes inserted more than once share their time
+      Stats->AddPassTime(PassNames[i], Time.count());
+    }
+  }
+  else {
+    for (auto const &Pass : Passes) {
+      Changed |= Pass->Run(IREmit);
+    }
   }
 
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
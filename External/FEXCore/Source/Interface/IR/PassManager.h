@@ -17,6 +17,10 @@ namespace FEXCore::HLE {
 class SyscallHandler;
 }
 
+namespace FEXCore::Core {
+struct CompileStats;
+}
+
 namespace FEXCore::IR {
 class PassManager;
 class IREmitter;
@@ -39,7 +43,7 @@ protected:
 class PassManager final {
   friend class SyscallOptimization;
 public:
-  void AddDefaultPasses(bool InlineConstants, bool StaticRegisterAllocation);
+  void AddDefaultPasses(bool InlineConstants, bool StaticRegisterAllocation, bool BaselineTier = false);
   void AddDefaultValidationPasses();
   Pass* InsertPass(std::unique_ptr<Pass> Pass, std::string Name = "") {
     Pass->RegisterPassManager(this);
@@ -48,12 +52,13 @@ public:
     if (!Name.empty()) {
       NameToPassMaping[Name] = PassPtr;
     }
+    PassNames.emplace_back(Name.empty() ? "Unnamed" : Name);
     return PassPtr;
   }
 
   void InsertRegisterAllocationPass(bool OptimizeSRA);
 
-  bool Run(IREmitter *IREmit);
+  bool Run(IREmitter *IREmit, FEXCore::Core::CompileStats *Stats = nullptr);
 
   void RegisterExitHandler(ShouldExitHandler Handler) {
     ExitHandler = std::move(Handler);
@@ -82,6 +87,7 @@ protected:
 
 private:
   std::vector<std::unique_ptr<Pass>> Passes;
+  std::vector<std::string> PassNames;
   std::unordered_map<std::string, Pass*> NameToPassMaping;
 
 #if defined(ASSERTIONS_ENABLED) && ASSERTIONS_ENABLED
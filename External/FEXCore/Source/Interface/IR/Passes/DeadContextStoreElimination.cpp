@@ -14,6 +14,7 @@ $end_info$
 #include <FEXCore/IR/IntrusiveIRList.h>
 #include <FEXCore/Utils/LogManager.h>
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <stddef.h>
@@ -321,6 +322,22 @@ namespace {
     SetAccess(Offset++, DefaultAccess[15]);
   }
 
+  // Only forgets the members that overlap [Begin, End), padding stays invalid
+  static void ResetClassificationRange(ContextInfo *ContextClassificationInfo, size_t Begin, size_t End) {
+    for (auto &it : ContextClassificationInfo->ClassificationInfo) {
+      if (it.Class.Offset >= End ||
+          (it.Class.Offset + it.Class.Size) <= Begin ||
+          IsInvalidAccess(it.Accessed)) {
+        continue;
+      }
+
+      it.Accessed = ACCESS_NONE;
+      it.AccessRegClass = FEXCore::IR::InvalidClass;
+      it.AccessOffset = 0;
+      it.StoreNode = nullptr;
+    }
+  }
+
   struct BlockInfo {
     std::vector<FEXCore::IR::OrderedNode *> Predecessors;
     std::vector<FEXCore::IR::OrderedNode *> Successors;
@@ -346,6 +363,8 @@ private:
   ContextMemberInfo *RecordAccess(ContextInfo *ClassifiedInfo, FEXCore::IR::RegisterClassType RegClass, uint32_t Offset, uint8_t Size, LastAccessType AccessType, FEXCore::IR::OrderedNode *Node, FEXCore::IR::OrderedNode *StoreNode = nullptr);
   void CalculateControlFlowInfo(FEXCore::IR::IREmitter *IREmit);
 
+  void ResetIndexedAccess(FEXCore::IR::IREmitter *IREmit, ContextInfo *ClassifiedInfo, FEXCore::IR::OrderedNodeWrapper Index, uint32_t BaseOffset, uint32_t Stride, uint8_t Size);
+
   // Block local Passes
   bool RedundantStoreLoadElimination(FEXCore::IR::IREmitter *IREmit);
 };
@@ -381,6 +400,21 @@ ContextMemberInfo *RCLSE::RecordAccess(ContextInfo *ClassifiedInfo, FEXCore::IR:
   return RecordAccess(Info, RegClass, Offset, Size, AccessType, Node, StoreNode);
 }
 
+void RCLSE::ResetIndexedAccess(FEXCore::IR::IREmitter *IREmit, ContextInfo *ClassifiedInfo, FEXCore::IR::OrderedNodeWrapper Index, uint32_t BaseOffset, uint32_t Stride, uint8_t Size) {
+  // The index is unsigned so nothing below the base can be touched
+  // x87 masks its index with 7, which keeps the accesses inside of the MM registers
+  size_t End = sizeof(FEXCore::Core::CPUState);
+  auto IndexOp = IREmit->GetOpHeader(Index);
+  uint64_t Mask{};
+  if (IndexOp->Op == FEXCore::IR::OP_AND &&
+      (IREmit->IsValueConstant(IndexOp->Args[1], &Mask) || IREmit->IsValueConstant(IndexOp->Args[0], &Mask)) &&
+      Mask < sizeof(FEXCore::Core::CPUState)) {
+    End = std::min<size_t>(End, BaseOffset + Mask * Stride + Size);
+  }
+
+  ResetClassificationRange(ClassifiedInfo, BaseOffset, End);
+}
+
 void RCLSE::CalculateControlFlowInfo(FEXCore::IR::IREmitter *IREmit) {
   using namespace FEXCore;
   using namespace FEXCore::IR;
@@ -678,10 +712,19 @@ bool RCLSE::RedundantStoreLoadElimination(FEXCore::IR::IREmitter *IREmit) {
           ResetClassificationAccesses(&LocalInfo);
         }
       }
-      else if (IROp->Op == OP_STORECONTEXTINDEXED ||
-               IROp->Op == OP_LOADCONTEXTINDEXED ||
-               IROp->Op == OP_BREAK) {
+      else if (IROp->Op == OP_STORECONTEXTINDEXED) {
+        auto Op = IROp->C<IR::IROp_StoreContextIndexed>();
+        ResetIndexedAccess(IREmit, &LocalInfo, Op->Index, Op->BaseOffset, Op->Stride, IROp->Size);
+      }
+      else if (IROp->Op == OP_LOADCONTEXTINDEXED) {
+        auto Op = IROp->C<IR::IROp_LoadContextIndexed>();
+        ResetIndexedAccess(IREmit, &LocalInfo, Op->Index, Op->BaseOffset, Op->Stride, IROp->Size);
+      }
+      else if (IROp->Op == OP_BREAK ||
+               IROp->Op == OP_MEMSET ||
+               IROp->Op == OP_MEMCPY) {
         // We can't track through these
+        // MemSet and MemCpy read and write RCX, RSI and RDI in the context themselves
         ResetClassificationAccesses(&LocalInfo);
       }
     }
@@ -0,0 +1,190 @@
+/*
+$info$
+tags: ir|opts
+desc: Demotes TSO memory accesses that are relative to the stack pointer
+$end_info$
+*/
+
+#include "Interface/IR/PassManager.h"
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/X86Enums.h>
+#include <FEXCore/IR/IR.h>
+#include <FEXCore/IR/IREmitter.h>
+#include <FEXCore/IR/IntrusiveIRList.h>
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace FEXCore::IR {
+
+/**
+ * @brief Turns LoadMemTSO/StoreMemTSO in to LoadMem/StoreMem when the address is derived from RSP
+ *
+ * The frontend already skips TSO for operands that name RSP directly.
+ * Once RCLSE has forwarded the registers, copies of RSP such as a frame pointer or a lea'd local
+ * also show up as RSP plus a constant, which is what this pass looks for.
+ *
+ * eg.
+ *   %ssa10 i64 = LoadContext 0x8, 0x28
+ *   %ssa12 i64 = Sub %ssa10, #0x10
+ *   (%%ssa13) StoreMemTSO %ssa11 i64, %ssa12 i64, %Invalid, 0x8
+ * Converts to
+ *   (%%ssa13) StoreMem %ssa11 i64, %ssa12 i64, %Invalid, 0x8
+ *
+ * Nothing can prove that another thread never sees the stack, so this assumes it isn't used to communicate
+ * unless the block shows otherwise. If a value computed from RSP gets stored to memory or to a guest register
+ * other than RSP, goes to an op with side effects or is used by another block then the whole block keeps its
+ * TSO accesses.
+ */
+class StackTSOElision final : public FEXCore::IR::Pass {
+public:
+  bool Run(IREmitter *IREmit) override;
+
+private:
+  static constexpr uint32_t RSPOffset = offsetof(FEXCore::Core::CPUState, gregs[FEXCore::X86State::REG_RSP]);
+
+  struct StackValue {
+    // RSP plus a constant, otherwise just computed from one
+    bool IsAddress;
+    // Uses seen inside of the block
+    uint32_t Uses;
+  };
+
+  std::unordered_map<OrderedNode*, StackValue> StackValues;
+
+  bool IsStackAddress(IREmitter *IREmit, OrderedNodeWrapper Node) const;
+  bool IsStackAddressOp(IREmitter *IREmit, IROp_Header const *IROp) const;
+  static bool IsAddressArg(IROp_Header const *IROp, uint8_t Arg);
+};
+
+bool StackTSOElision::IsStackAddress(IREmitter *IREmit, OrderedNodeWrapper Node) const {
+  auto it = StackValues.find(IREmit->UnwrapNode(Node));
+  return it != StackValues.end() && it->second.IsAddress;
+}
+
+bool StackTSOElision::IsStackAddressOp(IREmitter *IREmit, IROp_Header const *IROp) const {
+  switch (IROp->Op) {
+    case OP_LOADCONTEXT: {
+      auto Op = IROp->C<IROp_LoadContext>();
+      // 32-bit guests load the lower half
+      return Op->Offset == RSPOffset &&
+             Op->Class == GPRClass &&
+             IROp->Size >= 4;
+    }
+    case OP_ADD:
+      return (IsStackAddress(IREmit, IROp->Args[0]) && IREmit->IsValueConstant(IROp->Args[1])) ||
+             (IREmit->IsValueConstant(IROp->Args[0]) && IsStackAddress(IREmit, IROp->Args[1]));
+    case OP_SUB:
+    case OP_AND:
+      // And is the stack getting aligned
+      return IsStackAddress(IREmit, IROp->Args[0]) && IREmit->IsValueConstant(IROp->Args[1]);
+    case OP_BFE: {
+      // Address size truncation
+      auto Op = IROp->C<IROp_Bfe>();
+      return Op->lsb == 0 && Op->Width >= 32 && IsStackAddress(IREmit, Op->Src);
+    }
+    default:
+      return false;
+  }
+}
+
+bool StackTSOElision::IsAddressArg(IROp_Header const *IROp, uint8_t Arg) {
+  switch (IROp->Op) {
+    case OP_LOADMEM:
+    case OP_LOADMEMTSO:
+      // Addr and Offset
+      return Arg == 0 || Arg == 1;
+    case OP_STOREMEM:
+    case OP_STOREMEMTSO:
+      // Storing the address itself lets it escape
+      return Arg == 1 || Arg == 2;
+    default:
+      return false;
+  }
+}
+
+bool StackTSOElision::Run(IREmitter *IREmit) {
+  bool Changed = false;
+  auto CurrentIR = IREmit->ViewIR();
+
+  std::vector<IROp_Header*> Candidates;
+
+  for (auto [BlockNode, BlockHeader] : CurrentIR.GetBlocks()) {
+    StackValues.clear();
+    Candidates.clear();
+    bool Escaped = false;
+
+    for (auto [CodeNode, IROp] : CurrentIR.GetCode(BlockNode)) {
+      const bool IsMemOp = IROp->Op == OP_LOADMEM || IROp->Op == OP_LOADMEMTSO ||
+                           IROp->Op == OP_STOREMEM || IROp->Op == OP_STOREMEMTSO;
+      // Updating RSP itself keeps the value the stack pointer, any other register hands it to the following code
+      const bool IsStackPointerStore = IROp->Op == OP_STORECONTEXT && IROp->C<IROp_StoreContext>()->Offset == RSPOffset;
+      bool UsesStackValue = false;
+
+      for (uint8_t i = 0; i < IROp->NumArgs; ++i) {
+        if (IROp->Args[i].IsInvalid()) {
+          continue;
+        }
+
+        auto it = StackValues.find(CurrentIR.GetNode(IROp->Args[i]));
+        if (it == StackValues.end()) {
+          continue;
+        }
+
+        ++it->second.Uses;
+
+        if (IsMemOp) {
+          Escaped |= !IsAddressArg(IROp, i);
+        }
+        else if (!IsStackPointerStore) {
+          // Pure ops only compute a new value from it, anything else could hand it to another thread
+          Escaped |= HasSideEffects(IROp->Op);
+          UsesStackValue = true;
+        }
+      }
+
+      if (IsStackAddressOp(IREmit, IROp)) {
+        StackValues[CodeNode] = StackValue{true, 0};
+      }
+      else if (UsesStackValue) {
+        StackValues[CodeNode] = StackValue{false, 0};
+      }
+
+      if (IROp->Op == OP_LOADMEMTSO &&
+          IsStackAddress(IREmit, IROp->C<IROp_LoadMemTSO>()->Addr)) {
+        Candidates.emplace_back(IROp);
+      }
+      else if (IROp->Op == OP_STOREMEMTSO &&
+               IsStackAddress(IREmit, IROp->C<IROp_StoreMemTSO>()->Addr)) {
+        Candidates.emplace_back(IROp);
+      }
+    }
+
+    // A use we didn't see means the value lives on in another block
+    for (auto &[Node, Value] : StackValues) {
+      Escaped |= Value.Uses != Node->GetUses();
+    }
+
+    if (Escaped) {
+      continue;
+    }
+
+    // The non-TSO ops share the layout of the TSO ones
+    static_assert(sizeof(IROp_LoadMem) == sizeof(IROp_LoadMemTSO));
+    static_assert(sizeof(IROp_StoreMem) == sizeof(IROp_StoreMemTSO));
+    for (auto IROp : Candidates) {
+      IROp->Op = IROp->Op == OP_LOADMEMTSO ? OP_LOADMEM : OP_STOREMEM;
+      Changed = true;
+    }
+  }
+
+  return Changed;
+}
+
+std::unique_ptr<FEXCore::IR::Pass> CreateStackTSOElision() {
+  return std::make_unique<StackTSOElision>();
+}
+}
@@ -7,6 +7,7 @@ $end_info$
 
 #include "Interface/IR/PassManager.h"
 
+#include <FEXCore/Config/Config.h>
 #include <FEXCore/IR/IR.h>
 #include <FEXCore/IR/IREmitter.h>
 #include <FEXCore/IR/IntrusiveIRList.h>
@@ -20,6 +21,9 @@ namespace FEXCore::IR {
 class SyscallOptimization final : public FEXCore::IR::Pass {
 public:
   bool Run(IREmitter *IREmit) override;
+
+private:
+  FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
 };
 
 bool SyscallOptimization::Run(IREmitter *IREmit) {
@@ -47,9 +51,11 @@ bool SyscallOptimization::Run(IREmitter *IREmit) {
           for (uint8_t Arg = (SyscallDef.NumArgs + 1); Arg < FEXCore::HLE::SyscallArguments::MAX_ARGS; ++Arg) {
             IREmit->ReplaceNodeArgument(CodeNode, Arg, IREmit->Invalid());
           }
-#ifdef _M_ARM_64
+#if defined(_M_ARM_64) || defined(_M_X86_64)
           // Replace syscall with inline passthrough syscall if we can
-          if (SyscallDef.HostSyscallNumber != -1) {
+          // Page tracking SMC checks need to see syscalls that fail on write-protected code pages
+          if (SyscallDef.HostSyscallNumber != -1 &&
+              SMCChecks != FEXCore::Config::CONFIG_SMC_MTRACK) {
             IREmit->SetWriteCursor(CodeNode);
             // Skip Args[0] since that is the syscallid
             auto InlineSyscall = IREmit->_InlineSyscall(
@@ -0,0 +1,321 @@
+/*
+$info$
+tags: ir|opts
+desc: Forwards x87 stack register accesses through the block
+$end_info$
+*/
+
+#include "Interface/IR/PassManager.h"
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/X86Enums.h>
+#include <FEXCore/IR/IR.h>
+#include <FEXCore/IR/IREmitter.h>
+#include <FEXCore/IR/IntrusiveIRList.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace FEXCore::IR {
+
+/**
+ * @brief Tracks the x87 stack slots inside of a block
+ *
+ * The x87 ops access the MM registers through `(TOP + i) & 7`. RCLSE forwards TOP through the block,
+ * which leaves every stack index as a small expression of a single TOP load.
+ * We resolve those expressions to TOP plus a static offset and treat each stack slot as its own context member.
+ *
+ * eg.
+ *   %ssa10 i8 = LoadContext 0x1, 0x3bd
+ *   %ssa13 i64 = And (Sub %ssa10, #1), #7
+ *   (%%ssa14) StoreContextIndexed %ssa12 i128, %ssa13, 0x10, 0x140, 0x10
+ *   %ssa16 i128 = LoadContextIndexed %ssa13, 0x10, 0x140, 0x10
+ * Converts to
+ *   (%%ssa14) StoreContextIndexed %ssa12 i128, %ssa13, 0x10, 0x140, 0x10
+ *   and %ssa16 is replaced with %ssa12
+ *
+ * Stores to a slot that get overwritten before the block ends are removed, so each slot is only written back once.
+ * When TOP is a known constant, eg. after FNINIT, the indexed accesses become fixed LoadContext/StoreContext.
+ */
+class X87StackOptimization final : public FEXCore::IR::Pass {
+public:
+  bool Run(IREmitter *IREmit) override;
+
+private:
+  static constexpr uint32_t MMBaseOffset = offsetof(FEXCore::Core::CPUState, mm[0][0]);
+  static constexpr uint32_t MMStride = sizeof(FEXCore::Core::CPUState::mm[0]);
+  static constexpr uint32_t MMEnd = MMBaseOffset + sizeof(FEXCore::Core::CPUState::mm);
+
+  struct StackSlot {
+    // nullptr when TOP is a constant
+    OrderedNode *Base;
+    uint64_t Offset;
+    bool Masked;
+  };
+
+  struct SlotInfo {
+    // Last value that was stored or loaded from the slot
+    OrderedNode *Value;
+    // Last store to the slot, if nothing has read it since
+    OrderedNode *StoreNode;
+  };
+
+  // Every slot is relative to the same base, a different base can alias any of them
+  OrderedNode *CurrentBase{};
+  bool HasBase{};
+  std::array<SlotInfo, 8> Slots{};
+  std::vector<std::pair<OrderedNode*, uint32_t>> FixedSlotAccesses;
+
+  bool ResolveSlot(IREmitter *IREmit, OrderedNodeWrapper Index, StackSlot *Slot, uint32_t Depth = 0);
+  bool IsStackAccess(uint32_t BaseOffset, uint32_t Stride, uint8_t Size, RegisterClassType Class) const;
+  SlotInfo *LookupSlot(StackSlot const &Slot);
+  void ResetSlots();
+  void ClearPendingStores();
+  void RemoveStore(OrderedNode *StoreNode);
+};
+
+bool X87StackOptimization::ResolveSlot(IREmitter *IREmit, OrderedNodeWrapper Index, StackSlot *Slot, uint32_t Depth) {
+  auto IROp = IREmit->GetOpHeader(Index);
+  uint64_t Value{};
+
+  // Only the short chains that the x87 handlers emit
+  if (Depth < 8) {
+    switch (IROp->Op) {
+      case OP_CONSTANT:
+        IREmit->IsValueConstant(Index, &Value);
+        *Slot = StackSlot{nullptr, Value, Value < 8};
+        return true;
+      case OP_ADD:
+        if (IREmit->IsValueConstant(IROp->Args[1], &Value) &&
+            ResolveSlot(IREmit, IROp->Args[0], Slot, Depth + 1)) {
+          Slot->Offset += Value;
+          Slot->Masked = false;
+          return true;
+        }
+        if (IREmit->IsValueConstant(IROp->Args[0], &Value) &&
+            ResolveSlot(IREmit, IROp->Args[1], Slot, Depth + 1)) {
+          Slot->Offset += Value;
+          Slot->Masked = false;
+          return true;
+        }
+        break;
+      case OP_SUB:
+        if (IREmit->IsValueConstant(IROp->Args[1], &Value) &&
+            ResolveSlot(IREmit, IROp->Args[0], Slot, Depth + 1)) {
+          Slot->Offset -= Value;
+          Slot->Masked = false;
+          return true;
+        }
+        break;
+      case OP_AND:
+        // Two's complement keeps the low three bits correct through the add and sub
+        if (IREmit->IsValueConstant(IROp->Args[1], &Value) &&
+            Value == 7 &&
+            ResolveSlot(IREmit, IROp->Args[0], Slot, Depth + 1)) {
+          Slot->Offset &= 7;
+          Slot->Masked = true;
+          return true;
+        }
+        break;
+      case OP_LOADCONTEXT: {
+        auto Op = IROp->C<IROp_LoadContext>();
+        if (Op->Offset == offsetof(FEXCore::Core::CPUState, flags) + FEXCore::X86State::X87FLAG_TOP_LOC &&
+            IROp->Size == 1) {
+          // TOP only ever holds three bits
+          *Slot = StackSlot{IREmit->UnwrapNode(Index), 0, true};
+          return true;
+        }
+        break;
+      }
+      default: break;
+    }
+  }
+
+  // Anything else is a new base, the index is only usable if it gets masked
+  *Slot = StackSlot{IREmit->UnwrapNode(Index), 0, false};
+  return true;
+}
+
+bool X87StackOptimization::IsStackAccess(uint32_t BaseOffset, uint32_t Stride, uint8_t Size, RegisterClassType Class) const {
+  return BaseOffset == MMBaseOffset &&
+         Stride == MMStride &&
+         Size == MMStride &&
+         Class == FPRClass;
+}
+
+X87StackOptimization::SlotInfo *X87StackOptimization::LookupSlot(StackSlot const &Slot) {
+  if (!Slot.Masked) {
+    return nullptr;
+  }
+
+  if (!HasBase || CurrentBase != Slot.Base) {
+    ResetSlots();
+    CurrentBase = Slot.Base;
+    HasBase = true;
+  }
+
+  return &Slots[Slot.Offset & 7];
+}
+
+void X87StackOptimization::ResetSlots() {
+  HasBase = false;
+  CurrentBase = nullptr;
+  Slots.fill({});
+}
+
+void X87StackOptimization::ClearPendingStores() {
+  for (auto &Slot : Slots) {
+    Slot.StoreNode = nullptr;
+  }
+}
+
+void X87StackOptimization::RemoveStore(OrderedNode *StoreNode) {
+  std::erase_if(FixedSlotAccesses, [StoreNode](auto const &Access) {
+    return Access.first == StoreNode;
+  });
+}
+
+bool X87StackOptimization::Run(IREmitter *IREmit) {
+  bool Changed = false;
+  auto CurrentIR = IREmit->ViewIR();
+  auto OriginalWriteCursor = IREmit->GetWriteCursor();
+
+  for (auto [BlockNode, BlockHeader] : CurrentIR.GetBlocks()) {
+    ResetSlots();
+    FixedSlotAccesses.clear();
+
+    for (auto [CodeNode, IROp] : CurrentIR.GetCode(BlockNode)) {
+      if (IROp->Op == OP_LOADCONTEXTINDEXED) {
+        auto Op = IROp->C<IROp_LoadContextIndexed>();
+        if (!IsStackAccess(Op->BaseOffset, Op->Stride, IROp->Size, Op->Class)) {
+          if (Op->BaseOffset < MMEnd) {
+            ClearPendingStores();
+          }
+          continue;
+        }
+
+        StackSlot Slot{};
+        ResolveSlot(IREmit, Op->Index, &Slot);
+        auto Info = LookupSlot(Slot);
+        if (!Info) {
+          // Could be any of the slots
+          ClearPendingStores();
+          continue;
+        }
+
+        // Whatever was stored has now been seen
+        Info->StoreNode = nullptr;
+
+        if (Info->Value) {
+          auto Value = Info->Value;
+          if (IREmit->GetOpSize(Value) < IROp->Size) {
+            // Reduced precision x87 keeps doubles in the slots, the store zero extended them
+            IREmit->SetWriteCursor(CodeNode);
+            Value = IREmit->_VMov(IROp->Size, Value);
+            Info->Value = Value;
+          }
+
+          if (IREmit->GetOpSize(Value) == IROp->Size) {
+            IREmit->ReplaceAllUsesWith(CodeNode, Value);
+            Changed = true;
+            continue;
+          }
+        }
+
+        Info->Value = CodeNode;
+        if (!Slot.Base) {
+          FixedSlotAccesses.emplace_back(CodeNode, Slot.Offset & 7);
+        }
+      }
+      else if (IROp->Op == OP_STORECONTEXTINDEXED) {
+        auto Op = IROp->C<IROp_StoreContextIndexed>();
+        if (!IsStackAccess(Op->BaseOffset, Op->Stride, IROp->Size, Op->Class)) {
+          if (Op->BaseOffset < MMEnd) {
+            ResetSlots();
+          }
+          continue;
+        }
+
+        StackSlot Slot{};
+        ResolveSlot(IREmit, Op->Index, &Slot);
+        auto Info = LookupSlot(Slot);
+        if (!Info) {
+          ResetSlots();
+          continue;
+        }
+
+        if (Info->StoreNode) {
+          // Overwritten without anything reading it
+          RemoveStore(Info->StoreNode);
+          IREmit->Remove(Info->StoreNode);
+          Changed = true;
+        }
+
+        Info->StoreNode = CodeNode;
+        Info->Value = CurrentIR.GetNode(Op->Value);
+        if (!Slot.Base) {
+          FixedSlotAccesses.emplace_back(CodeNode, Slot.Offset & 7);
+        }
+      }
+      else if (IROp->Op == OP_LOADCONTEXT) {
+        auto Op = IROp->C<IROp_LoadContext>();
+        if (Op->Offset < MMEnd && (Op->Offset + IROp->Size) > MMBaseOffset) {
+          // MMX reading the registers directly
+          ClearPendingStores();
+        }
+      }
+      else if (IROp->Op == OP_STORECONTEXT) {
+        auto Op = IROp->C<IROp_StoreContext>();
+        if (Op->Offset < MMEnd && (Op->Offset + IROp->Size) > MMBaseOffset) {
+          ResetSlots();
+        }
+      }
+      else if (IROp->Op == OP_SYSCALL ||
+               IROp->Op == OP_INLINESYSCALL) {
+        FEXCore::IR::SyscallFlags Flags{};
+        if (IROp->Op == OP_SYSCALL) {
+          Flags = IROp->C<IROp_Syscall>()->Flags;
+        }
+        else {
+          Flags = IROp->C<IROp_InlineSyscall>()->Flags;
+        }
+
+        if ((Flags & FEXCore::IR::SyscallFlags::OPTIMIZETHROUGH) != FEXCore::IR::SyscallFlags::OPTIMIZETHROUGH) {
+          ResetSlots();
+        }
+      }
+      else if (IROp->Op == OP_BREAK) {
+        ResetSlots();
+      }
+    }
+
+    // TOP was a constant, these no longer need the index
+    for (auto [Node, SlotIndex] : FixedSlotAccesses) {
+      auto IROp = Node->Op(CurrentIR.GetData())->CW<IR::IROp_Header>();
+      const uint32_t Offset = MMBaseOffset + SlotIndex * MMStride;
+      IREmit->SetWriteCursor(Node);
+
+      if (IROp->Op == OP_LOADCONTEXTINDEXED) {
+        IREmit->ReplaceAllUsesWith(Node, IREmit->_LoadContext(MMStride, FPRClass, Offset));
+      }
+      else {
+        auto Op = IROp->C<IROp_StoreContextIndexed>();
+        IREmit->_StoreContext(MMStride, FPRClass, CurrentIR.GetNode(Op->Value), Offset);
+        IREmit->Remove(Node);
+      }
+      Changed = true;
+    }
+  }
+
+  IREmit->SetWriteCursor(OriginalWriteCursor);
+
+  return Changed;
+}
+
+std::unique_ptr<FEXCore::IR::Pass> CreateX87StackOptimizationPass() {
+  return std::make_unique<X87StackOptimization>();
+}
+}
@@ -31,6 +31,8 @@ namespace Handler {
       return "1";
     else if (Value == "full")
       return "2";
+    else if (Value == "mtrack")
+      return "3";
     return "0";
   }
 }
@@ -50,6 +52,7 @@ namespace Handler {
     CONFIG_SMC_NONE,
     CONFIG_SMC_MMAN,
     CONFIG_SMC_FULL,
+    CONFIG_SMC_MTRACK,
   };
 
   enum class LayerType {
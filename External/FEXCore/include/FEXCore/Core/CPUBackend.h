@@ -30,6 +30,71 @@ class InterpreterCore;
 class JITCore;
 class LLVMCore;
 
+  /**
+   * @brief Relocation types for host code that is stored in the AOT code cache
+   *
+   * Host code is copied verbatim from the cache, anything that changes between processes must have a relocation
+   */
+  enum class RelocationTypes : uint32_t {
+    // 8 byte literal that holds a process specific host pointer, Data is a NamedSymbol
+    RELOC_NAMED_SYMBOL_LITERAL,
+    // 8 byte literal that holds a guest RIP
+    RELOC_GUEST_RIP_LITERAL,
+    // Fixed size host instruction sequence that moves a guest RIP in to a register, Data is the host register index
+    RELOC_GUEST_RIP_MOVE,
+  };
+
+  enum class NamedSymbol : uint32_t {
+    SYMBOL_EXIT_FUNCTION_LINKER,
+  };
+
+  struct Relocation {
+    RelocationTypes Type;
+    uint32_t Data;
+    // Offset from the start of the block's host code
+    uint64_t HostOffset;
+    // Guest RIPs are stored relative to the block's entry so the cache survives the guest module moving
+    int64_t GuestEntryOffset;
+  };
+
+  /**
+   * @brief A block of host code pulled out of the AOT code cache
+   */
+  struct RelocatableCode {
+    void const *HostCode;
+    uint64_t HostCodeSize;
+    Relocation const *Relocations;
+    uint64_t RelocationCount;
+  };
+
+  /**
+   * @brief Baseline tier instrumentation for a single block, see TierUpService
+   */
+  struct TierUpInstrumentation {
+    // Incremented by the block every time it is entered, doesn't need to be exact
+    uint64_t ExecutionCount;
+    // Filled by the CPUBackend, every entry to the block jumps through this pointer
+    // Overwriting it redirects the block to its optimized version, including already linked branches
+    uint64_t *EntryTarget;
+  };
+
+  /**
+   * @brief A block exit that the CPUBackend linked directly to another block
+   *
+   * Plain data so the LookupCache can store it without allocating
+   */
+  struct BlockLink {
+    // Backend specific location of the link, usually the exit's record
+    uintptr_t HostLink;
+    uintptr_t LinkerAddress;
+    // Restores the exit so it goes through LinkerAddress again
+    void (*Delinker)(uintptr_t HostLink, uintptr_t LinkerAddress);
+
+    void Delink() const {
+      Delinker(HostLink, LinkerAddress);
+    }
+  };
+
   class CPUBackend {
   public:
     virtual ~CPUBackend() = default;
@@ -92,6 +157,11 @@ class LLVMCore;
     virtual void CopyNecessaryDataForCompileThread(CPUBackend *Original) {}
     virtual bool IsAddressInJITCode(uint64_t Address, bool IncludeDispatcher = true, bool IncludeCompileService = true) const { return false; }
 
+    /**
+     * @brief Is the thread running a guest signal handler on top of interrupted JIT code
+     */
+    virtual bool IsInSignalHandler() const { return false; }
+
     /**
      * @brief Does this CPUBackend need its IR to stick around for correct emulation
      *
@@ -99,12 +169,40 @@ class LLVMCore;
      */
     virtual bool NeedsRetainedIRCopy() const { return false; }
 
+    /**
+     * @brief Copies host code from the AOT code cache in to this CPUBackend's code buffer and applies its relocations
+     *
+     * CPUBackends that support the code cache fill DebugData::Relocations during CompileCode
+     *
+     * @param Entry The guest RIP that this code is being loaded for
+     * @param Code The cached host code and its relocations
+     *
+     * @return The relocated host code or nullptr if this CPUBackend doesn't support cached code
+     */
+    [[nodiscard]] virtual void *RelocateJITObjectCode(uint64_t Entry, RelocatableCode const &Code) { return nullptr; }
+
+    /**
+     * @brief Marks the code generated by this CPUBackend as shared between guest threads
+     *
+     * Shared code can be executing on any thread at any time, so ClearCache must never rewind its code buffers
+     */
+    void SetSharedCode(bool Shared) { SharedCode = Shared; }
+
+    /**
+     * @brief Instruments the following CompileCode calls with an execution counter and a patchable entry
+     *
+     * Only the JITs support this, nullptr disables the instrumentation again
+     */
+    void SetTierUpInstrumentation(TierUpInstrumentation *Instrumentation) { TierUp = Instrumentation; }
+
     using AsmDispatch = FEX_NAKED void(*)(FEXCore::Core::CpuStateFrame *Frame);
     using JITCallback = FEX_NAKED void(*)(FEXCore::Core::CpuStateFrame *Frame, uint64_t RIP);
 
     JITCallback CallbackPtr{};
   protected:
     AsmDispatch DispatchPtr{};
+    bool SharedCode{};
+    TierUpInstrumentation *TierUp{};
   };
 
 }
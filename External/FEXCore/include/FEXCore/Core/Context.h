@@ -50,6 +50,8 @@ namespace FEXCore::Context {
   using CustomCPUFactoryType = std::function<std::unique_ptr<FEXCore::CPU::CPUBackend> (FEXCore::Context::Context*, FEXCore::Core::InternalThreadState *Thread)>;
 
   using ExitHandler = std::function<void(uint64_t ThreadId, FEXCore::Context::ExitReason)>;
+  using GuestSymbolResolverType = std::function<bool(const std::string &Filename, uint64_t FileOffset, std::string *Symbol, uint64_t *SymbolOffset)>;
+  using GuestFunctionBoundsResolverType = std::function<bool(const std::string &Filename, uint64_t FileOffset, uint64_t *FunctionOffset, uint64_t *FunctionLength)>;
 
   /**
    * @brief This initializes internal FEXCore state that is shared between contexts and requires overhead to setup
@@ -242,9 +244,26 @@ namespace FEXCore::Context {
   FEX_DEFAULT_VISIBILITY void SetAOTIRWriter(FEXCore::Context::Context *CTX, std::function<std::unique_ptr<std::ofstream>(const std::string&)> CacheWriter);
   FEX_DEFAULT_VISIBILITY void SetAOTIRRenamer(FEXCore::Context::Context *CTX, std::function<void(const std::string&)> CacheRenamer);
 
+  /**
+   * @brief Resolves an offset in a guest file to the symbol containing it
+   *
+   * Used to name blocks in the jitdump. Only ever called from the jitdump writer thread.
+   * Must be set before InitCore.
+   */
+  FEX_DEFAULT_VISIBILITY void SetGuestSymbolResolver(FEXCore::Context::Context *CTX, GuestSymbolResolverType Resolver);
+
+  /**
+   * @brief Resolves an offset in a guest file to the bounds of the function containing it
+   *
+   * Lets multiblock compile whole guest functions. Called from every thread that compiles code.
+   * Must be set before InitCore.
+   */
+  FEX_DEFAULT_VISIBILITY void SetGuestFunctionBoundsResolver(FEXCore::Context::Context *CTX, GuestFunctionBoundsResolverType Resolver);
+
   FEX_DEFAULT_VISIBILITY void FinalizeAOTIRCache(FEXCore::Context::Context *CTX);
   FEX_DEFAULT_VISIBILITY void WriteFilesWithCode(FEXCore::Context::Context *CTX, std::function<void(const std::string& fileid, const std::string& filename)> Writer);
   FEX_DEFAULT_VISIBILITY void FlushCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length);
+  FEX_DEFAULT_VISIBILITY void UnprotectCodeRange(FEXCore::Core::InternalThreadState *Thread, uint64_t Start, uint64_t Length);
 
   FEX_DEFAULT_VISIBILITY void ConfigureAOTGen(FEXCore::Core::InternalThreadState *Thread, std::set<uint64_t> *ExternalBranches, uint64_t SectionMaxAddress);
 }
@@ -78,10 +78,40 @@ namespace FEXCore::Core {
     OPINDEX_F80FPREM,
     OPINDEX_F80SCALE,
 
+    // String ops
+    OPINDEX_MEMSET_1,
+    OPINDEX_MEMSET_2,
+    OPINDEX_MEMSET_4,
+    OPINDEX_MEMSET_8,
+    OPINDEX_MEMCPY_1,
+    OPINDEX_MEMCPY_2,
+    OPINDEX_MEMCPY_4,
+    OPINDEX_MEMCPY_8,
+
     // Maximum
     OPINDEX_MAX,
   };
 
+  struct ReturnStackEntry {
+    uint64_t GuestRIP;
+    uint64_t HostCode;
+  };
+
+  // Must be a power of 2
+  constexpr size_t RETURN_STACK_ENTRIES = 32;
+  constexpr size_t RETURN_STACK_ENTRIES_MASK = RETURN_STACK_ENTRIES - 1;
+
+  // Both must be a power of 2
+  constexpr size_t INDIRECT_BRANCH_PROFILE_ENTRIES = 64;
+  constexpr size_t INDIRECT_BRANCH_PROFILE_TARGETS = 4;
+
+  struct IndirectBranchProfileEntry {
+    uint64_t Site;
+    uint64_t Count;
+    // The most recent targets, Count picks the one to overwrite
+    uint64_t Targets[INDIRECT_BRANCH_PROFILE_TARGETS];
+  };
+
   union JITPointers {
     struct {
       // Process specific
@@ -171,11 +201,39 @@ namespace FEXCore::Core {
     uint64_t InSyscallInfo{};
     InternalThreadState* Thread;
 
+    /**
+     * @brief Set when another thread invalidated code that this thread could have cached
+     *
+     * The dispatcher goes through the compiler at its loop top while this is set, which picks up the queued work.
+     */
+    uint64_t PendingCodeInvalidation{};
+
+    /**
+     * @brief Shadow stack of guest return addresses
+     *
+     * Guest CALLs push their return address along with the host code the L1 cache had for it.
+     * Guest RETs pop the top entry and branch straight to its host code if the guest returns where it was expected to,
+     * anything else falls back to the regular lookup. Overflowing wraps around and overwrites the oldest entries.
+     *
+     * Cleared whenever the thread's code is invalidated.
+     */
+    uint64_t ReturnStackTop{};
+    ReturnStackEntry ReturnStack[RETURN_STACK_ENTRIES]{};
+
+    /**
+     * @brief Targets of the indirect branches in baseline tier blocks
+     *
+     * Indexed by a hash of the branch's guest address, branches that share an entry overwrite each other.
+     * The TierUpService samples it to find the targets worth guarding in the optimized code.
+     */
+    IndirectBranchProfileEntry IndirectBranchProfile[INDIRECT_BRANCH_PROFILE_ENTRIES]{};
+
     // Pointers that the JIT needs to load to remove relocations
     JITPointers Pointers;
   };
   static_assert(offsetof(CpuStateFrame, State) == 0, "CPUState must be first member in CpuStateFrame");
   static_assert(offsetof(CpuStateFrame, State.rip) == 0, "rip must be zero offset in CpuStateFrame");
+  static_assert(offsetof(CpuStateFrame, ReturnStack) < 4096, "ReturnStack needs to fit in an arm64 add immediate");
   static_assert(offsetof(CpuStateFrame, Pointers) % 8 == 0, "JITPointers need to be aligned to 8 bytes");
   static_assert(offsetof(CpuStateFrame, Pointers) + sizeof(CpuStateFrame::Pointers) <= 32760, "JITPointers maximum pointer needs to be less than architecture maximum 32768");
 
@@ -69,6 +69,17 @@ namespace Core {
     // Called from the thunk handler to handle the signal
     void HandleSignal(int Signal, void *Info, void *UContext);
 
+    /**
+     * @brief Defers asynchronous signals on the calling thread until the matching LeaveCriticalSection
+     *
+     * A cheaper replacement for masking signals around code that a signal handler could reenter.
+     * A signal that arrives inside of the section gets recorded with its siginfo and stays blocked until the section
+     * is left, then the handlers run with the recorded siginfo. Synchronous signals are still handled immediately.
+     * Sections can nest.
+     */
+    static void EnterCriticalSection();
+    static void LeaveCriticalSection();
+
     constexpr static size_t MAX_SIGNALS {64};
 
     // Use the last signal just so we are less likely to ever conflict with something that the guest application is using
@@ -19,6 +19,13 @@ namespace Debug {
   uint64_t GetThreadCount(FEXCore::Context::Context *CTX);
   FEXCore::Core::RuntimeStats *GetRuntimeStatsForThread(FEXCore::Context::Context *CTX, uint64_t Thread);
 
+  /**
+   * @brief Gets the compilation statistics of all threads
+   *
+   * Empty unless the CompileStats option is enabled
+   */
+  FEX_DEFAULT_VISIBILITY FEXCore::Core::CompileStats GetCompileStats(FEXCore::Context::Context *CTX);
+
   bool GetDebugDataForRIP(FEXCore::Context::Context *CTX, uint64_t RIP, FEXCore::Core::DebugData *Data);
   bool FindHostCodeForRIP(FEXCore::Context::Context *CTX, uint64_t RIP, uint8_t **Code);
 	// XXX:
@@ -6,13 +6,19 @@
 #include <FEXCore/IR/RegisterAllocationData.h>
 #include <FEXCore/Utils/Event.h>
 #include <FEXCore/Utils/InterruptableConditionVariable.h>
+#include <FEXCore/Utils/ScratchArena.h>
 #include <FEXCore/Utils/Threads.h>
 
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace FEXCore {
   class LookupCache;
   class CompileService;
+  struct CodeInvalidationThreadData;
+  struct TierUpThreadData;
 }
 
 namespace FEXCore::Context {
@@ -28,6 +34,13 @@ namespace FEXCore::IR{
   class PassManager;
 }
 
+namespace FEXCore::CPU {
+  struct InterpretedBlock;
+  struct InterpretedBlockDeleter {
+    FEX_DEFAULT_VISIBILITY void operator()(InterpretedBlock *Block);
+  };
+}
+
 namespace FEXCore::Core {
 
   struct RuntimeStats {
@@ -35,6 +48,50 @@ namespace FEXCore::Core {
     std::atomic_uint64_t BlocksCompiled;
   };
 
+  /**
+   * @brief Totals of all the blocks compiled while the CompileStats option is enabled
+   *
+   * Times are in nanoseconds
+   */
+  struct CompileStats {
+    uint64_t BlocksCompiled;
+    uint64_t GuestInstructions;
+    uint64_t GuestCodeBytes;
+    uint64_t HostCodeBytes;
+
+    uint64_t DecodeTime;
+    uint64_t DispatchTime; ///< Time spent generating the IR from the decoded instructions
+    uint64_t BackendTime;
+    std::vector<std::pair<std::string, uint64_t>> PassTime; ///< Per IR pass in pipeline order, includes RA
+    uint64_t CompileWaitTime; ///< Time guest threads were stalled on compiles, background compiles only count while waited on
+
+    void AddPassTime(std::string const &Name, uint64_t Time) {
+      for (auto &[PassName, PassTotal] : PassTime) {
+        if (PassName == Name) {
+          PassTotal += Time;
+          return;
+        }
+      }
+
+      PassTime.emplace_back(Name, Time);
+    }
+
+    void Accumulate(CompileStats const &Other) {
+      BlocksCompiled += Other.BlocksCompiled;
+      GuestInstructions += Other.GuestInstructions;
+      GuestCodeBytes += Other.GuestCodeBytes;
+      HostCodeBytes += Other.HostCodeBytes;
+      DecodeTime += Other.DecodeTime;
+      DispatchTime += Other.DispatchTime;
+      BackendTime += Other.BackendTime;
+      CompileWaitTime += Other.CompileWaitTime;
+
+      for (auto &[Name, Time] : Other.PassTime) {
+        AddPassTime(Name, Time);
+      }
+    }
+  };
+
   struct DebugDataSubblock {
     uintptr_t HostCodeStart;
     uint32_t HostCodeSize;
@@ -48,6 +105,8 @@ namespace FEXCore::Core {
   struct DebugData {
     uint64_t HostCodeSize; ///< The size of the code generated in the host JIT
     std::vector<DebugDataSubblock> Subblocks;
+    std::vector<FEXCore::CPU::Relocation> Relocations; ///< Relocations for storing the host code in the AOT code cache
+    bool Relocatable{}; ///< Set by the CPUBackend if the code can be stored in the AOT code cache
   };
 
   enum class SignalEvent {
@@ -63,6 +122,10 @@ namespace FEXCore::Core {
     std::unique_ptr<FEXCore::IR::IRListView, FEXCore::IR::IRListViewDeleter> IR;
     std::unique_ptr<FEXCore::IR::RegisterAllocationData, FEXCore::IR::RegisterAllocationDataDeleter> RAData;
     std::unique_ptr<FEXCore::Core::DebugData> DebugData;
+    // Interpreter only, translated from the IR on first execution
+    std::unique_ptr<FEXCore::CPU::InterpretedBlock, FEXCore::CPU::InterpretedBlockDeleter> Interpreted{};
+    // IR and RAData packed with IR::PackIR, used instead of IR and RAData when the backend doesn't run the IR itself
+    std::vector<uint8_t> PackedIR{};
   };
 
   struct InternalThreadState {
@@ -95,10 +158,17 @@ namespace FEXCore::Core {
 
     RuntimeStats Stats{};
 
+    // Temporary storage for the syscall handlers, rewound when the syscall returns
+    FEXCore::Utils::ScratchArena SyscallScratch;
+
     int StatusCode{};
     FEXCore::Context::ExitReason ExitReason {FEXCore::Context::ExitReason::EXIT_WAITING};
     uint32_t CompileBlockReentrantRefCount{};
     std::shared_ptr<FEXCore::CompileService> CompileService;
+    // Only set for guest threads when tiered compilation is enabled, shared with the TierUpService's workers
+    std::shared_ptr<FEXCore::TierUpThreadData> TierUpData;
+    // Only set for guest threads, other threads queue code invalidations in to it
+    std::shared_ptr<FEXCore::CodeInvalidationThreadData> CodeInvalidationData;
     bool IsCompileService{false};
     bool DestroyedByParent{false};  // Should the parent destroy this thread, or it destory itself
 
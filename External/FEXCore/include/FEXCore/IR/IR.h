@@ -493,6 +493,12 @@ enum class SyscallFlags : uint8_t {
 
 FEX_DEF_NUM_OPS(SyscallFlags)
 
+// Bits of the MemSet and MemCpy $Flags argument
+enum MemOpFlags : uint64_t {
+  MEMOP_DIRECTION_DOWN = 1 << 0,
+  MEMOP_ADDRESS_32BIT  = 1 << 1,
+};
+
 #define IROP_ENUM
 #define IROP_STRUCTS
 #define IROP_SIZES
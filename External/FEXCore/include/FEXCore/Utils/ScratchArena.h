@@ -0,0 +1,161 @@
+#pragma once
+
+#include <FEXCore/Core/SignalDelegator.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <type_traits>
+
+namespace FEXCore::Utils {
+
+  /**
+   * @brief Bump allocator for short lived per-thread allocations
+   *
+   * Allocations are never freed individually, the owner takes a Marker before using it and rewinds to it once
+   * everything allocated after that point is dead. Up to MAX_RETAINED_SIZE of chunks are kept around after a rewind
+   * so a steady state of allocations doesn't touch the system allocator, anything past that is unmapped.
+   *
+   * Not thread safe, each thread needs its own. A signal handler can nest allocations in the middle of another one,
+   * the chunk list only changes with signals deferred.
+   */
+  class ScratchArena final {
+    // Header at the start of every chunk, the chunks form a list in the order they were allocated
+    struct Chunk {
+      Chunk *Next;
+      size_t Size;
+    };
+
+  public:
+    struct Marker {
+      Chunk *Current;
+      size_t Offset;
+    };
+
+    ScratchArena() = default;
+    ScratchArena(ScratchArena const&) = delete;
+    ScratchArena &operator=(ScratchArena const&) = delete;
+
+    ~ScratchArena() {
+      FreeChunks(Head);
+    }
+
+    /**
+     * @brief Allocates a value initialized array of Count elements
+     *
+     * Only for trivial types since nothing gets destructed on rewind
+     */
+    template<typename T>
+    T *Allocate(size_t Count) {
+      static_assert(std::is_trivially_destructible_v<T>, "Arena allocations are never destructed");
+      auto Data = reinterpret_cast<T*>(AllocateBytes(sizeof(T) * Count, alignof(T)));
+      std::uninitialized_value_construct_n(Data, Count);
+      return Data;
+    }
+
+    void *AllocateBytes(size_t Size, size_t Alignment) {
+      if (Current) {
+        const size_t Offset = AlignUp(CurrentOffset, Alignment);
+        if (Offset + Size <= Current->Size) {
+          CurrentOffset = Offset + Size;
+          return reinterpret_cast<uint8_t*>(Current) + Offset;
+        }
+      }
+
+      FEXCore::SignalDelegator::EnterCriticalSection();
+
+      // Try any chunk that a rewind left behind, then append a new one
+      const size_t Offset = AlignUp(sizeof(Chunk), Alignment);
+      Chunk **Link = Current ? &Current->Next : &Head;
+      while (*Link && Offset + Size > (*Link)->Size) {
+        Link = &(*Link)->Next;
+      }
+
+      if (!*Link) {
+        const size_t ChunkSize = AlignUp(std::max(Offset + Size, MIN_CHUNK_SIZE), MIN_CHUNK_SIZE);
+        auto Base = FEXCore::Allocator::mmap(nullptr, ChunkSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        LOGMAN_THROW_A_FMT(Base != MAP_FAILED, "Couldn't allocate {} byte scratch chunk", ChunkSize);
+
+        *Link = new (Base) Chunk{nullptr, ChunkSize};
+      }
+
+      Current = *Link;
+      CurrentOffset = Offset + Size;
+      auto Data = reinterpret_cast<uint8_t*>(Current) + Offset;
+
+      FEXCore::SignalDelegator::LeaveCriticalSection();
+      return Data;
+    }
+
+    Marker GetMarker() const {
+      return Marker{Current, CurrentOffset};
+    }
+
+    void Rewind(Marker const &Mark) {
+      if (Mark.Current == Current) {
+        // Still in the same chunk, nothing was appended
+        CurrentOffset = Mark.Offset;
+        return;
+      }
+
+      FEXCore::SignalDelegator::EnterCriticalSection();
+
+      Current = Mark.Current;
+      CurrentOffset = Mark.Offset;
+      if (!Current && Head) {
+        // Same position, but the next marker taken from here doesn't need the slow path
+        Current = Head;
+        CurrentOffset = sizeof(Chunk);
+      }
+
+      // Everything up to the marker is still in use
+      size_t Retained{};
+      Chunk **Link = &Head;
+      if (Current) {
+        for (auto It = Head; It != Current; It = It->Next) {
+          Retained += It->Size;
+        }
+        Retained += Current->Size;
+        Link = &Current->Next;
+      }
+
+      while (*Link && Retained + (*Link)->Size <= MAX_RETAINED_SIZE) {
+        Retained += (*Link)->Size;
+        Link = &(*Link)->Next;
+      }
+
+      auto Dead = *Link;
+      *Link = nullptr;
+
+      FEXCore::SignalDelegator::LeaveCriticalSection();
+
+      // Unreachable now, a nested allocation can't pick them up anymore
+      FreeChunks(Dead);
+    }
+
+  private:
+    constexpr static size_t MIN_CHUNK_SIZE = 64 * 1024;
+    constexpr static size_t MAX_RETAINED_SIZE = 256 * 1024;
+
+    static size_t AlignUp(size_t Value, size_t Alignment) {
+      return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    static void FreeChunks(Chunk *It) {
+      while (It) {
+        auto Next = It->Next;
+        FEXCore::Allocator::munmap(It, It->Size);
+        It = Next;
+      }
+    }
+
+    Chunk *Head{};
+    Chunk *Current{};
+    size_t CurrentOffset{};
+  };
+}
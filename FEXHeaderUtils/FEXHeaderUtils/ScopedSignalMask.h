@@ -1,46 +1,36 @@
 #pragma once
 
-#include <FEXCore/Utils/CompilerDefs.h>
-#include <FEXCore/Utils/LogManager.h>
-
-#include <cstdint>
 #include <mutex>
-#include <signal.h>
-#include <sys/syscall.h>
-#include <unistd.h>
 
 namespace FHU {
   /**
-   * @brief A class that masks signals and locks a mutex until it goes out of scope
+   * @brief A class that defers asynchronous signals and locks a mutex until it goes out of scope
    *
    * Constructor order:
-   * 1) Mask signals
+   * 1) Enter the signal critical section
    * 2) Lock Mutex
    *
    * Destructor Order:
    * 1) Unlock Mutex
-   * 2) Unmask signals
+   * 2) Leave the signal critical section
+   *
+   * DeferHooks provides static EnterCriticalSection and LeaveCriticalSection functions, FEXCore's SignalDelegator
+   * for anything that runs under FEX. No syscalls are made unless a signal arrives while it is held.
    */
-  class ScopedSignalMaskWithMutex final {
+  template<typename DeferHooks>
+  class ScopedSignalDeferWithMutex final {
     public:
-      ScopedSignalMaskWithMutex(std::mutex &_Mutex, uint64_t Mask = ~0ULL)
+      ScopedSignalDeferWithMutex(std::mutex &_Mutex)
         : Mutex {_Mutex} {
-        // Mask all signals, storing the original incoming mask
-        ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &Mask, &OriginalMask, sizeof(OriginalMask));
-
-        // Lock the mutex
+        DeferHooks::EnterCriticalSection();
         Mutex.lock();
       }
 
-      ~ScopedSignalMaskWithMutex() {
-        // Unlock the mutex
+      ~ScopedSignalDeferWithMutex() {
         Mutex.unlock();
-
-        // Unmask back to the original signal mask
-        ::syscall(SYS_rt_sigprocmask, SIG_SETMASK, &OriginalMask, nullptr, sizeof(OriginalMask));
+        DeferHooks::LeaveCriticalSection();
       }
     private:
-      uint64_t OriginalMask{};
       std::mutex &Mutex;
   };
 }
@@ -0,0 +1,126 @@
+#!/usr/bin/python3
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+# Runs every assembled test in the given directories through the BenchmarkRunner
+# Each test is run multiple times per core, the median of every statistic is reported
+#
+# Output is a JSON file of the form:
+# {
+#   "iterations": <Iterations>,
+#   "results": [
+#     { "test": <Test name>, "core": <Core>, "passed": <bool>, <median statistics from the BenchmarkRunner>... },
+#     ...
+#   ]
+# }
+
+CORE_ARGS = {
+    "irjit": ["-c", "irjit", "-n", "500", "--multiblock"],
+    "irint": ["-c", "irint", "-n", "500", "--multiblock"],
+}
+
+def find_tests(directories):
+    tests = []
+    for directory in directories:
+        for root, _, files in os.walk(directory):
+            for file in sorted(files):
+                if not file.endswith(".asm.bin"):
+                    continue
+
+                binary = os.path.join(root, file)
+                config = binary[:-len(".bin")] + ".config.bin"
+                if os.path.exists(config):
+                    tests.append((os.path.relpath(binary, directory)[:-len(".bin")], binary, config))
+    return tests
+
+def run_test(runner, core, binary, config, timeout):
+    with tempfile.NamedTemporaryFile(suffix=".json") as results:
+        try:
+            subprocess.run([runner] + CORE_ARGS[core] + [binary, config, results.name],
+                           stdout=subprocess.DEVNULL, timeout=timeout)
+        except subprocess.TimeoutExpired:
+            return None
+
+        try:
+            with open(results.name) as f:
+                return json.load(f)
+        except (OSError, json.JSONDecodeError):
+            return None
+
+def median_of_runs(runs):
+    result = {"passed": all(run["passed"] for run in runs)}
+    for key, value in runs[0].items():
+        if key == "passed":
+            continue
+        if isinstance(value, dict):
+            result[key] = {name: statistics.median(run[key].get(name, 0) for run in runs) for name in value}
+        else:
+            result[key] = statistics.median(run[key] for run in runs)
+    return result
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs the FEX benchmark corpus")
+    parser.add_argument("--runner", required=True, help="Path to the BenchmarkRunner")
+    parser.add_argument("--output", required=True, help="JSON file to write the results to")
+    parser.add_argument("--cores", default="irjit", help="Comma separated list of cores, any of: " + ", ".join(CORE_ARGS.keys()))
+    parser.add_argument("--iterations", type=int, default=3)
+    parser.add_argument("--timeout", type=int, default=300, help="Seconds before a single run is abandoned")
+    parser.add_argument("--filter", default="", help="Only run tests containing this string")
+    parser.add_argument("directories", nargs="+", help="Directories with assembled tests")
+    args = parser.parse_args()
+
+    cores = args.cores.split(",")
+    for core in cores:
+        if core not in CORE_ARGS:
+            print("Unknown core '{}'".format(core))
+            return 1
+
+    tests = [test for test in find_tests(args.directories) if args.filter in test[0]]
+    if not tests:
+        print("No tests found")
+        return 1
+
+    results = []
+    failures = 0
+    for name, binary, config in tests:
+        for core in cores:
+            runs = []
+            for _ in range(args.iterations):
+                run = run_test(args.runner, core, binary, config, args.timeout)
+                if run is None:
+                    break
+                runs.append(run)
+
+            if len(runs) != args.iterations:
+                print("{:<60} {:<6} did not finish".format(name, core))
+                results.append({"test": name, "core": core, "passed": False})
+                failures += 1
+                continue
+
+            result = {"test": name, "core": core}
+            result.update(median_of_runs(runs))
+            results.append(result)
+
+            if not result["passed"]:
+                failures += 1
+
+            print("{:<60} {:<6} {:>12.3f}ms exec {:>10.3f}ms compile {:>7.2f} host bytes/inst{}".format(
+                name, core,
+                result["execution_time_ns"] / 1e6,
+                result["compile_time_ns"] / 1e6,
+                result["host_bytes_per_guest_instruction"],
+                "" if result["passed"] else " FAILED"))
+
+    with open(args.output, "w") as f:
+        json.dump({"iterations": args.iterations, "results": results}, f, indent=2)
+
+    print("Wrote {} results to {}, {} failed".format(len(results), args.output, failures))
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -321,6 +321,60 @@ ELFSymbol const *ELFContainer::GetSymbolInRange(RangeType Address) {
   return Sym->second;
 }
 
+bool ELFContainer::GetAddressForFileOffset(uint64_t Offset, uint64_t *Address) const {
+  for (uint32_t i = 0; i < ProgramHeaders.size(); ++i) {
+    uint64_t Type, FileOffset, FileSize, VAddr;
+    if (Mode == MODE_32BIT) {
+      Elf32_Phdr const *hdr = ProgramHeaders.at(i)._32;
+      Type = hdr->p_type;
+      FileOffset = hdr->p_offset;
+      FileSize = hdr->p_filesz;
+      VAddr = hdr->p_vaddr;
+    }
+    else {
+      Elf64_Phdr const *hdr = ProgramHeaders.at(i)._64;
+      Type = hdr->p_type;
+      FileOffset = hdr->p_offset;
+      FileSize = hdr->p_filesz;
+      VAddr = hdr->p_vaddr;
+    }
+
+    if (Type == PT_LOAD && Offset >= FileOffset && Offset < (FileOffset + FileSize)) {
+      *Address = VAddr + (Offset - FileOffset);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ELFContainer::GetFileOffsetForAddress(uint64_t Address, uint64_t *Offset) const {
+  for (uint32_t i = 0; i < ProgramHeaders.size(); ++i) {
+    uint64_t Type, FileOffset, FileSize, VAddr;
+    if (Mode == MODE_32BIT) {
+      Elf32_Phdr const *hdr = ProgramHeaders.at(i)._32;
+      Type = hdr->p_type;
+      FileOffset = hdr->p_offset;
+      FileSize = hdr->p_filesz;
+      VAddr = hdr->p_vaddr;
+    }
+    else {
+      Elf64_Phdr const *hdr = ProgramHeaders.at(i)._64;
+      Type = hdr->p_type;
+      FileOffset = hdr->p_offset;
+      FileSize = hdr->p_filesz;
+      VAddr = hdr->p_vaddr;
+    }
+
+    if (Type == PT_LOAD && Address >= VAddr && Address < (VAddr + FileSize)) {
+      *Offset = FileOffset + (Address - VAddr);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void ELFContainer::CalculateMemoryLayouts() {
   uint64_t MinPhysAddr = ~0ULL;
   uint64_t MaxPhysAddr = 0;
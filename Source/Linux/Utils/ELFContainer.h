@@ -71,6 +71,10 @@ public:
   using RangeType = std::pair<uint64_t, uint64_t>;
   ELFSymbol const *GetSymbolInRange(RangeType Address);
 
+  // Maps a file offset to the address its PT_LOAD segment places it at
+  bool GetAddressForFileOffset(uint64_t Offset, uint64_t *Address) const;
+  bool GetFileOffsetForAddress(uint64_t Address, uint64_t *Offset) const;
+
   bool WasDynamic() const { return DynamicProgram; }
   bool HasDynamicLinker() const { return !DynamicLinker.empty(); }
   bool WasLoaded() const { return Loaded; }
@@ -0,0 +1,156 @@
+/*
+$info$
+tags: Bin|BenchmarkRunner
+desc: Runs an assembly test and reports compilation and execution statistics
+$end_info$
+*/
+
+#include "Common/ArgumentLoader.h"
+#include "CommonCore/HostFactory.h"
+#include "HarnessHelpers.h"
+#include "HarnessRunner.h"
+#include "Tests/LinuxSyscalls/LinuxAllocator.h"
+#include "Tests/LinuxSyscalls/Syscalls.h"
+#include "Tests/LinuxSyscalls/x32/Syscalls.h"
+#include "Tests/LinuxSyscalls/x64/Syscalls.h"
+#include "Tests/LinuxSyscalls/SignalDelegator.h"
+
+#include <FEXCore/Config/Config.h>
+#include <FEXCore/Core/Context.h>
+#include <FEXCore/Core/CoreState.h>
+#include <FEXCore/Core/CPUBackend.h>
+#include <FEXCore/Debug/ContextDebug.h>
+#include <FEXCore/Debug/InternalThreadState.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <chrono>
+#include <cstdint>
+#include <errno.h>
+#include <memory>
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace {
+// One JSON object per run, the benchmark script collects them
+// Compile time is the work done by every compile and can exceed the wall time when tiers compile in the background,
+// execution time only takes out the time the guest thread spent waiting on compiles
+std::string FormatResults(bool Passed, uint64_t WallTime, FEXCore::Core::CompileStats const &Stats) {
+  uint64_t CompileTime = Stats.DecodeTime + Stats.DispatchTime + Stats.BackendTime;
+
+  std::string Passes;
+  for (auto &[Name, Time] : Stats.PassTime) {
+    CompileTime += Time;
+    Passes += fmt::format("{}\"{}\": {}", Passes.empty() ? "" : ", ", Name, Time);
+  }
+
+  const double HostBytesPerInst = Stats.GuestInstructions ? static_cast<double>(Stats.HostCodeBytes) / Stats.GuestInstructions : 0.0;
+
+  return fmt::format(
+    "{{\"passed\": {}, \"wall_time_ns\": {}, \"compile_time_ns\": {}, \"compile_wait_time_ns\": {}, \"execution_time_ns\": {}, "
+    "\"blocks_compiled\": {}, \"guest_instructions\": {}, \"guest_code_bytes\": {}, \"host_code_bytes\": {}, "
+    "\"host_bytes_per_guest_instruction\": {:.3f}, "
+    "\"decode_time_ns\": {}, \"dispatch_time_ns\": {}, \"backend_time_ns\": {}, \"pass_time_ns\": {{{}}}}}\n",
+    Passed ? "true" : "false", WallTime, CompileTime, Stats.CompileWaitTime, WallTime > Stats.CompileWaitTime ? WallTime - Stats.CompileWaitTime : 0,
+    Stats.BlocksCompiled, Stats.GuestInstructions, Stats.GuestCodeBytes, Stats.HostCodeBytes,
+    HostBytesPerInst,
+    Stats.DecodeTime, Stats.DispatchTime, Stats.BackendTime, Passes);
+}
+}
+
+int main(int argc, char **argv, char **const envp) {
+  LogMan::Throw::InstallHandler(FEX::HarnessHelper::AssertHandler);
+  LogMan::Msg::InstallHandler(FEX::HarnessHelper::MsgHandler);
+  FEXCore::Config::Initialize();
+  FEXCore::Config::AddLayer(std::make_unique<FEX::ArgLoader::ArgLoader>(argc, argv));
+  FEXCore::Config::AddLayer(FEXCore::Config::CreateEnvironmentLayer(envp));
+  FEXCore::Config::Load();
+
+  auto Args = FEX::ArgLoader::Get();
+
+  if (Args.size() < 3) {
+    LogMan::Msg::EFmt("Usage: BenchmarkRunner [options] <Test binary> <Test config> <Results file>");
+    return -1;
+  }
+
+  FEX::HarnessHelper::HarnessCodeLoader Loader{Args[0], Args[1].c_str()};
+
+  // Adds in environment options from the test harness config
+  FEXCore::Config::AddLayer(std::make_unique<FEX::HarnessHelper::TestEnvLoader>(Loader.GetEnvironmentOptions()));
+  FEXCore::Config::ReloadMetaLayer();
+
+  FEXCore::Config::Set(FEXCore::Config::CONFIG_IS64BIT_MODE, Loader.Is64BitMode() ? "1" : "0");
+  FEXCore::Config::Set(FEXCore::Config::CONFIG_COMPILESTATS, "1");
+
+  FEXCore::Context::InitializeStaticTables(Loader.Is64BitMode() ? FEXCore::Context::MODE_64BIT : FEXCore::Context::MODE_32BIT);
+  auto CTX = FEXCore::Context::CreateNewContext();
+
+  FEXCore::Context::SetCustomCPUBackendFactory(CTX, HostFactory::CPUCreationFactory);
+
+  FEXCore::Context::InitializeContext(CTX);
+
+  std::unique_ptr<FEX::HLE::MemAllocator> Allocator;
+
+  if (!FEX::HarnessHelper::MapTestMemory(Loader, Allocator)) {
+    // failed to map
+    return -ENOEXEC;
+  }
+
+  auto SignalDelegation = std::make_unique<FEX::HLE::SignalDelegator>();
+  auto SyscallHandler = Loader.Is64BitMode() ? FEX::HLE::x64::CreateHandler(CTX, SignalDelegation.get())
+                                             : FEX::HLE::x32::CreateHandler(CTX, SignalDelegation.get(), std::move(Allocator));
+
+  bool DidFault = false;
+  SignalDelegation->RegisterFrontendHostSignalHandler(SIGSEGV, [&DidFault](FEXCore::Core::InternalThreadState *Thread, int Signal, void *info, void *ucontext) {
+      DidFault = true;
+    return false;
+  }, true);
+
+  FEXCore::Context::SetSignalDelegator(CTX, SignalDelegation.get());
+  FEXCore::Context::SetSyscallHandler(CTX, SyscallHandler.get());
+  bool Result1 = FEXCore::Context::InitCore(CTX, &Loader);
+
+  if (!Result1)
+    return 1;
+
+  auto Start = std::chrono::steady_clock::now();
+  FEXCore::Context::RunUntilExit(CTX);
+  auto WallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start);
+
+  // A benchmark that computes the wrong result doesn't measure anything
+  FEXCore::Core::CPUState State;
+  FEXCore::Context::GetCPUState(CTX, &State);
+  bool Passed = !DidFault && Loader.CompareStates(&State, nullptr);
+
+  auto Results = FormatResults(Passed, WallTime.count(), FEXCore::Context::Debug::GetCompileStats(CTX));
+
+  if (FILE *fp = fopen(Args[2].c_str(), "wb")) {
+    fwrite(Results.data(), 1, Results.size(), fp);
+    fclose(fp);
+  }
+  else {
+    LogMan::Msg::EFmt("Couldn't open results file '{}'", Args[2]);
+    Passed = false;
+  }
+
+  SyscallHandler.reset();
+  SignalDelegation.reset();
+
+  FEXCore::Context::DestroyContext(CTX);
+  FEXCore::Context::ShutdownStaticTables();
+
+  FEXCore::Config::Shutdown();
+
+  LogMan::Throw::UnInstallHandlers();
+  LogMan::Msg::UnInstallHandlers();
+
+  FEXCore::Allocator::ClearHooks();
+
+  return Passed ? 0 : -1;
+}
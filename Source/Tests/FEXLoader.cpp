@@ -25,6 +25,7 @@ $end_info$
 #include <FEXCore/Utils/Telemetry.h>
 #include <FEXCore/Utils/Threads.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
 #include <cstdint>
@@ -35,6 +36,8 @@ $end_info$
 #include <fcntl.h>
 #include <fstream>
 #include <filesystem>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -47,6 +50,7 @@ $end_info$
 #include <system_error>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -108,6 +112,60 @@ void AssertHandler(char const *Message) {
   fsync(OutputFD);
 }
 
+/**
+ * @brief Function start to end of the ELF file, in file offsets
+ *
+ * Files without any function information end up empty so they aren't parsed again
+ */
+std::map<uint64_t, uint64_t> LoadFunctionBounds(const std::string &Filename) {
+  std::map<uint64_t, uint64_t> Bounds;
+
+  if (!ELFLoader::ELFContainer::IsSupportedELF(Filename)) {
+    return Bounds;
+  }
+
+  ELFLoader::ELFContainer Container{Filename, std::string{}, true};
+  if (!Container.WasLoaded()) {
+    return Bounds;
+  }
+
+  auto AddFunction = [&](uint64_t Address, uint64_t Size) {
+    uint64_t Offset{};
+    if (!Container.GetFileOffsetForAddress(Address, &Offset)) {
+      return;
+    }
+
+    // Zero means the end is the next function's start
+    auto &End = Bounds[Offset];
+    End = std::max(End, Size ? Offset + Size : 0);
+  };
+
+  Container.AddSymbols([&](ELFLoader::ELFSymbol *Sym) {
+    if (Sym->Type == STT_FUNC) {
+      AddFunction(Sym->Address, Sym->Size);
+    }
+  });
+
+  // Unwind entries only know where the function starts
+  Container.AddUnwindEntries([&](uintptr_t Entry) {
+    AddFunction(Entry, 0);
+  });
+
+  for (auto Function = Bounds.begin(); Function != Bounds.end();) {
+    auto Next = std::next(Function);
+    if (!Function->second) {
+      if (Next == Bounds.end()) {
+        // Nothing to tell where the last one ends
+        Bounds.erase(Function);
+        break;
+      }
+      Function->second = Next->first;
+    }
+    Function = Next;
+  }
+
+  return Bounds;
+}
 } // Anonymous namespace
 
 void InterpreterHandler(std::string *Filename, std::string const &RootFS, std::vector<std::string> *args) {
@@ -232,6 +290,9 @@ int main(int argc, char **argv, char **const envp) {
   FEX_CONFIG_OPT(AOTIRCapture, AOTIRCAPTURE);
   FEX_CONFIG_OPT(AOTIRGenerate, AOTIRGENERATE);
   FEX_CONFIG_OPT(AOTIRLoad, AOTIRLOAD);
+  FEX_CONFIG_OPT(AOTCodeCapture, AOTCODECAPTURE);
+  FEX_CONFIG_OPT(AOTCodeLoad, AOTCODELOAD);
+  FEX_CONFIG_OPT(JITDump, JITDUMP);
   FEX_CONFIG_OPT(OutputLog, OUTPUTLOG);
   FEX_CONFIG_OPT(OutputSocket, OUTPUTSOCKET);
   FEX_CONFIG_OPT(LDPath, ROOTFS);
@@ -404,6 +465,89 @@ int main(int argc, char **argv, char **const envp) {
 
   FEXCore::Context::SetSignalDelegator(CTX, SignalDelegation.get());
   FEXCore::Context::SetSyscallHandler(CTX, SyscallHandler.get());
+
+  if (JITDump()) {
+    // Names jitdump blocks from the guest ELF symbol tables
+    // Only the jitdump writer thread calls this, so the cache doesn't need a lock
+    FEXCore::Context::SetGuestSymbolResolver(CTX,
+      [Containers = std::make_shared<std::unordered_map<std::string, std::unique_ptr<ELFLoader::ELFContainer>>>()]
+      (const std::string &Filename, uint64_t FileOffset, std::string *Symbol, uint64_t *SymbolOffset) -> bool {
+      auto It = Containers->find(Filename);
+      if (It == Containers->end()) {
+        std::unique_ptr<ELFLoader::ELFContainer> Container;
+        if (ELFLoader::ELFContainer::IsSupportedELF(Filename)) {
+          // Only the symbol table is needed, don't chase the interpreter
+          Container = std::make_unique<ELFLoader::ELFContainer>(Filename, std::string{}, true);
+          if (!Container->WasLoaded()) {
+            Container.reset();
+          }
+        }
+
+        // Negative results are cached as well
+        It = Containers->emplace(Filename, std::move(Container)).first;
+      }
+
+      if (!It->second) {
+        return false;
+      }
+
+      uint64_t Address{};
+      if (!It->second->GetAddressForFileOffset(FileOffset, &Address)) {
+        return false;
+      }
+
+      auto Sym = It->second->GetSymbolInRange(std::make_pair(Address, 1));
+      if (!Sym || Sym->Address > Address || !Sym->Name || !Sym->Name[0]) {
+        return false;
+      }
+
+      *Symbol = Sym->Name;
+      *SymbolOffset = Address - Sym->Address;
+      return true;
+    });
+  }
+
+  // Function bounds from the symbol tables and the .eh_frame_hdr, so multiblock can compile whole functions
+  // Every compiling thread calls this. The lock only covers finding the file's entry, each file gets parsed once
+  // outside of it so threads that compile code from other files don't wait on the parse
+  struct FileFunctions {
+    std::once_flag Parsed;
+    std::map<uint64_t, uint64_t> Bounds;
+  };
+
+  FEXCore::Context::SetGuestFunctionBoundsResolver(CTX,
+    [FunctionsMutex = std::make_shared<std::mutex>(),
+     Functions = std::make_shared<std::unordered_map<std::string, std::shared_ptr<FileFunctions>>>()]
+    (const std::string &Filename, uint64_t FileOffset, uint64_t *FunctionOffset, uint64_t *FunctionLength) -> bool {
+    std::shared_ptr<FileFunctions> File;
+    {
+      std::scoped_lock lk(*FunctionsMutex);
+      auto &Entry = (*Functions)[Filename];
+      if (!Entry) {
+        Entry = std::make_shared<FileFunctions>();
+      }
+      File = Entry;
+    }
+
+    std::call_once(File->Parsed, [&] {
+      File->Bounds = LoadFunctionBounds(Filename);
+    });
+
+    auto Function = File->Bounds.upper_bound(FileOffset);
+    if (Function == File->Bounds.begin()) {
+      return false;
+    }
+    --Function;
+
+    if (FileOffset >= Function->second) {
+      return false;
+    }
+
+    *FunctionOffset = Function->first;
+    *FunctionLength = Function->second - Function->first;
+    return true;
+  });
+
   FEXCore::Context::InitCore(CTX, &Loader);
 
   FEXCore::Context::ExitReason ShutdownReason = FEXCore::Context::ExitReason::EXIT_SHUTDOWN;
@@ -418,7 +562,7 @@ int main(int argc, char **argv, char **const envp) {
     });
   }
 
-  if (AOTIRLoad() || AOTIRCapture() || AOTIRGenerate()) {
+  if (AOTIRLoad() || AOTIRCapture() || AOTIRGenerate() || AOTCodeLoad() || AOTCodeCapture()) {
     LogMan::Msg::IFmt("Warning: AOTIR is experimental, and might lead to crashes. "
                       "Capture doesn't work with programs that fork.");
   }
@@ -473,7 +617,7 @@ int main(int argc, char **argv, char **const envp) {
     });
   }
 
-  if (AOTIRCapture() || AOTIRGenerate()) {
+  if (AOTIRCapture() || AOTIRGenerate() || AOTCodeCapture()) {
     FEXCore::Context::FinalizeAOTIRCache(CTX);
     LogMan::Msg::IFmt("AOTIR Cache Stored");
   }
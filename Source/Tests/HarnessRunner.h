@@ -0,0 +1,140 @@
+#pragma once
+
+#include "HarnessHelpers.h"
+#include "Tests/LinuxSyscalls/LinuxAllocator.h"
+#include "Tests/LinuxSyscalls/Syscalls.h"
+
+#include <FEXCore/Config/Config.h>
+#include <FEXCore/Utils/Allocator.h>
+#include <FEXCore/Utils/LogManager.h>
+
+#include <memory>
+#include <optional>
+#include <stdio.h>
+#include <string_view>
+#include <sys/types.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+// Setup shared between TestHarnessRunner and BenchmarkRunner
+namespace FEX::HarnessHelper {
+  inline void MsgHandler(LogMan::DebugLevels Level, char const *Message) {
+    const char *CharLevel{nullptr};
+
+    switch (Level) {
+    case LogMan::NONE:
+      CharLevel = "NONE";
+      break;
+    case LogMan::ASSERT:
+      CharLevel = "ASSERT";
+      break;
+    case LogMan::ERROR:
+      CharLevel = "ERROR";
+      break;
+    case LogMan::DEBUG:
+      CharLevel = "DEBUG";
+      break;
+    case LogMan::INFO:
+      CharLevel = "Info";
+      break;
+    default:
+      CharLevel = "???";
+      break;
+    }
+    fmt::print("[{}] {}\n", CharLevel, Message);
+  }
+
+  inline void AssertHandler(char const *Message) {
+    fmt::print("[ASSERT] {}\n", Message);
+
+    // make sure buffers are flushed
+    fflush(nullptr);
+  }
+
+  // Claims to be a local application config layer
+  class TestEnvLoader final : public FEXCore::Config::Layer {
+  public:
+    explicit TestEnvLoader(std::vector<std::pair<std::string_view, std::string_view>> _Env)
+      : FEXCore::Config::Layer(FEXCore::Config::LayerType::LAYER_LOCAL_APP)
+      , Env {std::move(_Env)} {
+      Load();
+    }
+
+    void Load() override {
+      static const std::vector<std::pair<const char*, FEXCore::Config::ConfigOption>> EnvConfigLookup = {{
+#define OPT_BASE(type, group, enum, json, default) {"FEX_" #enum, FEXCore::Config::ConfigOption::CONFIG_##enum},
+#include <FEXCore/Config/ConfigValues.inl>
+      }};
+
+      std::unordered_map<std::string_view, std::string_view> EnvMap;
+      for (auto &Option : Env) {
+        std::string_view Key = Option.first;
+        std::string_view Value = Option.second;
+
+#define ENVLOADER
+#include <FEXCore/Config/ConfigOptions.inl>
+
+        EnvMap.insert_or_assign(Key, Value);
+      }
+
+      auto GetVar = [&](const std::string_view id) -> std::optional<std::string_view> {
+        const auto it = EnvMap.find(id);
+        if (it == EnvMap.end())
+          return std::nullopt;
+
+        return it->second;
+      };
+
+      for (auto &it : EnvConfigLookup) {
+        if (auto Value = GetVar(it.first); Value) {
+          Set(it.second, *Value);
+        }
+      }
+    }
+
+  private:
+    std::vector<std::pair<std::string_view, std::string_view>> Env;
+  };
+
+  /**
+   * @brief Maps the test in to guest memory
+   *
+   * 32-bit tests get the allocator they were mapped with back in Allocator, the syscall handler takes ownership of it
+   */
+  inline bool MapTestMemory(HarnessCodeLoader &Loader, std::unique_ptr<FEX::HLE::MemAllocator> &Allocator) {
+    if (Loader.Is64BitMode()) {
+      return Loader.MapMemory([](void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
+        return FEXCore::Allocator::mmap(addr, length, prot, flags, fd, offset);
+      }, [](void *addr, size_t length) {
+        return FEXCore::Allocator::munmap(addr, length);
+      });
+    }
+
+    // Setup our userspace allocator
+    uint32_t KernelVersion = FEX::HLE::SyscallHandler::CalculateHostKernelVersion();
+    if (KernelVersion >= FEX::HLE::SyscallHandler::KernelVersion(4, 17)) {
+      FEXCore::Allocator::SetupHooks();
+    }
+
+    if (KernelVersion < FEX::HLE::SyscallHandler::KernelVersion(4, 17)) {
+      Allocator = FEX::HLE::Create32BitAllocator();
+    }
+    else {
+      Allocator = FEX::HLE::CreatePassthroughAllocator();
+    }
+
+    if (!Loader.MapMemory([&Allocator](void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
+      return Allocator->mmap(addr, length, prot, flags, fd, offset);
+    }, [&Allocator](void *addr, size_t length) {
+      return Allocator->munmap(addr, length);
+    })) {
+      LogMan::Msg::EFmt("Failed to map 32-bit elf file.");
+      return false;
+    }
+
+    return true;
+  }
+}
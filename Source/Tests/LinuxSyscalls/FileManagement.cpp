@@ -10,6 +10,7 @@ $end_info$
 #include "Tests/LinuxSyscalls/Syscalls.h"
 #include "Tests/LinuxSyscalls/x64/Syscalls.h"
 
+#include <FEXCore/Core/SignalDelegator.h>
 #include <FEXCore/Utils/LogManager.h>
 #include <FEXHeaderUtils/ScopedSignalMask.h>
 #include <FEXHeaderUtils/Syscalls.h>
@@ -273,10 +274,32 @@ FileManager::FileManager(FEXCore::Context::Context *ctx)
     }
   }
 
+  auto RootFSPath = LDPath();
+  if (!RootFSPath.empty()) {
+    RootFSFD = ::open(RootFSPath.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (RootFSFD != -1) {
+      int HighFD = ::fcntl(RootFSFD, F_DUPFD_CLOEXEC, ROOTFS_FD_BASE);
+      if (HighFD != -1) {
+        ::close(RootFSFD);
+        RootFSFD = HighFD;
+      }
+
+      // openat2 is 5.6+, older kernels keep resolving symlinks by hand
+      int TestFD = OpenInRootFS("/", O_PATH | O_DIRECTORY | O_CLOEXEC, 0);
+      if (TestFD != -1) {
+        SupportsResolveInRoot = true;
+        ::close(TestFD);
+      }
+    }
+  }
+
   UpdatePID(::getpid());
 }
 
 FileManager::~FileManager() {
+  if (RootFSFD != -1) {
+    ::close(RootFSFD);
+  }
 }
 
 std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlink) {
@@ -296,6 +319,20 @@ std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlin
     return {};
   }
 
+  if (IsMissingFromRootFS(pathname)) {
+    return {};
+  }
+
+  uint64_t Generation{};
+  if (FollowSymlink) {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+    auto it = RootFSResolvedPaths.find(pathname);
+    if (it != RootFSResolvedPaths.end()) {
+      return it->second;
+    }
+    Generation = RootFSCacheGeneration;
+  }
+
   std::string Path = RootFSPath + pathname;
   if (FollowSymlink) {
     std::error_code ec;
@@ -308,10 +345,152 @@ std::string FileManager::GetEmulatedPath(const char *pathname, bool FollowSymlin
         break;
       }
     }
+
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+    if (Generation == RootFSCacheGeneration) {
+      if (RootFSResolvedPaths.size() >= ROOTFS_CACHE_SIZE) {
+        RootFSResolvedPaths.clear();
+      }
+      RootFSResolvedPaths.emplace(pathname, Path);
+    }
   }
   return Path;
 }
 
+FileManager::EmulatedFDPath FileManager::GetEmulatedFDPath(const char *pathname, bool FollowSymlink, std::string *Storage) {
+  if (!pathname || // If no pathname
+      pathname[0] != '/' || // If relative
+      strcmp(pathname, "/") == 0) { // If we are getting root
+    return {-1, nullptr};
+  }
+
+  auto thunkOverlay = ThunkOverlays.find(pathname);
+  if (thunkOverlay != ThunkOverlays.end()) {
+    return {AT_FDCWD, thunkOverlay->second.c_str()};
+  }
+
+  if (FollowSymlink || RootFSFD == -1) {
+    *Storage = GetEmulatedPath(pathname, FollowSymlink);
+    return {AT_FDCWD, Storage->empty() ? nullptr : Storage->c_str()};
+  }
+
+  if (IsMissingFromRootFS(pathname)) {
+    return {-1, nullptr};
+  }
+
+  // Relative to the rootfs fd, a path made of only slashes is the rootfs itself
+  while (pathname[0] == '/') {
+    ++pathname;
+  }
+  return {RootFSFD, pathname[0] ? pathname : "."};
+}
+
+bool FileManager::CanOpenInRootFS(const char *pathname) {
+  return SupportsResolveInRoot &&
+         pathname &&
+         pathname[0] == '/' && // If relative
+         strcmp(pathname, "/") != 0 && // Root stays the host's
+         !ThunkOverlays.contains(pathname) &&
+         !IsMissingFromRootFS(pathname);
+}
+
+int FileManager::OpenInRootFS(const char *pathname, uint64_t flags, uint64_t mode) {
+#ifndef RESOLVE_IN_ROOT
+#define RESOLVE_IN_ROOT 0x10
+#endif
+  // openat2 rejects a mode that won't be used
+  FEX::HLE::open_how how {
+    .flags = flags,
+    .mode = (flags & (O_CREAT | O_TMPFILE)) ? mode : 0,
+    .resolve = RESOLVE_IN_ROOT,
+  };
+
+  int fd = -1;
+  for (int i = 0; i < ROOTFS_RESOLVE_RETRIES; ++i) {
+    fd = ::syscall(SYSCALL_DEF(openat2), RootFSFD, pathname, &how, sizeof(how));
+    if (fd != -1 || errno != EAGAIN) {
+      break;
+    }
+  }
+  return fd;
+}
+
+bool FileManager::IsMissingFromRootFS(std::string_view Path) {
+  FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+  if (RootFSMissingDirs.empty()) {
+    return false;
+  }
+
+  // Check every parent, eg. /usr/lib/tls missing covers everything under it
+  for (size_t i = Path.find('/', 1); i != std::string_view::npos; i = Path.find('/', i + 1)) {
+    if (RootFSMissingDirs.contains(Path.substr(0, i))) {
+      return true;
+    }
+  }
+
+  return RootFSMissingDirs.contains(Path);
+}
+
+void FileManager::NoteRootFSMiss(const char *pathname) {
+  // Only a missing entry is worth remembering, anything else could be permissions
+  if (errno != ENOENT ||
+      !pathname ||
+      pathname[0] != '/' ||
+      ThunkOverlays.contains(pathname)) {
+    return;
+  }
+
+  // The entry itself could be a dangling symlink, its parent directory is only ever walked through
+  std::string_view Parent = pathname;
+  Parent = Parent.substr(0, Parent.find_last_of('/'));
+  if (Parent.empty()) {
+    return;
+  }
+
+  uint64_t Generation{};
+  {
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+    if (RootFSPresentDirs.contains(Parent)) {
+      return;
+    }
+    Generation = RootFSCacheGeneration;
+  }
+
+  bool Missing{};
+  if (SupportsResolveInRoot) {
+    // Resolves the parent the same way the lookup that missed did, symlinks in the rootfs included
+    int fd = OpenInRootFS(std::string(Parent).c_str(), O_PATH | O_CLOEXEC, 0);
+    Missing = fd == -1 && errno == ENOENT;
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+  else {
+    struct stat Buf{};
+    const auto RootFSPath = LDPath();
+    Missing = ::lstat((RootFSPath + std::string(Parent)).c_str(), &Buf) == -1 && errno == ENOENT;
+  }
+
+  FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+  if (Generation != RootFSCacheGeneration) {
+    return;
+  }
+
+  auto &Dirs = Missing ? RootFSMissingDirs : RootFSPresentDirs;
+  if (Dirs.size() >= ROOTFS_CACHE_SIZE) {
+    Dirs.clear();
+  }
+  Dirs.emplace(Parent);
+}
+
+void FileManager::InvalidateRootFSCache() {
+  FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(RootFSCacheLock);
+  ++RootFSCacheGeneration;
+  RootFSMissingDirs.clear();
+  RootFSPresentDirs.clear();
+  RootFSResolvedPaths.clear();
+}
+
 
 std::optional<std::string> FileManager::GetSelf(const char *Pathname) {
   if (!Pathname) {
@@ -337,8 +516,13 @@ uint64_t FileManager::Open(const char *pathname, [[maybe_unused]] int flags, [[m
 }
 
 uint64_t FileManager::Close(int fd) {
+  if (IsRootFSFD(fd)) {
+    errno = EBADF;
+    return -1;
+  }
+
   {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(FDLock);
     FDToNameMap.erase(fd);
   }
   return ::close(fd);
@@ -352,12 +536,28 @@ uint64_t FileManager::CloseRange(unsigned int first, unsigned int last, unsigned
   if (!(flags & CLOSE_RANGE_CLOEXEC)) {
     // If the flag was set then it doesn't actually close the FDs
     // Just sets the flag on a range
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(FDLock);
     for (unsigned int i = first; i <= last; ++i) {
       // We remove from first to last inclusive
       FDToNameMap.erase(i);
     }
   }
+
+  if (RootFSFD != -1 &&
+      !(flags & CLOSE_RANGE_CLOEXEC) &&
+      first <= static_cast<unsigned int>(RootFSFD) &&
+      last >= static_cast<unsigned int>(RootFSFD)) {
+    // Keep the rootfs fd open by closing around it
+    uint64_t Result{};
+    if (first != static_cast<unsigned int>(RootFSFD)) {
+      Result = ::syscall(SYSCALL_DEF(close_range), first, RootFSFD - 1, flags);
+    }
+    if (Result != -1 && last != static_cast<unsigned int>(RootFSFD)) {
+      Result = ::syscall(SYSCALL_DEF(close_range), RootFSFD + 1, last, flags);
+    }
+    return Result;
+  }
+
   return ::syscall(SYSCALL_DEF(close_range), first, last, flags);
 }
 
@@ -371,6 +571,7 @@ uint64_t FileManager::Stat(const char *pathname, void *buf) {
     uint64_t Result = ::stat(Path.c_str(), reinterpret_cast<struct stat*>(buf));
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
   return ::stat(SelfPath, reinterpret_cast<struct stat*>(buf));
 }
@@ -380,11 +581,13 @@ uint64_t FileManager::Lstat(const char *pathname, void *buf) {
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
   // lstat does not follow symlinks
-  auto Path = GetEmulatedPath(SelfPath, false);
-  if (!Path.empty()) {
-    uint64_t Result = ::lstat(Path.c_str(), reinterpret_cast<struct stat*>(buf));
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, false, &Storage);
+  if (Path) {
+    uint64_t Result = ::fstatat(FD, Path, reinterpret_cast<struct stat*>(buf), AT_SYMLINK_NOFOLLOW);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
 
   return ::lstat(pathname, reinterpret_cast<struct stat*>(buf));
@@ -400,6 +603,7 @@ uint64_t FileManager::Access(const char *pathname, [[maybe_unused]] int mode) {
     uint64_t Result = ::access(Path.c_str(), mode);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
 
   return ::access(SelfPath, mode);
@@ -409,11 +613,13 @@ uint64_t FileManager::FAccessat(int dirfd, const char *pathname, int mode) {
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath);
-  if (!Path.empty()) {
-    uint64_t Result = ::syscall(SYS_faccessat, dirfd, Path.c_str(), mode);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, false, &Storage);
+  if (Path) {
+    uint64_t Result = ::syscall(SYS_faccessat, FD, Path, mode);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
 
   return ::syscall(SYS_faccessat, dirfd, SelfPath, mode);
@@ -423,11 +629,13 @@ uint64_t FileManager::FAccessat2(int dirfd, const char *pathname, int mode, int
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0);
-  if (!Path.empty()) {
-    uint64_t Result = ::syscall(SYSCALL_DEF(faccessat2), dirfd, Path.c_str(), mode, flags);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0, &Storage);
+  if (Path) {
+    uint64_t Result = ::syscall(SYSCALL_DEF(faccessat2), FD, Path, mode, flags);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
 
   return ::syscall(SYSCALL_DEF(faccessat2), dirfd, SelfPath, mode, flags);
@@ -447,9 +655,10 @@ uint64_t FileManager::Readlink(const char *pathname, char *buf, size_t bufsiz) {
     return std::min(bufsiz, App.size());
   }
 
-  auto Path = GetEmulatedPath(pathname);
-  if (!Path.empty()) {
-    uint64_t Result = ::readlink(Path.c_str(), buf, bufsiz);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(pathname, false, &Storage);
+  if (Path) {
+    uint64_t Result = ::readlinkat(FD, Path, buf, bufsiz);
     if (Result != -1)
       return Result;
 
@@ -459,6 +668,7 @@ uint64_t FileManager::Readlink(const char *pathname, char *buf, size_t bufsiz) {
       // This is expected behaviour
       return -errno;
     }
+    NoteRootFSMiss(pathname);
   }
 
   return ::readlink(pathname, buf, bufsiz);
@@ -468,11 +678,13 @@ uint64_t FileManager::Chmod(const char *pathname, mode_t mode) {
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath);
-  if (!Path.empty()) {
-    uint64_t Result = ::chmod(Path.c_str(), mode);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, false, &Storage);
+  if (Path) {
+    uint64_t Result = ::fchmodat(FD, Path, mode, 0);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
 
   return ::chmod(SelfPath, mode);
@@ -524,9 +736,9 @@ uint64_t FileManager::Readlinkat(int dirfd, const char *pathname, char *buf, siz
     return std::min(bufsiz, App.size());
   }
 
-  Path = GetEmulatedPath(pathname);
-  if (!Path.empty()) {
-    uint64_t Result = ::readlinkat(dirfd, Path.c_str(), buf, bufsiz);
+  auto [FD, EmulatedPath] = GetEmulatedFDPath(pathname, false, &Path);
+  if (EmulatedPath) {
+    uint64_t Result = ::readlinkat(FD, EmulatedPath, buf, bufsiz);
     if (Result != -1)
       return Result;
 
@@ -536,6 +748,7 @@ uint64_t FileManager::Readlinkat(int dirfd, const char *pathname, char *buf, siz
       // This is expected behaviour
       return -errno;
     }
+    NoteRootFSMiss(pathname);
   }
 
   return ::readlinkat(dirfd, pathname, buf, bufsiz);
@@ -549,9 +762,24 @@ uint64_t FileManager::Openat([[maybe_unused]] int dirfs, const char *pathname, i
 
   fd = EmuFD.OpenAt(dirfs, SelfPath, flags, mode);
   if (fd == -1) {
-    auto Path = GetEmulatedPath(SelfPath, true);
+    bool Resolved = false;
+    if (CanOpenInRootFS(SelfPath)) {
+      fd = OpenInRootFS(SelfPath, flags, mode);
+      // openat2 rejects flags that openat ignores, let those take the slow path
+      // A lookup that kept racing with renames takes it as well
+      Resolved = fd != -1 || (errno != EINVAL && errno != EAGAIN);
+      // Any other failure falls back to the host path like the slow path does, e.g. a read-only rootfs's EROFS
+      if (fd == -1 && errno == ENOENT) {
+        NoteRootFSMiss(SelfPath);
+      }
+    }
+
+    auto Path = Resolved ? std::string{} : GetEmulatedPath(SelfPath, true);
     if (!Path.empty()) {
       fd = ::openat(dirfs, Path.c_str(), flags, mode);
+      if (fd == -1) {
+        NoteRootFSMiss(SelfPath);
+      }
     }
 
     if (fd == -1)
@@ -559,7 +787,7 @@ uint64_t FileManager::Openat([[maybe_unused]] int dirfs, const char *pathname, i
   }
 
   if (fd != -1) {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(FDLock);
     FDToNameMap.insert_or_assign(fd, SelfPath);
   }
 
@@ -574,9 +802,22 @@ uint64_t FileManager::Openat2(int dirfs, const char *pathname, FEX::HLE::open_ho
 
   fd = EmuFD.OpenAt(dirfs, SelfPath, how->flags, how->mode);
   if (fd == -1) {
-    auto Path = GetEmulatedPath(SelfPath, true);
+    bool Resolved = false;
+    // RESOLVE_IN_ROOT can't be combined with all of the guest's resolve flags
+    if (how->resolve == 0 && CanOpenInRootFS(SelfPath)) {
+      fd = OpenInRootFS(SelfPath, how->flags, how->mode);
+      Resolved = fd != -1 || (errno != EINVAL && errno != EAGAIN);
+      if (fd == -1 && errno == ENOENT) {
+        NoteRootFSMiss(SelfPath);
+      }
+    }
+
+    auto Path = Resolved ? std::string{} : GetEmulatedPath(SelfPath, true);
     if (!Path.empty()) {
       fd = ::syscall(SYSCALL_DEF(openat2), dirfs, Path.c_str(), how, usize);
+      if (fd == -1) {
+        NoteRootFSMiss(SelfPath);
+      }
     }
 
     if (fd == -1)
@@ -584,7 +825,7 @@ uint64_t FileManager::Openat2(int dirfs, const char *pathname, FEX::HLE::open_ho
   }
 
   if (fd != -1) {
-    FHU::ScopedSignalMaskWithMutex lk(FDLock);
+    FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(FDLock);
     FDToNameMap.insert_or_assign(fd, SelfPath);
   }
 
@@ -596,11 +837,13 @@ uint64_t FileManager::Statx(int dirfd, const char *pathname, int flags, uint32_t
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0);
-  if (!Path.empty()) {
-    uint64_t Result = FHU::Syscalls::statx(dirfd, Path.c_str(), flags, mask, statxbuf);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, (flags & AT_SYMLINK_NOFOLLOW) == 0, &Storage);
+  if (Path) {
+    uint64_t Result = FHU::Syscalls::statx(FD, Path, flags, mask, statxbuf);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
   return FHU::Syscalls::statx(dirfd, SelfPath, flags, mask, statxbuf);
 }
@@ -609,11 +852,13 @@ uint64_t FileManager::Mknod(const char *pathname, mode_t mode, dev_t dev) {
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath);
-  if (!Path.empty()) {
-    uint64_t Result = ::mknod(Path.c_str(), mode, dev);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, false, &Storage);
+  if (Path) {
+    uint64_t Result = ::mknodat(FD, Path, mode, dev);
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(SelfPath);
   }
   return ::mknod(SelfPath, mode, dev);
 }
@@ -624,6 +869,7 @@ uint64_t FileManager::Statfs(const char *path, void *buf) {
     uint64_t Result = ::statfs(Path.c_str(), reinterpret_cast<struct statfs*>(buf));
     if (Result != -1)
       return Result;
+    NoteRootFSMiss(path);
   }
   return ::statfs(path, reinterpret_cast<struct statfs*>(buf));
 }
@@ -632,12 +878,14 @@ uint64_t FileManager::NewFSStatAt(int dirfd, const char *pathname, struct stat *
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0);
-  if (!Path.empty()) {
-    uint64_t Result = ::fstatat(dirfd, Path.c_str(), buf, flag);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0, &Storage);
+  if (Path) {
+    uint64_t Result = ::fstatat(FD, Path, buf, flag);
     if (Result != -1) {
       return Result;
     }
+    NoteRootFSMiss(SelfPath);
   }
   return ::fstatat(dirfd, SelfPath, buf, flag);
 }
@@ -646,18 +894,20 @@ uint64_t FileManager::NewFSStatAt64(int dirfd, const char *pathname, struct stat
   auto NewPath = GetSelf(pathname);
   const char *SelfPath = NewPath ? NewPath->c_str() : nullptr;
 
-  auto Path = GetEmulatedPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0);
-  if (!Path.empty()) {
-    uint64_t Result = ::fstatat64(dirfd, Path.c_str(), buf, flag);
+  std::string Storage;
+  auto [FD, Path] = GetEmulatedFDPath(SelfPath, (flag & AT_SYMLINK_NOFOLLOW) == 0, &Storage);
+  if (Path) {
+    uint64_t Result = ::fstatat64(FD, Path, buf, flag);
     if (Result != -1) {
       return Result;
     }
+    NoteRootFSMiss(SelfPath);
   }
   return ::fstatat64(dirfd, SelfPath, buf, flag);
 }
 
 std::string *FileManager::FindFDName(int fd) {
-  FHU::ScopedSignalMaskWithMutex lk(FDLock);
+  FHU::ScopedSignalDeferWithMutex<FEXCore::SignalDelegator> lk(FDLock);
   auto it = FDToNameMap.find(fd);
   if (it == FDToNameMap.end()) {
     return nullptr;
@@ -12,8 +12,10 @@ $end_info$
 #include <map>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <stddef.h>
 #include <string>
+#include <string_view>
 #include <sys/stat.h>
 #include <vector>
 
@@ -66,8 +68,29 @@ public:
 
   std::string GetEmulatedPath(const char *pathname, bool FollowSymlink = false);
 
+  struct EmulatedFDPath {
+    int FD;
+    // nullptr if the rootfs shouldn't be tried
+    const char *Path;
+  };
+
+  /**
+   * @brief Gets the dirfd and path for trying a guest path in the rootfs with the *at syscalls
+   *
+   * Without following symlinks this is a path relative to the held rootfs fd, so nothing gets built
+   * and the kernel doesn't walk the rootfs prefix again.
+   * Following symlinks needs GetEmulatedPath, which builds the path in to Storage.
+   */
+  EmulatedFDPath GetEmulatedFDPath(const char *pathname, bool FollowSymlink, std::string *Storage);
+
   std::mutex *GetFDLock() { return &FDLock; }
 
+  // The guest doesn't know about the rootfs fd, it may not close it or dup over it
+  bool IsRootFSFD(int fd) const { return fd != -1 && fd == RootFSFD; }
+
+  // Needs to be called by anything that can add, remove or replace a directory entry
+  void InvalidateRootFSCache();
+
 private:
   FEX::EmulatedFile::EmulatedFDManager EmuFD;
 
@@ -75,6 +98,33 @@ private:
   std::unordered_map<int32_t, std::string> FDToNameMap;
   std::map<std::string, std::string, std::less<>> ThunkOverlays;
 
+  // Rootfs lookups, keyed by the guest path
+  // A loader probing library paths would otherwise try the rootfs and the host for every one of them
+  constexpr static size_t ROOTFS_CACHE_SIZE = 4096;
+  std::mutex RootFSCacheLock;
+  // Lookups that raced with an invalidation don't get inserted
+  uint64_t RootFSCacheGeneration{};
+  // Directories that don't exist in the rootfs, nothing below them needs to be tried
+  std::set<std::string, std::less<>> RootFSMissingDirs;
+  // Directories that do exist, so a miss inside of them doesn't check them again
+  std::set<std::string, std::less<>> RootFSPresentDirs;
+  // GetEmulatedPath results once the symlinks were followed
+  std::map<std::string, std::string, std::less<>> RootFSResolvedPaths;
+
+  bool IsMissingFromRootFS(std::string_view Path);
+  void NoteRootFSMiss(const char *pathname);
+
+  // O_PATH fd of the rootfs, -1 if there isn't one
+  // Moved to ROOTFS_FD_BASE or above, out of the way of the fds that guests pick for dup2
+  constexpr static int ROOTFS_FD_BASE = 512;
+  int RootFSFD{-1};
+  // openat2 can resolve guest paths inside of RootFSFD, symlinks included
+  bool SupportsResolveInRoot{};
+  bool CanOpenInRootFS(const char *pathname);
+  // RESOLVE_IN_ROOT fails with EAGAIN when a rename raced with the lookup
+  constexpr static int ROOTFS_RESOLVE_RETRIES = 8;
+  int OpenInRootFS(const char *pathname, uint64_t flags, uint64_t mode);
+
   FEX_CONFIG_OPT(Filename, APP_FILENAME);
   FEX_CONFIG_OPT(LDPath, ROOTFS);
   FEX_CONFIG_OPT(ThunkHostLibs, THUNKHOSTLIBS);
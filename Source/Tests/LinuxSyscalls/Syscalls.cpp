@@ -31,6 +31,7 @@ $end_info$
 #include <algorithm>
 #include <alloca.h>
 #include <functional>
+#include <limits.h>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -629,6 +630,8 @@ uint64_t SyscallHandler::HandleSyscall(FEXCore::Core::CpuStateFrame *Frame, FEXC
   }
 
   auto &Def = Definitions[Args->Argument[0]];
+  auto &Scratch = Frame->Thread->SyscallScratch;
+  const auto ScratchMark = Scratch.GetMarker();
   uint64_t Result{};
   switch (Def.NumArgs) {
   case 0: Result = std::invoke(Def.Ptr0, Frame); break;
@@ -645,6 +648,9 @@ uint64_t SyscallHandler::HandleSyscall(FEXCore::Core::CpuStateFrame *Frame, FEXC
     return -1;
   break;
   }
+
+  // Rewind rather than reset, a signal handler's syscalls can nest inside of another syscall
+  Scratch.Rewind(ScratchMark);
 #ifdef DEBUG_STRACE
   Strace(Args, Result);
 #endif
@@ -676,4 +682,26 @@ uint64_t UnimplementedSyscallSafe(FEXCore::Core::CpuStateFrame *Frame, uint64_t
   return -ENOSYS;
 }
 
+void UnprotectGuestBuffer(FEXCore::Core::CpuStateFrame *Frame, const void *Buffer, size_t Length) {
+  static FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
+  if (SMCChecks != FEXCore::Config::CONFIG_SMC_MTRACK || !Buffer) {
+    return;
+  }
+
+  // The kernel fails the syscall on a buffer that wraps around anyway
+  const uint64_t Start = reinterpret_cast<uint64_t>(Buffer);
+  FEXCore::Context::UnprotectCodeRange(Frame->Thread, Start, std::min<uint64_t>(Length, ~0ULL - Start));
+}
+
+void UnprotectGuestBuffers(FEXCore::Core::CpuStateFrame *Frame, const struct iovec *iov, size_t iovcnt) {
+  static FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
+  if (SMCChecks != FEXCore::Config::CONFIG_SMC_MTRACK || !iov) {
+    return;
+  }
+
+  for (size_t i = 0; i < std::min<size_t>(iovcnt, IOV_MAX); ++i) {
+    UnprotectGuestBuffer(Frame, iov[i].iov_base, iov[i].iov_len);
+  }
+}
+
 }
@@ -19,6 +19,7 @@ $end_info$
 
 #include <errno.h>
 #include <stdint.h>
+#include <sys/uio.h>
 #include <type_traits>
 #include <vector>
 #ifdef _M_X86_64
@@ -195,6 +196,11 @@ private:
 
 uint64_t HandleSyscall(SyscallHandler *Handler, FEXCore::Core::CpuStateFrame *Frame, FEXCore::HLE::SyscallArguments *Args);
 
+// SMCChecks=mtrack write-protects guest code pages and the kernel fails syscalls writing to those with EFAULT
+// Syscalls that fill guest buffers drop the tracking of those buffers before they are issued
+void UnprotectGuestBuffer(FEXCore::Core::CpuStateFrame *Frame, const void *Buffer, size_t Length);
+void UnprotectGuestBuffers(FEXCore::Core::CpuStateFrame *Frame, const struct iovec *iov, size_t iovcnt);
+
 #define SYSCALL_ERRNO() do { if (Result == -1) return -errno; return Result; } while(0)
 #define SYSCALL_ERRNO_NULL() do { if (Result == 0) return -errno; return Result; } while(0)
 
@@ -33,6 +33,7 @@ namespace FEX::HLE {
 
     REGISTER_SYSCALL_IMPL_PASS_FLAGS(read, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffer(Frame, buf, count);
       uint64_t Result = ::read(fd, buf, count);
       SYSCALL_ERRNO();
     });
@@ -94,6 +95,9 @@ namespace FEX::HLE {
 
     REGISTER_SYSCALL_IMPL_FLAGS(dup3, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame* Frame, int oldfd, int newfd, int flags) -> uint64_t {
+      if (FEX::HLE::_SyscallHandler->FM.IsRootFSFD(newfd)) {
+        return -EBADF;
+      }
       flags = FEX::HLE::RemapFromX86Flags(flags);
       uint64_t Result = ::dup3(oldfd, newfd, flags);
       SYSCALL_ERRNO();
@@ -160,9 +164,12 @@ namespace FEX::HLE {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(mkdirat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(mkdirat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int dirfd, const char *pathname, mode_t mode) -> uint64_t {
       uint64_t Result = ::mkdirat(dirfd, pathname, mode);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
@@ -179,29 +186,41 @@ namespace FEX::HLE {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(unlinkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(unlinkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int dirfd, const char *pathname, int flags) -> uint64_t {
       // Flags don't need remapped
       uint64_t Result = ::unlinkat(dirfd, pathname, flags);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(renameat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(renameat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int olddirfd, const char *oldpath, int newdirfd, const char *newpath) -> uint64_t {
       uint64_t Result = ::renameat(olddirfd, oldpath, newdirfd, newpath);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(linkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(linkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int olddirfd, const char *oldpath, int newdirfd, const char *newpath, int flags) -> uint64_t {
       // Flags don't need remapped
       uint64_t Result = ::linkat(olddirfd, oldpath, newdirfd, newpath, flags);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(symlinkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(symlinkat, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, const char *target, int newdirfd, const char *linkpath) -> uint64_t {
       uint64_t Result = ::symlinkat(target, newdirfd, linkpath);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
@@ -295,10 +314,13 @@ namespace FEX::HLE {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_PASS_FLAGS(renameat2, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
+    REGISTER_SYSCALL_IMPL_FLAGS(renameat2, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int olddirfd, const char *oldpath, int newdirfd, const char *newpath, unsigned int flags) -> uint64_t {
       // Flags don't need remapped
       uint64_t Result = FHU::Syscalls::renameat2(olddirfd, oldpath, newdirfd, newpath, flags);
+      if (Result != -1) {
+        FEX::HLE::_SyscallHandler->FM.InvalidateRootFSCache();
+      }
       SYSCALL_ERRNO();
     });
 
@@ -44,6 +44,10 @@ namespace FEX::HLE {
 
     REGISTER_SYSCALL_IMPL_PASS_FLAGS(recvfrom, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, void *buf, size_t len, int flags, struct sockaddr *src_addr, socklen_t *addrlen) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffer(Frame, buf, len);
+      if (addrlen) {
+        FEX::HLE::UnprotectGuestBuffer(Frame, src_addr, *addrlen);
+      }
       uint64_t Result = ::recvfrom(sockfd, buf, len, flags, src_addr, addrlen);
       SYSCALL_ERRNO();
     });
@@ -11,13 +11,14 @@ $end_info$
 #include "Tests/LinuxSyscalls/x32/Types.h"
 #include "Tests/LinuxSyscalls/x64/Syscalls.h"
 
+#include <FEXCore/Debug/InternalThreadState.h>
+
 #include <algorithm>
 #include <cstdint>
 #include <sys/epoll.h>
 #include <syscall.h>
 #include <time.h>
 #include <unistd.h>
-#include <vector>
 
 ARG_TO_STR(FEX::HLE::x32::compat_ptr<FEX::HLE::x32::epoll_event32>, "%lx")
 ARG_TO_STR(FEX::HLE::x32::compat_ptr<FEX::HLE::x32::timespec32>, "%lx")
@@ -29,8 +30,8 @@ namespace FEXCore::Core {
 namespace FEX::HLE::x32 {
   void RegisterEpoll(FEX::HLE::SyscallHandler *const Handler) {
     REGISTER_SYSCALL_IMPL_X32(epoll_wait, [](FEXCore::Core::CpuStateFrame *Frame, int epfd, compat_ptr<FEX::HLE::x32::epoll_event32> events, int maxevents, int timeout) -> uint64_t {
-      std::vector<struct epoll_event> Events(std::max(0, maxevents));
-      uint64_t Result = ::syscall(SYSCALL_DEF(epoll_pwait), epfd, Events.data(), maxevents, timeout, nullptr, 8);
+      auto Events = Frame->Thread->SyscallScratch.Allocate<struct epoll_event>(std::max(0, maxevents));
+      uint64_t Result = ::syscall(SYSCALL_DEF(epoll_pwait), epfd, Events, maxevents, timeout, nullptr, 8);
 
       if (Result != -1) {
         for (size_t i = 0; i < Result; ++i) {
@@ -47,11 +48,11 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(epoll_pwait, [](FEXCore::Core::CpuStateFrame *Frame, int epfd, compat_ptr<FEX::HLE::x32::epoll_event32> events, int maxevent, int timeout, const uint64_t* sigmask, size_t sigsetsize) -> uint64_t {
-      std::vector<struct epoll_event> Events(std::max(0, maxevent));
+      auto Events = Frame->Thread->SyscallScratch.Allocate<struct epoll_event>(std::max(0, maxevent));
 
       uint64_t Result = ::syscall(SYSCALL_DEF(epoll_pwait),
         epfd,
-        Events.data(),
+        Events,
         maxevent,
         timeout,
         sigmask,
@@ -68,7 +69,7 @@ namespace FEX::HLE::x32 {
 
     if (Handler->IsHostKernelVersionAtLeast(5, 11, 0)) {
       REGISTER_SYSCALL_IMPL_X32(epoll_pwait2, [](FEXCore::Core::CpuStateFrame *Frame, int epfd, compat_ptr<FEX::HLE::x32::epoll_event32> events, int maxevent, compat_ptr<timespec32> timeout, const uint64_t* sigmask, size_t sigsetsize) -> uint64_t {
-        std::vector<struct epoll_event> Events(std::max(0, maxevent));
+        auto Events = Frame->Thread->SyscallScratch.Allocate<struct epoll_event>(std::max(0, maxevent));
 
         struct timespec tp64{};
         struct timespec *timed_ptr{};
@@ -79,7 +80,7 @@ namespace FEX::HLE::x32 {
 
         uint64_t Result = ::syscall(SYSCALL_DEF(epoll_pwait2),
           epfd,
-          Events.data(),
+          Events,
           maxevent,
           timed_ptr,
           sigmask,
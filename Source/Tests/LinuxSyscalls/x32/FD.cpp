@@ -52,6 +52,13 @@ namespace FEX::HLE::x32 {
     return std::max(0, count);
   }
 
+  // Converted iovecs only live until the syscall returns
+  static iovec *ConvertIOVec(FEXCore::Core::CpuStateFrame *Frame, const struct iovec32 *iov, size_t Count) {
+    auto Host_iovec = Frame->Thread->SyscallScratch.Allocate<iovec>(Count);
+    std::copy(iov, iov + Count, Host_iovec);
+    return Host_iovec;
+  }
+
 #ifdef _M_X86_64
   uint32_t ioctl_32(FEXCore::Core::CpuStateFrame*, int fd, uint32_t cmd, uint32_t args) {
     uint32_t Result{};
@@ -303,14 +310,15 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(readv, [](FEXCore::Core::CpuStateFrame *Frame, int fd, const struct iovec32 *iov, int iovcnt) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
-      uint64_t Result = ::readv(fd, Host_iovec.data(), iovcnt);
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
+      FEX::HLE::UnprotectGuestBuffers(Frame, Host_iovec, SanitizeIOCount(iovcnt));
+      uint64_t Result = ::readv(fd, Host_iovec, iovcnt);
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X32(writev, [](FEXCore::Core::CpuStateFrame *Frame, int fd, const struct iovec32 *iov, int iovcnt) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
-      uint64_t Result = ::writev(fd, Host_iovec.data(), iovcnt);
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
+      uint64_t Result = ::writev(fd, Host_iovec, iovcnt);
       SYSCALL_ERRNO();
     });
 
@@ -498,6 +506,9 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(dup2, [](FEXCore::Core::CpuStateFrame *Frame, int oldfd, int newfd) -> uint64_t {
+      if (FEX::HLE::_SyscallHandler->FM.IsRootFSFD(newfd)) {
+        return -EBADF;
+      }
       uint64_t Result = ::dup2(oldfd, newfd);
       if (Result != -1) {
         CheckAndAddFDDuplication(oldfd, newfd);
@@ -511,9 +522,10 @@ namespace FEX::HLE::x32 {
       uint32_t iovcnt,
       uint32_t pos_low,
       uint32_t pos_high) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
+      FEX::HLE::UnprotectGuestBuffers(Frame, Host_iovec, SanitizeIOCount(iovcnt));
 
-      uint64_t Result = ::syscall(SYSCALL_DEF(preadv), fd, Host_iovec.data(), iovcnt, pos_low, pos_high);
+      uint64_t Result = ::syscall(SYSCALL_DEF(preadv), fd, Host_iovec, iovcnt, pos_low, pos_high);
       SYSCALL_ERRNO();
     });
 
@@ -523,25 +535,25 @@ namespace FEX::HLE::x32 {
       uint32_t iovcnt,
       uint32_t pos_low,
       uint32_t pos_high) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
 
-      uint64_t Result = ::syscall(SYSCALL_DEF(pwritev), fd, Host_iovec.data(), iovcnt, pos_low, pos_high);
+      uint64_t Result = ::syscall(SYSCALL_DEF(pwritev), fd, Host_iovec, iovcnt, pos_low, pos_high);
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X32(process_vm_readv, [](FEXCore::Core::CpuStateFrame *Frame, pid_t pid, const struct iovec32 *local_iov, unsigned long liovcnt, const struct iovec32 *remote_iov, unsigned long riovcnt, unsigned long flags) -> uint64_t {
-      std::vector<iovec> Host_local_iovec(local_iov, local_iov + SanitizeIOCount(liovcnt));
-      std::vector<iovec> Host_remote_iovec(remote_iov, remote_iov + SanitizeIOCount(riovcnt));
+      auto Host_local_iovec = ConvertIOVec(Frame, local_iov, SanitizeIOCount(liovcnt));
+      auto Host_remote_iovec = ConvertIOVec(Frame, remote_iov, SanitizeIOCount(riovcnt));
 
-      uint64_t Result = ::process_vm_readv(pid, Host_local_iovec.data(), liovcnt, Host_remote_iovec.data(), riovcnt, flags);
+      uint64_t Result = ::process_vm_readv(pid, Host_local_iovec, liovcnt, Host_remote_iovec, riovcnt, flags);
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X32(process_vm_writev, [](FEXCore::Core::CpuStateFrame *Frame, pid_t pid, const struct iovec32 *local_iov, unsigned long liovcnt, const struct iovec32 *remote_iov, unsigned long riovcnt, unsigned long flags) -> uint64_t {
-      std::vector<iovec> Host_local_iovec(local_iov, local_iov + SanitizeIOCount(liovcnt));
-      std::vector<iovec> Host_remote_iovec(remote_iov, remote_iov + SanitizeIOCount(riovcnt));
+      auto Host_local_iovec = ConvertIOVec(Frame, local_iov, SanitizeIOCount(liovcnt));
+      auto Host_remote_iovec = ConvertIOVec(Frame, remote_iov, SanitizeIOCount(riovcnt));
 
-      uint64_t Result = ::process_vm_writev(pid, Host_local_iovec.data(), liovcnt, Host_remote_iovec.data(), riovcnt, flags);
+      uint64_t Result = ::process_vm_writev(pid, Host_local_iovec, liovcnt, Host_remote_iovec, riovcnt, flags);
       SYSCALL_ERRNO();
     });
 
@@ -552,9 +564,10 @@ namespace FEX::HLE::x32 {
       uint32_t pos_low,
       uint32_t pos_high,
       int flags) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
+      FEX::HLE::UnprotectGuestBuffers(Frame, Host_iovec, SanitizeIOCount(iovcnt));
 
-      uint64_t Result = ::syscall(SYSCALL_DEF(preadv2), fd, Host_iovec.data(), iovcnt, pos_low, pos_high, flags);
+      uint64_t Result = ::syscall(SYSCALL_DEF(preadv2), fd, Host_iovec, iovcnt, pos_low, pos_high, flags);
       SYSCALL_ERRNO();
     });
 
@@ -565,9 +578,9 @@ namespace FEX::HLE::x32 {
       uint32_t pos_low,
       uint32_t pos_high,
       int flags) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + SanitizeIOCount(iovcnt));
+      auto Host_iovec = ConvertIOVec(Frame, iov, SanitizeIOCount(iovcnt));
 
-      uint64_t Result = ::syscall(SYSCALL_DEF(pwritev2), fd, Host_iovec.data(),iovcnt, pos_low, pos_high, flags);
+      uint64_t Result = ::syscall(SYSCALL_DEF(pwritev2), fd, Host_iovec,iovcnt, pos_low, pos_high, flags);
       SYSCALL_ERRNO();
     });
 
@@ -655,6 +668,7 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(getdents64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *dirp, uint32_t count) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffer(Frame, dirp, count);
       uint64_t Result = ::syscall(SYSCALL_DEF(getdents64),
         static_cast<uint64_t>(fd),
         dirp,
@@ -965,6 +979,7 @@ namespace FEX::HLE::x32 {
       Offset <<= 32;
       Offset |= offset_low;
 
+      FEX::HLE::UnprotectGuestBuffer(Frame, buf, count);
       uint64_t Result = ::pread64(fd, buf, count, Offset);
       SYSCALL_ERRNO();
     });
@@ -1027,8 +1042,8 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(vmsplice, [](FEXCore::Core::CpuStateFrame *Frame, int fd, const struct iovec32 *iov, unsigned long nr_segs, unsigned int flags) -> uint64_t {
-      std::vector<iovec> Host_iovec(iov, iov + nr_segs);
-      uint64_t Result = ::vmsplice(fd, Host_iovec.data(), nr_segs, flags);
+      auto Host_iovec = ConvertIOVec(Frame, iov, nr_segs);
+      uint64_t Result = ::vmsplice(fd, Host_iovec, nr_segs, flags);
       SYSCALL_ERRNO();
     });
   }
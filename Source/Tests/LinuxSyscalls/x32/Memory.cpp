@@ -7,6 +7,7 @@ $end_info$
 #include "Tests/LinuxSyscalls/Syscalls.h"
 #include "Tests/LinuxSyscalls/x32/Syscalls.h"
 #include "Tests/LinuxSyscalls/x64/Syscalls.h"
+#include <FEXCore/Config/Config.h>
 #include <FEXCore/Core/Context.h>
 #include <FEXCore/Core/CoreState.h>
 #include <FEXCore/Debug/InternalThreadState.h>
@@ -72,14 +73,19 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(mprotect, [](FEXCore::Core::CpuStateFrame *Frame, void *addr, uint32_t len, int prot) -> uint64_t {
+      static FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
+
       uint64_t Result = ::mprotect(addr, len, prot);
-      if (Result != -1 && prot & PROT_EXEC) {
+      // Page tracking needs to know about every protection change, not only the ones that can make code
+      if (Result != -1 && (prot & PROT_EXEC || SMCChecks == FEXCore::Config::CONFIG_SMC_MTRACK)) {
         FEXCore::Context::FlushCodeRange(Frame->Thread, (uintptr_t)addr, len);
       }
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X32(mremap, [](FEXCore::Core::CpuStateFrame *Frame, void *old_address, size_t old_size, size_t new_size, int flags, void *new_address) -> uint64_t {
+      // Write-protected code pages would keep their protection at the new address
+      FEXCore::Context::UnprotectCodeRange(Frame->Thread, (uintptr_t)old_address, old_size);
       return reinterpret_cast<uint64_t>(static_cast<FEX::HLE::x32::x32SyscallHandler*>(FEX::HLE::_SyscallHandler)->GetAllocator()->
         mremap(old_address, old_size, new_size, flags, new_address));
     });
@@ -9,6 +9,7 @@ $end_info$
 #include "Tests/LinuxSyscalls/x32/Types.h"
 #include "Tests/LinuxSyscalls/x64/Syscalls.h"
 
+#include <FEXCore/Debug/InternalThreadState.h>
 #include <FEXCore/Utils/LogManager.h>
 
 #include <alloca.h>
@@ -18,7 +19,6 @@ $end_info$
 #include <stddef.h>
 #include <sys/socket.h>
 #include <unistd.h>
-#include <vector>
 
 ARG_TO_STR(FEX::HLE::x32::compat_ptr<FEX::HLE::x32::mmsghdr_32>, "%lx")
 ARG_TO_STR(FEX::HLE::x32::compat_ptr<void>, "%lx")
@@ -121,9 +121,9 @@ namespace FEX::HLE::x32 {
     OP_SENDMMSG = 20,
   };
 
-  static uint64_t SendMsg(int sockfd, const struct msghdr32 *msg, int flags) {
+  static uint64_t SendMsg(FEXCore::Core::CpuStateFrame *Frame, int sockfd, const struct msghdr32 *msg, int flags) {
     struct msghdr HostHeader{};
-    std::vector<iovec> Host_iovec(msg->msg_iovlen);
+    auto Host_iovec = Frame->Thread->SyscallScratch.Allocate<iovec>(msg->msg_iovlen);
     for (size_t i = 0; i < msg->msg_iovlen; ++i) {
       Host_iovec[i] = msg->msg_iov[i];
     }
@@ -131,7 +131,7 @@ namespace FEX::HLE::x32 {
     HostHeader.msg_name = msg->msg_name;
     HostHeader.msg_namelen = msg->msg_namelen;
 
-    HostHeader.msg_iov = Host_iovec.data();
+    HostHeader.msg_iov = Host_iovec;
     HostHeader.msg_iovlen = msg->msg_iovlen;
 
     HostHeader.msg_control = alloca(msg->msg_controllen * 2);
@@ -177,9 +177,9 @@ namespace FEX::HLE::x32 {
     SYSCALL_ERRNO();
   }
 
-  static uint64_t RecvMsg(int sockfd, struct msghdr32 *msg, int flags) {
+  static uint64_t RecvMsg(FEXCore::Core::CpuStateFrame *Frame, int sockfd, struct msghdr32 *msg, int flags) {
     struct msghdr HostHeader{};
-    std::vector<iovec> Host_iovec(msg->msg_iovlen);
+    auto Host_iovec = Frame->Thread->SyscallScratch.Allocate<iovec>(msg->msg_iovlen);
     for (size_t i = 0; i < msg->msg_iovlen; ++i) {
       Host_iovec[i] = msg->msg_iov[i];
     }
@@ -187,7 +187,7 @@ namespace FEX::HLE::x32 {
     HostHeader.msg_name = msg->msg_name;
     HostHeader.msg_namelen = msg->msg_namelen;
 
-    HostHeader.msg_iov = Host_iovec.data();
+    HostHeader.msg_iov = Host_iovec;
     HostHeader.msg_iovlen = msg->msg_iovlen;
 
     HostHeader.msg_control = alloca(msg->msg_controllen*2);
@@ -195,6 +195,10 @@ namespace FEX::HLE::x32 {
 
     HostHeader.msg_flags = msg->msg_flags;
 
+    // The control data goes through our own buffer, the iovecs and the name are written by the kernel
+    FEX::HLE::UnprotectGuestBuffers(Frame, Host_iovec, msg->msg_iovlen);
+    FEX::HLE::UnprotectGuestBuffer(Frame, HostHeader.msg_name, HostHeader.msg_namelen);
+
     uint64_t Result = ::recvmsg(sockfd, &HostHeader, flags);
     if (Result != -1) {
       for (size_t i = 0; i < msg->msg_iovlen; ++i) {
@@ -238,21 +242,20 @@ namespace FEX::HLE::x32 {
     SYSCALL_ERRNO();
   }
 
-  void ConvertHeaderToHost(std::vector<iovec> &iovec, struct msghdr *Host, const struct msghdr32 *Guest) {
-    size_t CurrentIOVecSize = iovec.size();
-    iovec.resize(CurrentIOVecSize + Guest->msg_iovlen);
+  void ConvertHeaderToHost(FEXCore::Utils::ScratchArena &Scratch, struct msghdr *Host, const struct msghdr32 *Guest) {
+    auto Host_iovec = Scratch.Allocate<iovec>(Guest->msg_iovlen);
     for (size_t i = 0; i < Guest->msg_iovlen; ++i) {
-      iovec[CurrentIOVecSize + i] = Guest->msg_iov[i];
+      Host_iovec[i] = Guest->msg_iov[i];
     }
 
     Host->msg_name = Guest->msg_name;
     Host->msg_namelen = Guest->msg_namelen;
 
-    Host->msg_iov = &iovec[CurrentIOVecSize];
+    Host->msg_iov = Host_iovec;
     Host->msg_iovlen = Guest->msg_iovlen;
 
-    // XXX: This could result in a stack overflow
-    Host->msg_control = alloca(Guest->msg_controllen*2);
+    // Needs to outlive this function, unlike an alloca
+    Host->msg_control = Scratch.Allocate<uint8_t>(Guest->msg_controllen*2);
     Host->msg_controllen = Guest->msg_controllen*2;
 
     Host->msg_flags = Guest->msg_flags;
@@ -298,14 +301,14 @@ namespace FEX::HLE::x32 {
     }
   }
 
-  static uint64_t RecvMMsg(int sockfd, compat_ptr<mmsghdr_32> msgvec, uint32_t vlen, int flags, struct timespec *timeout_ts) {
-    std::vector<iovec> Host_iovec;
-    std::vector<struct mmsghdr> HostMHeader(vlen);
+  static uint64_t RecvMMsg(FEXCore::Core::CpuStateFrame *Frame, int sockfd, compat_ptr<mmsghdr_32> msgvec, uint32_t vlen, int flags, struct timespec *timeout_ts) {
+    auto &Scratch = Frame->Thread->SyscallScratch;
+    auto HostMHeader = Scratch.Allocate<struct mmsghdr>(vlen);
     for (size_t i = 0; i < vlen; ++i) {
-      ConvertHeaderToHost(Host_iovec, &HostMHeader[i].msg_hdr, &msgvec[i].msg_hdr);
+      ConvertHeaderToHost(Scratch, &HostMHeader[i].msg_hdr, &msgvec[i].msg_hdr);
       HostMHeader[i].msg_len = msgvec[i].msg_len;
     }
-    uint64_t Result = ::recvmmsg(sockfd, HostMHeader.data(), vlen, flags, timeout_ts);
+    uint64_t Result = ::recvmmsg(sockfd, HostMHeader, vlen, flags, timeout_ts);
     if (Result != -1) {
       for (size_t i = 0; i < Result; ++i) {
         ConvertHeaderToGuest(&msgvec[i].msg_hdr, &HostMHeader[i].msg_hdr);
@@ -678,11 +681,11 @@ namespace FEX::HLE::x32 {
           break;
         }
         case OP_SENDMSG: {
-          return SendMsg(Arguments[0], reinterpret_cast<const struct msghdr32*>(Arguments[1]), Arguments[2]);
+          return SendMsg(Frame, Arguments[0], reinterpret_cast<const struct msghdr32*>(Arguments[1]), Arguments[2]);
           break;
         }
         case OP_RECVMSG: {
-          return RecvMsg(Arguments[0], reinterpret_cast<struct msghdr32*>(Arguments[1]), Arguments[2]);
+          return RecvMsg(Frame, Arguments[0], reinterpret_cast<struct msghdr32*>(Arguments[1]), Arguments[2]);
           break;
         }
         default:
@@ -693,27 +696,34 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(sendmsg, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, const struct msghdr32 *msg, int flags) -> uint64_t {
-      return SendMsg(sockfd, msg, flags);
+      return SendMsg(Frame, sockfd, msg, flags);
     });
 
     REGISTER_SYSCALL_IMPL_X32(sendmmsg, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, compat_ptr<mmsghdr_32> msgvec, uint32_t vlen, int flags) -> uint64_t {
-      std::vector<iovec> Host_iovec;
-      std::vector<struct mmsghdr> HostMmsg(vlen);
+      auto &Scratch = Frame->Thread->SyscallScratch;
+      auto HostMmsg = Scratch.Allocate<struct mmsghdr>(vlen);
 
-      // Walk the iovec and convert them
-      // Calculate controllen at the same time
+      // Calculate the iovec count and controllen first so they are a single allocation
+      size_t Host_iovec_size{};
       size_t Controllen_size{};
       for (size_t i = 0; i < vlen; ++i) {
         msghdr32 &guest = msgvec[i].msg_hdr;
 
         Controllen_size += guest.msg_controllen * 2;
+        Host_iovec_size += guest.msg_iovlen;
+      }
+
+      // Walk the iovec and convert them
+      auto Host_iovec = Scratch.Allocate<iovec>(Host_iovec_size);
+      for (size_t i = 0, current_iov = 0; i < vlen; ++i) {
+        msghdr32 &guest = msgvec[i].msg_hdr;
+
         for (size_t j = 0; j < guest.msg_iovlen; ++j) {
-          iovec guest_iov = guest.msg_iov[j];
-          Host_iovec.emplace_back(guest_iov);
+          Host_iovec[current_iov++] = guest.msg_iov[j];
         }
       }
 
-      std::vector<uint8_t> Controllen(Controllen_size);
+      auto Controllen = Scratch.Allocate<uint8_t>(Controllen_size);
 
       size_t current_iov{};
       size_t current_controllen_offset{};
@@ -723,12 +733,12 @@ namespace FEX::HLE::x32 {
         msg.msg_name = guest.msg_name;
         msg.msg_namelen = guest.msg_namelen;
 
-        msg.msg_iov = &Host_iovec.at(current_iov);
+        msg.msg_iov = &Host_iovec[current_iov];
         msg.msg_iovlen = guest.msg_iovlen;
         current_iov += msg.msg_iovlen;
 
         if (guest.msg_controllen) {
-          msg.msg_control = &Controllen.at(current_controllen_offset);
+          msg.msg_control = &Controllen[current_controllen_offset];
           current_controllen_offset += guest.msg_controllen * 2;
         }
         msg.msg_controllen = guest.msg_controllen;
@@ -773,7 +783,7 @@ namespace FEX::HLE::x32 {
         HostMmsg[i].msg_len = msgvec[i].msg_len;
       }
 
-      uint64_t Result = ::sendmmsg(sockfd, HostMmsg.data(), vlen, flags);
+      uint64_t Result = ::sendmmsg(sockfd, HostMmsg, vlen, flags);
 
       if (Result != -1) {
         // Update guest msglen
@@ -792,7 +802,7 @@ namespace FEX::HLE::x32 {
         timed_ptr = &tp64;
       }
 
-      uint64_t Result = RecvMMsg(sockfd, msgvec, vlen, flags, timed_ptr);
+      uint64_t Result = RecvMMsg(Frame, sockfd, msgvec, vlen, flags, timed_ptr);
 
       if (timeout_ts) {
         *timeout_ts = tp64;
@@ -802,11 +812,11 @@ namespace FEX::HLE::x32 {
     });
 
     REGISTER_SYSCALL_IMPL_X32(recvmmsg_time64, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, compat_ptr<mmsghdr_32> msgvec, uint32_t vlen, int flags, struct timespec *timeout_ts) -> uint64_t {
-      return RecvMMsg(sockfd, msgvec, vlen, flags, timeout_ts);
+      return RecvMMsg(Frame, sockfd, msgvec, vlen, flags, timeout_ts);
     });
 
     REGISTER_SYSCALL_IMPL_X32(recvmsg, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, struct msghdr32 *msg, int flags) -> uint64_t {
-      return RecvMsg(sockfd, msg, flags);
+      return RecvMsg(Frame, sockfd, msg, flags);
     });
 
     REGISTER_SYSCALL_IMPL_X32(setsockopt, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, int level, int optname, compat_ptr<void> optval, socklen_t optlen) -> uint64_t {
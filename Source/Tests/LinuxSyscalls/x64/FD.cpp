@@ -99,6 +99,7 @@ namespace FEX::HLE::x64 {
     });
 
     REGISTER_SYSCALL_IMPL_X64_PASS(readv, [](FEXCore::Core::CpuStateFrame *Frame, int fd, const struct iovec *iov, int iovcnt) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffers(Frame, iov, iovcnt);
       uint64_t Result = ::readv(fd, iov, iovcnt);
       SYSCALL_ERRNO();
     });
@@ -133,6 +134,7 @@ namespace FEX::HLE::x64 {
       uint64_t vlen,
       uint64_t pos_l,
       uint64_t pos_h) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffers(Frame, iov, vlen);
       uint64_t Result = ::syscall(SYSCALL_DEF(preadv), fd, iov, vlen, pos_l, pos_h);
       SYSCALL_ERRNO();
     });
@@ -154,6 +156,7 @@ namespace FEX::HLE::x64 {
       uint64_t pos_l,
       uint64_t pos_h,
       int flags) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffers(Frame, iov, vlen);
       uint64_t Result = ::syscall(SYSCALL_DEF(preadv2), fd, iov, vlen, pos_l, pos_h, flags);
       SYSCALL_ERRNO();
     });
@@ -170,6 +173,7 @@ namespace FEX::HLE::x64 {
     });
 
     REGISTER_SYSCALL_IMPL_X64_PASS(pread_64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *buf, size_t count, off_t offset) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffer(Frame, buf, count);
       uint64_t Result = ::pread64(fd, buf, count, offset);
       SYSCALL_ERRNO();
     });
@@ -209,6 +213,7 @@ namespace FEX::HLE::x64 {
     });
 
     REGISTER_SYSCALL_IMPL_X64_PASS(getdents64, [](FEXCore::Core::CpuStateFrame *Frame, int fd, void *dirp, uint32_t count) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffer(Frame, dirp, count);
       uint64_t Result = syscall(SYSCALL_DEF(getdents64),
         static_cast<uint64_t>(fd),
         reinterpret_cast<uint64_t>(dirp),
@@ -226,7 +231,11 @@ namespace FEX::HLE::x64 {
       SYSCALL_ERRNO();
     });
 
-    REGISTER_SYSCALL_IMPL_X64_PASS(dup2, [](FEXCore::Core::CpuStateFrame *Frame, int oldfd, int newfd) -> uint64_t {
+    REGISTER_SYSCALL_IMPL_X64(dup2, [](FEXCore::Core::CpuStateFrame *Frame, int oldfd, int newfd) -> uint64_t {
+      if (FEX::HLE::_SyscallHandler->FM.IsRootFSFD(newfd)) {
+        // Would silently close the rootfs fd
+        return -EBADF;
+      }
       uint64_t Result = ::dup2(oldfd, newfd);
       SYSCALL_ERRNO();
     });
@@ -92,16 +92,21 @@ namespace FEX::HLE::x64 {
 
     REGISTER_SYSCALL_IMPL_X64_PASS_FLAGS(mremap, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, void *old_address, size_t old_size, size_t new_size, int flags, void *new_address) -> uint64_t {
+      // Write-protected code pages would keep their protection at the new address
+      FEXCore::Context::UnprotectCodeRange(Frame->Thread, (uintptr_t)old_address, old_size);
       uint64_t Result = reinterpret_cast<uint64_t>(::mremap(old_address, old_size, new_size, flags, new_address));
       SYSCALL_ERRNO();
     });
 
     REGISTER_SYSCALL_IMPL_X64_FLAGS(mprotect, SyscallFlags::OPTIMIZETHROUGH | SyscallFlags::NOSYNCSTATEONENTRY,
       [](FEXCore::Core::CpuStateFrame *Frame, void *addr, size_t len, int prot) -> uint64_t {
+      static FEX_CONFIG_OPT(SMCChecks, SMCCHECKS);
+
       uint64_t Result = ::mprotect(addr, len, prot);
 
       auto Thread = Frame->Thread;
-      if (Result != -1 && prot & PROT_EXEC) {
+      // Page tracking needs to know about every protection change, not only the ones that can make code
+      if (Result != -1 && (prot & PROT_EXEC || SMCChecks == FEXCore::Config::CONFIG_SMC_MTRACK)) {
         FEXCore::Context::FlushCodeRange(Thread, (uintptr_t)addr, len);
       }
       SYSCALL_ERRNO();
@@ -37,6 +37,9 @@ namespace FEX::HLE::x64 {
     });
 
     REGISTER_SYSCALL_IMPL_X64_PASS(recvmsg, [](FEXCore::Core::CpuStateFrame *Frame, int sockfd, struct msghdr *msg, int flags) -> uint64_t {
+      FEX::HLE::UnprotectGuestBuffers(Frame, msg->msg_iov, msg->msg_iovlen);
+      FEX::HLE::UnprotectGuestBuffer(Frame, msg->msg_name, msg->msg_namelen);
+      FEX::HLE::UnprotectGuestBuffer(Frame, msg->msg_control, msg->msg_controllen);
       uint64_t Result = ::recvmsg(sockfd, msg, flags);
       SYSCALL_ERRNO();
     });
@@ -8,6 +8,7 @@ $end_info$
 #include "Common/ArgumentLoader.h"
 #include "CommonCore/HostFactory.h"
 #include "HarnessHelpers.h"
+#include "HarnessRunner.h"
 #include "Tests/LinuxSyscalls/LinuxAllocator.h"
 #include "Tests/LinuxSyscalls/Syscalls.h"
 #include "Tests/LinuxSyscalls/x32/Syscalls.h"
@@ -34,89 +35,9 @@ namespace FEXCore::Core {
   struct InternalThreadState;
 }
 
-void MsgHandler(LogMan::DebugLevels Level, char const *Message) {
-  const char *CharLevel{nullptr};
-
-  switch (Level) {
-  case LogMan::NONE:
-    CharLevel = "NONE";
-    break;
-  case LogMan::ASSERT:
-    CharLevel = "ASSERT";
-    break;
-  case LogMan::ERROR:
-    CharLevel = "ERROR";
-    break;
-  case LogMan::DEBUG:
-    CharLevel = "DEBUG";
-    break;
-  case LogMan::INFO:
-    CharLevel = "Info";
-    break;
-  default:
-    CharLevel = "???";
-    break;
-  }
-  fmt::print("[{}] {}\n", CharLevel, Message);
-}
-
-void AssertHandler(char const *Message) {
-  fmt::print("[ASSERT] {}\n", Message);
-
-  // make sure buffers are flushed
-  fflush(nullptr);
-}
-
-namespace {
-static const std::vector<std::pair<const char*, FEXCore::Config::ConfigOption>> EnvConfigLookup = {{
-#define OPT_BASE(type, group, enum, json, default) {"FEX_" #enum, FEXCore::Config::ConfigOption::CONFIG_##enum},
-#include <FEXCore/Config/ConfigValues.inl>
-}};
-
-// Claims to be a local application config layer
-class TestEnvLoader final : public FEXCore::Config::Layer {
-public:
-  explicit TestEnvLoader(std::vector<std::pair<std::string_view, std::string_view>> _Env)
-    : FEXCore::Config::Layer(FEXCore::Config::LayerType::LAYER_LOCAL_APP)
-    , Env {std::move(_Env)} {
-    Load();
-  }
-
-  void Load() override {
-    std::unordered_map<std::string_view, std::string_view> EnvMap;
-    for (auto &Option : Env) {
-      std::string_view Key = Option.first;
-      std::string_view Value = Option.second;
-
-#define ENVLOADER
-#include <FEXCore/Config/ConfigOptions.inl>
-
-      EnvMap.insert_or_assign(Key, Value);
-    }
-
-    auto GetVar = [&](const std::string_view id) -> std::optional<std::string_view> {
-      const auto it = EnvMap.find(id);
-      if (it == EnvMap.end())
-        return std::nullopt;
-
-      return it->second;
-    };
-
-    for (auto &it : EnvConfigLookup) {
-      if (auto Value = GetVar(it.first); Value) {
-        Set(it.second, *Value);
-      }
-    }
-  }
-
-private:
-  std::vector<std::pair<std::string_view, std::string_view>> Env;
-};
-}
-
 int main(int argc, char **argv, char **const envp) {
-  LogMan::Throw::InstallHandler(AssertHandler);
-  LogMan::Msg::InstallHandler(MsgHandler);
+  LogMan::Throw::InstallHandler(FEX::HarnessHelper::AssertHandler);
+  LogMan::Msg::InstallHandler(FEX::HarnessHelper::MsgHandler);
   FEXCore::Config::Initialize();
   FEXCore::Config::AddLayer(std::make_unique<FEX::ArgLoader::ArgLoader>(argc, argv));
   FEXCore::Config::AddLayer(FEXCore::Config::CreateEnvironmentLayer(envp));
@@ -132,7 +53,7 @@ int main(int argc, char **argv, char **const envp) {
   FEX::HarnessHelper::HarnessCodeLoader Loader{Args[0], Args[1].c_str()};
 
   // Adds in environment options from the test harness config
-  FEXCore::Config::AddLayer(std::make_unique<TestEnvLoader>(Loader.GetEnvironmentOptions()));
+  FEXCore::Config::AddLayer(std::make_unique<FEX::HarnessHelper::TestEnvLoader>(Loader.GetEnvironmentOptions()));
   FEXCore::Config::ReloadMetaLayer();
 
   FEXCore::Config::Set(FEXCore::Config::CONFIG_IS64BIT_MODE, Loader.Is64BitMode() ? "1" : "0");
@@ -146,38 +67,9 @@ int main(int argc, char **argv, char **const envp) {
 
   std::unique_ptr<FEX::HLE::MemAllocator> Allocator;
 
-  if (Loader.Is64BitMode()) {
-    if (!Loader.MapMemory([](void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
-      return FEXCore::Allocator::mmap(addr, length, prot, flags, fd, offset);
-    }, [](void *addr, size_t length) {
-      return FEXCore::Allocator::munmap(addr, length);
-    })) {
-      // failed to map
-      return -ENOEXEC;
-    }
-  } else {
-    // Setup our userspace allocator
-    uint32_t KernelVersion = FEX::HLE::SyscallHandler::CalculateHostKernelVersion();
-    if (KernelVersion >= FEX::HLE::SyscallHandler::KernelVersion(4, 17)) {
-      FEXCore::Allocator::SetupHooks();
-    }
-
-    if (KernelVersion < FEX::HLE::SyscallHandler::KernelVersion(4, 17)) {
-      Allocator = FEX::HLE::Create32BitAllocator();
-    }
-    else {
-      Allocator = FEX::HLE::CreatePassthroughAllocator();
-    }
-
-    if (!Loader.MapMemory([&Allocator](void *addr, size_t length, int prot, int flags, int fd, off_t offset) {
-      return Allocator->mmap(addr, length, prot, flags, fd, offset);
-    }, [&Allocator](void *addr, size_t length) {
-      return Allocator->munmap(addr, length);
-    })) {
-      // failed to map
-      LogMan::Msg::EFmt("Failed to map 32-bit elf file.");
-      return -ENOEXEC;
-    }
+  if (!FEX::HarnessHelper::MapTestMemory(Loader, Allocator)) {
+    // failed to map
+    return -ENOEXEC;
   }
 
   auto SignalDelegation = std::make_unique<FEX::HLE::SignalDelegator>();
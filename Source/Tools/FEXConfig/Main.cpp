@@ -526,6 +526,13 @@ namespace {
         ConfigChanged = true;
       }
 
+      Value = LoadedConfig->Get(FEXCore::Config::ConfigOption::CONFIG_STACKTSOELISION);
+      bool StackTSOElision = Value.has_value() && **Value == "1";
+      if (ImGui::Checkbox("Stack TSO Elision", &StackTSOElision)) {
+        LoadedConfig->EraseSet(FEXCore::Config::ConfigOption::CONFIG_STACKTSOELISION, StackTSOElision ? "1" : "0");
+        ConfigChanged = true;
+      }
+
       ImGui::Text("SMC Checks: ");
       int SMCChecks = FEXCore::Config::CONFIG_SMC_MMAN;
 
@@ -537,13 +544,16 @@ namespace {
           SMCChecks = FEXCore::Config::CONFIG_SMC_MMAN;
         } else if (**Value == "2") {
           SMCChecks = FEXCore::Config::CONFIG_SMC_FULL;
+        } else if (**Value == "3") {
+          SMCChecks = FEXCore::Config::CONFIG_SMC_MTRACK;
         }
       }
 
       bool SMCChanged = false;
       SMCChanged |= ImGui::RadioButton("None", &SMCChecks, FEXCore::Config::CONFIG_SMC_NONE); ImGui::SameLine();
       SMCChanged |= ImGui::RadioButton("MMan", &SMCChecks, FEXCore::Config::CONFIG_SMC_MMAN); ImGui::SameLine();
-      SMCChanged |= ImGui::RadioButton("Full", &SMCChecks, FEXCore::Config::CONFIG_SMC_FULL);
+      SMCChanged |= ImGui::RadioButton("Full", &SMCChecks, FEXCore::Config::CONFIG_SMC_FULL); ImGui::SameLine();
+      SMCChanged |= ImGui::RadioButton("MTrack", &SMCChecks, FEXCore::Config::CONFIG_SMC_MTRACK);
 
       if (SMCChanged) {
         LoadedConfig->EraseSet(FEXCore::Config::ConfigOption::CONFIG_SMCCHECKS, std::to_string(SMCChecks));
@@ -563,6 +573,13 @@ namespace {
         ConfigChanged = true;
       }
 
+      Value = LoadedConfig->Get(FEXCore::Config::ConfigOption::CONFIG_X87REDUCEDPRECISION);
+      bool X87ReducedPrecision = Value.has_value() && **Value == "1";
+      if (ImGui::Checkbox("Reduced precision x87", &X87ReducedPrecision)) {
+        LoadedConfig->EraseSet(FEXCore::Config::ConfigOption::CONFIG_X87REDUCEDPRECISION, X87ReducedPrecision ? "1" : "0");
+        ConfigChanged = true;
+      }
+
       ImGui::EndTabItem();
     }
   }
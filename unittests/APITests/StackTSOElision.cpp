@@ -0,0 +1,147 @@
+#include <catch2/catch.hpp>
+#include "Interface/IR/Passes.h"
+#include "Interface/IR/PassManager.h"
+
+#include <FEXCore/IR/IR.h>
+#include <FEXCore/IR/IREmitter.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+struct MemOpCounts {
+  int TSO{};
+  int NonTSO{};
+};
+
+// Parses the IR and runs StackTSOElision over it, the unittests/IR tests can only see the results of the accesses
+MemOpCounts RunPass(std::string const &Text, bool *Changed) {
+  std::istringstream Stream(Text);
+  auto IR = FEXCore::IR::Parse(&Stream);
+  REQUIRE(IR);
+
+  *Changed = FEXCore::IR::CreateStackTSOElision()->Run(IR.get());
+
+  MemOpCounts Counts{};
+  auto View = IR->ViewIR();
+  for (auto [BlockNode, BlockHeader] : View.GetBlocks()) {
+    for (auto [CodeNode, IROp] : View.GetCode(BlockNode)) {
+      switch (IROp->Op) {
+        case FEXCore::IR::OP_LOADMEMTSO:
+        case FEXCore::IR::OP_STOREMEMTSO:
+          ++Counts.TSO;
+          break;
+        case FEXCore::IR::OP_LOADMEM:
+        case FEXCore::IR::OP_STOREMEM:
+          ++Counts.NonTSO;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  return Counts;
+}
+}
+
+// Same block as unittests/IR/Basic/StackTSOElision.ir
+TEST_CASE("DemotesStackAccesses") {
+  bool Changed{};
+  auto Counts = RunPass(R"(
+(%ssa1) IRHeader %ssa2, #0
+  (%ssa2) CodeBlock %start, %end, %ssa1
+    (%start i0) BeginBlock %ssa2
+    %RSP i64 = LoadContext #8, GPR, #0x28
+    %Off i64 = Constant #0x100
+    %Slot i64 = Add %RSP, %Off
+    %Off2 i64 = Constant #0x8
+    %Slot2 i64 = Sub %Slot, %Off2
+    %Value i64 = Constant #0x4142434445464748
+    (%StoreA i64) StoreMemTSO GPR, #8, %Value i64, %Slot i64, %Invalid, #8, SXTX, #1
+    %Value2 i64 = Constant #0x5152535455565758
+    (%StoreB i64) StoreMemTSO GPR, #8, %Value2 i64, %Slot2 i64, %Invalid, #8, SXTX, #1
+    %Val i64 = LoadMemTSO GPR, #8, %Slot i64, %Invalid, #8, SXTX, #1
+    %Val2 i64 = LoadMemTSO GPR, #8, %Slot2 i64, %Invalid, #8, SXTX, #1
+    (%Store i64) StoreContext #8, GPR, %Val i64, #8
+    (%Store2 i64) StoreContext #8, GPR, %Val2 i64, #0x10
+    (%brk i0) Break Halt, #4
+    (%end i0) EndBlock %ssa2
+)", &Changed);
+
+  CHECK(Changed);
+  CHECK(Counts.TSO == 0);
+  CHECK(Counts.NonTSO == 4);
+}
+
+// Same block as unittests/IR/Basic/StackTSOElisionEscape.ir
+TEST_CASE("KeepsTSOWhenStackAddressIsStored") {
+  bool Changed{};
+  auto Counts = RunPass(R"(
+(%ssa1) IRHeader %ssa2, #0
+  (%ssa2) CodeBlock %start, %end, %ssa1
+    (%start i0) BeginBlock %ssa2
+    %RSP i64 = LoadContext #8, GPR, #0x28
+    %Off i64 = Constant #0x100
+    %Slot i64 = Add %RSP, %Off
+    %Off2 i64 = Constant #0x108
+    %Slot2 i64 = Add %RSP, %Off2
+    (%StoreA i64) StoreMemTSO GPR, #8, %Slot i64, %Slot2 i64, %Invalid, #8, SXTX, #1
+    %Value i64 = Constant #0x4142434445464748
+    (%StoreB i64) StoreMemTSO GPR, #8, %Value i64, %Slot i64, %Invalid, #8, SXTX, #1
+    %Ptr i64 = LoadMemTSO GPR, #8, %Slot2 i64, %Invalid, #8, SXTX, #1
+    %Val i64 = LoadMemTSO GPR, #8, %Ptr i64, %Invalid, #8, SXTX, #1
+    %Diff i64 = Sub %Ptr, %RSP
+    (%Store i64) StoreContext #8, GPR, %Diff i64, #8
+    (%Store2 i64) StoreContext #8, GPR, %Val i64, #0x10
+    (%brk i0) Break Halt, #4
+    (%end i0) EndBlock %ssa2
+)", &Changed);
+
+  CHECK(!Changed);
+  CHECK(Counts.TSO == 4);
+  CHECK(Counts.NonTSO == 0);
+}
+
+TEST_CASE("KeepsTSOWhenStackAddressGoesToAnotherRegister") {
+  bool Changed{};
+  auto Counts = RunPass(R"(
+(%ssa1) IRHeader %ssa2, #0
+  (%ssa2) CodeBlock %start, %end, %ssa1
+    (%start i0) BeginBlock %ssa2
+    %RSP i64 = LoadContext #8, GPR, #0x28
+    %Off i64 = Constant #0x100
+    %Slot i64 = Add %RSP, %Off
+    %Value i64 = Constant #0x4142434445464748
+    (%StoreA i64) StoreMemTSO GPR, #8, %Value i64, %Slot i64, %Invalid, #8, SXTX, #1
+    (%Store i64) StoreContext #8, GPR, %Slot i64, #8
+    (%brk i0) Break Halt, #4
+    (%end i0) EndBlock %ssa2
+)", &Changed);
+
+  CHECK(!Changed);
+  CHECK(Counts.TSO == 1);
+  CHECK(Counts.NonTSO == 0);
+}
+
+TEST_CASE("KeepsTSOForOtherRegisters") {
+  bool Changed{};
+  auto Counts = RunPass(R"(
+(%ssa1) IRHeader %ssa2, #0
+  (%ssa2) CodeBlock %start, %end, %ssa1
+    (%start i0) BeginBlock %ssa2
+    %RAX i64 = LoadContext #8, GPR, #0x8
+    %Off i64 = Constant #0x100
+    %Slot i64 = Add %RAX, %Off
+    %Value i64 = Constant #0x4142434445464748
+    (%StoreA i64) StoreMemTSO GPR, #8, %Value i64, %Slot i64, %Invalid, #8, SXTX, #1
+    %Val i64 = LoadMemTSO GPR, #8, %Slot i64, %Invalid, #8, SXTX, #1
+    (%Store i64) StoreContext #8, GPR, %Val i64, #0x10
+    (%brk i0) Break Halt, #4
+    (%end i0) EndBlock %ssa2
+)", &Changed);
+
+  CHECK(!Changed);
+  CHECK(Counts.TSO == 2);
+  CHECK(Counts.NonTSO == 0);
+}
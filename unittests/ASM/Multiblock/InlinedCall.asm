@@ -0,0 +1,29 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0",
+    "RBX": "0xe7fffff8",
+    "RDI": "0xe8000000"
+  }
+}
+%endif
+
+mov rsp, 0xe8000000
+lea rdx, [rel after_call]
+
+; A small leaf function gets decoded as part of this region with multiblock
+; It still has to see the return address on the stack
+call leaf
+after_call:
+
+mov rax, rcx
+sub rax, rdx
+mov rbx, rsi
+mov rdi, rsp
+
+hlt
+
+leaf:
+mov rcx, [rsp]
+mov rsi, rsp
+ret
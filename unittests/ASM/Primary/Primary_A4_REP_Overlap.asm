@@ -0,0 +1,33 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x4141414141414141",
+    "RBX": "0x5858585858585858",
+    "RCX": "0x0",
+    "RDI": "0xE0000008",
+    "RSI": "0xE0000007"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rdx, 0xe0000000
+
+mov rax, 0x4847464544434241
+mov [rdx + 8 * 0], rax
+mov rax, 0x5858585858585858
+mov [rdx + 8 * 1], rax
+
+; Destination runs one byte ahead of the source, every byte is copied from the one that was just written
+lea rdi, [rdx + 1]
+lea rsi, [rdx + 0]
+
+cld
+mov rcx, 7
+rep movsb ; rdi <- rsi
+
+mov rax, [rdx + 8 * 0]
+mov rbx, [rdx + 8 * 1]
+hlt
@@ -0,0 +1,39 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x4142434445464748",
+    "RBX": "0x5152535455565758",
+    "RBP": "0x0",
+    "RCX": "0x0",
+    "RDI": "0xE0002FF0",
+    "RSI": "0xE0000FF0"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rdx, 0xe0001000
+mov r8,  0xe0003000
+
+mov rax, 0x4142434445464748
+mov [rdx - 8 * 1], rax
+mov rax, 0x5152535455565758
+mov [rdx + 8 * 0], rax
+mov rax, 0
+mov [r8 - 8 * 3], rax
+
+; Both the source and the destination cross a page boundary while walking down
+lea rsi, [rdx + 8 * 0]
+lea rdi, [r8 + 8 * 0]
+
+std
+mov rcx, 2
+rep movsq ; rdi <- rsi
+cld
+
+mov rax, [r8 - 8 * 1]
+mov rbx, [r8 + 8 * 0]
+mov rbp, [r8 - 8 * 3]
+hlt
@@ -0,0 +1,41 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x4142434445464748",
+    "RBX": "0x4142434445464748",
+    "RBP": "0x4142434445464748",
+    "R8":  "0x4142434445464748",
+    "RCX": "0x0",
+    "RDI": "0xDFFFFFF8",
+    "RSI": "0xE0000000"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rdx, 0xe0000000
+
+mov rax, 0x5152535455565758
+mov [rdx + 8 * 0], rax
+mov [rdx + 8 * 1], rax
+mov [rdx + 8 * 2], rax
+mov rax, 0x4142434445464748
+mov [rdx + 8 * 3], rax
+
+; Walking down with the destination one element below the source
+; Every element is copied from the one that was just written
+lea rdi, [rdx + 8 * 2]
+lea rsi, [rdx + 8 * 3]
+
+std
+mov rcx, 3
+rep movsq ; rdi <- rsi
+cld
+
+mov rax, [rdx + 8 * 0]
+mov rbx, [rdx + 8 * 1]
+mov rbp, [rdx + 8 * 2]
+mov r8,  [rdx + 8 * 3]
+hlt
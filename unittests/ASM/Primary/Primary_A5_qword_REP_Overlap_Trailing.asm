@@ -0,0 +1,41 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x5152535455565758",
+    "RBX": "0x6162636465666768",
+    "RBP": "0x7172737475767778",
+    "R8":  "0x7172737475767778",
+    "RCX": "0x0",
+    "RDI": "0xE0000018",
+    "RSI": "0xE0000020"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rdx, 0xe0000000
+
+mov rax, 0x4142434445464748
+mov [rdx + 8 * 0], rax
+mov rax, 0x5152535455565758
+mov [rdx + 8 * 1], rax
+mov rax, 0x6162636465666768
+mov [rdx + 8 * 2], rax
+mov rax, 0x7172737475767778
+mov [rdx + 8 * 3], rax
+
+; Destination trails the source by one element, each source element is read before it gets overwritten
+lea rdi, [rdx + 8 * 0]
+lea rsi, [rdx + 8 * 1]
+
+cld
+mov rcx, 3
+rep movsq ; rdi <- rsi
+
+mov rax, [rdx + 8 * 0]
+mov rbx, [rdx + 8 * 1]
+mov rbp, [rdx + 8 * 2]
+mov r8,  [rdx + 8 * 3]
+hlt
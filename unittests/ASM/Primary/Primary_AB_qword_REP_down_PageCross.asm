@@ -0,0 +1,36 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x0",
+    "RBX": "0x4142434445464748",
+    "RBP": "0x4142434445464748",
+    "R8":  "0x0",
+    "RCX": "0x0",
+    "RDI": "0xE0000FE8"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rdx, 0xe0001000
+
+mov rax, 0
+mov [rdx - 8 * 3], rax
+mov [rdx + 8 * 2], rax
+
+; Walks down across the page boundary
+lea rdi, [rdx + 8 * 1]
+mov rax, 0x4142434445464748
+
+std
+mov rcx, 4
+rep stosq
+cld
+
+mov rax, [rdx - 8 * 3]
+mov rbx, [rdx - 8 * 2]
+mov rbp, [rdx + 8 * 1]
+mov r8,  [rdx + 8 * 2]
+hlt
@@ -0,0 +1,27 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "2",
+    "RBX": "1"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+mov rsp, 0xe8000000
+
+; Run the function once so its page is write-protected
+call function
+mov rbx, rax
+
+; Patch the immediate of the mov on the page that was already executed
+; The call right after it would take the linked exit or the L1 cache to the old block if it was still around
+mov dword [rel function + 1], 2
+call function
+hlt
+
+function:
+mov eax, 1
+ret
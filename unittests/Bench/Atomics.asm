@@ -0,0 +1,39 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x186a0",
+    "RBX": "0x186a0",
+    "RSI": "0x186a0",
+    "RCX": "0x0"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+; Locked add, exchange-add and compare-exchange on separate counters
+mov rdx, 0xe0000000
+mov qword [rdx + 8 * 0], 0
+mov qword [rdx + 8 * 1], 0
+mov qword [rdx + 8 * 2], 0
+
+mov rcx, 100000
+
+loop_top:
+lock add qword [rdx + 8 * 0], 1
+
+mov rax, 1
+lock xadd [rdx + 8 * 1], rax
+
+mov rax, [rdx + 8 * 2]
+lea r8, [rax + 1]
+lock cmpxchg [rdx + 8 * 2], r8
+
+dec rcx
+jnz loop_top
+
+mov rax, [rdx + 8 * 0]
+mov rbx, [rdx + 8 * 1]
+mov rsi, [rdx + 8 * 2]
+hlt
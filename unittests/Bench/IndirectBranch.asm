@@ -0,0 +1,53 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x3d090",
+    "RBX": "0x186a0",
+    "R12": "0x0"
+  }
+}
+%endif
+
+; Rotates through four call targets through a table
+mov rsp, 0xe8000000
+lea r13, [rel table]
+xor rax, rax
+xor rbx, rbx
+
+mov r12, 100000
+
+loop_top:
+mov rcx, rbx
+and rcx, 3
+movsxd rcx, dword [r13 + rcx * 4]
+add rcx, r13
+call rcx
+
+inc rbx
+dec r12
+jnz loop_top
+
+hlt
+
+func0:
+add rax, 1
+ret
+
+func1:
+add rax, 2
+ret
+
+func2:
+add rax, 3
+ret
+
+func3:
+add rax, 4
+ret
+
+align 4
+table:
+dd func0 - table
+dd func1 - table
+dd func2 - table
+dd func3 - table
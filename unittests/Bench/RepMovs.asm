@@ -0,0 +1,32 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x4142434445464748",
+    "RCX": "0x0",
+    "RDX": "0x0"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+; Copies 2KB between the two halves of a page
+mov r15, 0xe0000000
+mov rax, 0x4142434445464748
+mov [r15], rax
+
+cld
+mov rdx, 20000
+
+loop_top:
+mov rsi, r15
+lea rdi, [r15 + 2048]
+mov rcx, 2048
+rep movsb
+
+dec rdx
+jnz loop_top
+
+mov rax, [r15 + 2048]
+hlt
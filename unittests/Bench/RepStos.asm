@@ -0,0 +1,31 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x6162636465666768",
+    "RCX": "0x0",
+    "RDX": "0x0",
+    "RDI": "0xe0001000"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+; Fills a page a qword at a time
+mov r15, 0xe0000000
+mov rax, 0x6162636465666768
+
+cld
+mov rdx, 20000
+
+loop_top:
+mov rdi, r15
+mov rcx, 512
+rep stosq
+
+dec rdx
+jnz loop_top
+
+mov rax, [r15 + 8 * 511]
+hlt
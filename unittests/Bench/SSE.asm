@@ -0,0 +1,35 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x000186a0000186a0",
+    "RBX": "0x000186a0000186a0",
+    "RCX": "0x0"
+  }
+}
+%endif
+
+; Integer and float vector accumulation
+movaps xmm0, [rel int_ones]
+movaps xmm2, [rel float_ones]
+pxor xmm1, xmm1
+xorps xmm3, xmm3
+
+mov rcx, 100000
+
+loop_top:
+paddd xmm1, xmm0
+addps xmm3, xmm2
+pshufd xmm4, xmm1, 0x1b
+pxor xmm5, xmm4
+
+dec rcx
+jnz loop_top
+
+cvttps2dq xmm3, xmm3
+movq rax, xmm1
+movq rbx, xmm3
+hlt
+
+align 16
+int_ones: dd 1, 1, 1, 1
+float_ones: dd 0x3f800000, 0x3f800000, 0x3f800000, 0x3f800000
@@ -0,0 +1,31 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "R12": "0x0",
+    "R13": "0x1"
+  }
+}
+%endif
+
+; getpid doesn't block, this measures the syscall path itself
+mov r12, 100000
+mov rax, 39 ; getpid
+syscall
+mov r14, rax
+
+mov r13, 1
+
+loop_top:
+mov rax, 39 ; getpid
+syscall
+
+; The pid should never change
+cmp rax, r14
+je same_pid
+mov r13, 0
+same_pid:
+
+dec r12
+jnz loop_top
+
+hlt
@@ -0,0 +1,34 @@
+%ifdef CONFIG
+{
+  "RegData": {
+    "RAX": "0x493e0",
+    "RCX": "0x0"
+  },
+  "MemoryRegions": {
+    "0x100000000": "4096"
+  }
+}
+%endif
+
+; Accumulates 1 + sqrt(4) per iteration on the x87 stack
+mov rdx, 0xe0000000
+fldz
+
+mov rcx, 100000
+
+loop_top:
+fld1
+faddp
+fld dword [rel four]
+fsqrt
+faddp
+
+dec rcx
+jnz loop_top
+
+fistp qword [rdx]
+mov rax, [rdx]
+hlt
+
+align 8
+four: dd 0x40800000 ; 4.0